@@ -16,11 +16,19 @@
 -- AM_AS_Start <= Slave
 -- AM_AS_StartAddress <= Slave
 -- AM_AS_Length <= Slave
+-- AM_AS_Descriptor <= Slave
+-- AM_AS_Trailer <= Slave
+-- AM_AS_Format <= Slave
+-- 
+-- AM_CI_FrameCount <= Camera Controller
+-- AM_CI_DroppedLines <= Camera Controller
 -- 
 -- AM_FIFO_UsedWords <= FIFO
 -- FIFO_data <= FIFO
 -- 
 -- AM_AB_WaitRequest <= Avalon Bus
+-- AM_AB_ReadData <= Avalon Bus
+-- AM_AB_ReadDataValid <= Avalon Bus
 -- 
 -- OUTPUTS
 -- AM_FIFO_ReadCheck => FIFO
@@ -28,13 +36,48 @@
 -- AM_AB_MemoryAddress => Avalon Bus
 -- AM_AB_MemoryData => Avalon Bus
 -- AM_AB_WriteAccess => Avalon Bus
+-- AM_AB_ReadAccess => Avalon Bus
 -- AM_AB_BurstCount => Avalon Bus
+--
+-- AM_AS_Status => Slave
+-- AM_AS_Crc => Slave
+--
+-- DESCRIPTORS
+-- When AM_AS_Descriptor = 1, AM_AS_StartAddress points to a 16 bytes descriptor
+-- instead of the buffer itself:
+--  +0x0: address of the buffer
+--  +0x4: length of the buffer (bytes, multiple of 64, one frame)
+--  +0x8: flags, bits 7->0 = buffer id chosen by the firmware
+--  +0xC: status written back when the frame is complete
+--        bit 0 = done, bits 15->8 = buffer id copied from the flags
+-- The descriptor is read when the first burst of a frame is available in the FIFO.
+--
+-- TRAILER
+-- When AM_AS_Trailer = 1, a 16 bytes trailer is written right after the frame
+-- (at buffer address + length), before the buffer is given to the firmware:
+--  +0x0: number of the camera frame, counted since the reset, when the first
+--        burst was written
+--  +0x4: timestamp of the first burst, free-running counter of AM_Clk cycles
+--  +0x8: number of camera lines which were not captured since the previous
+--        trailer (FIFO overflow, ring full, acquisition stopped)
+--  +0xC: bits 7->0 = format of the frame, bits 15->8 = buffer id (descriptor
+--        mode, 0 otherwise), bits 31->16 = TRAILER_MAGIC
+-- The buffer must then hold length + 16 bytes.
+--
+-- CRC
+-- The CRC-32 of the frame (IEEE 802.3, reflected polynomial 0xEDB88320, initial
+-- value and final xor 0xFFFFFFFF) is computed on the words written to the
+-- buffer, in the order of the bytes in the memory (bits 7->0 of a word first).
+-- The trailer is not included. AM_AS_Crc holds it while AM_AS_Status = 1.
 
 LIBRARY ieee;
 USE ieee.std_logic_1164.all;
 USE ieee.numeric_std.all;
 
 ENTITY Avalon_master IS
+	GENERIC(
+		FIFO_DEPTH_LOG2		: natural := 10							-- log2 of the FIFO depth in 16 bits words
+	);
 	PORT(
 		AM_nReset			: IN std_logic;							-- AM_nReset input
 		AM_Clk				: IN std_logic;							-- clock input
@@ -42,29 +85,69 @@ ENTITY Avalon_master IS
 		AM_AB_MemoryAddress	: OUT std_logic_vector (31 DOWNTO 0);	-- Adress sent on the Avalon bus
 		AM_AB_MemoryData	: OUT std_logic_vector (31 DOWNTO 0);	-- Datas sent on the Avalon bus
 		AM_AB_WriteAccess	: OUT std_logic;						-- Pin write, 1 when the component wants to use the bus
+		AM_AB_ReadAccess	: OUT std_logic;						-- Pin read, 1 when the component wants to read a descriptor
+		AM_AB_ReadData		: IN std_logic_vector (31 DOWNTO 0);	-- Datas received from the Avalon bus
+		AM_AB_ReadDataValid	: IN std_logic;							-- Pin readdatavalid, 1 when AM_AB_ReadData holds the requested word
 		AM_AB_BurstCount	: OUT std_logic_vector (7 DOWNTO 0);	-- Number of datas in one burst
 		AM_AB_WaitRequest	: IN std_logic;							-- Pin waitrequest which is 0 when the bus is available
 		
 		AM_AS_Start			: IN std_logic;							-- Start command
-		AM_AS_StartAddress	: IN std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
+		AM_AS_StartAddress	: IN std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory (or descriptor address)
 		AM_AS_Length		: IN std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+		AM_AS_Descriptor	: IN std_logic;							-- 1 when AM_AS_StartAddress points to a descriptor
 		AM_AS_Status		: OUT std_logic;						-- 1 when the image has been written to the memory
+		AM_AS_Crc			: OUT std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AM_AS_Status = 1
+		AM_AS_Trailer		: IN std_logic;							-- 1 when a trailer is written after each frame
+		AM_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image, copied in the trailer
+		
+		AM_CI_FrameCount	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+		AM_CI_DroppedLines	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 		
 		AM_FIFO_ReadCheck	: OUT std_logic;						-- 1 = information asked to the Fifo, 0 = no demand
 		AM_FIFO_ReadData	: IN std_logic_vector (31 DOWNTO 0);	-- 1 pixel stored in the FIFO by hte camera controller
-		AM_FIFO_UsedWords	: IN std_logic_vector (8 DOWNTO 0)		-- number of 32 bits words
+		AM_FIFO_UsedWords	: IN std_logic_vector (FIFO_DEPTH_LOG2-2 DOWNTO 0)	-- number of 32 bits words
 	);
 END Avalon_master;
 
 ARCHITECTURE bhv OF Avalon_master IS
 	constant	BURSTCOUNT_LENGTH 	: unsigned (7 DOWNTO 0) := X"10";
 	constant	ADDR_INCREMENT 		: unsigned (7 DOWNTO 0) := X"40";							--(AM_AB_MemoryData'length / 8) * BURSTCOUNT_LENGTH;
+	constant	DESC_STATUS_OFFSET	: unsigned (7 DOWNTO 0) := X"0C";							-- offset of the status word in a descriptor
+	constant	TRAILER_MAGIC		: std_logic_vector (15 DOWNTO 0) := X"CA3E";				-- signature of a valid trailer
+	constant	CRC_POLYNOMIAL		: std_logic_vector (31 DOWNTO 0) := X"EDB88320";			-- CRC-32, reflected polynomial
+	
+	-- CRC-32 of crc followed by the 4 bytes of data, bits 7->0 first, one bit per step
+	function crc32_word(crc : std_logic_vector (31 DOWNTO 0); data : std_logic_vector (31 DOWNTO 0)) return std_logic_vector is
+		variable result : std_logic_vector (31 DOWNTO 0);
+	begin
+		result := crc;
+		for i in 0 TO 31 loop
+			if (result (0) XOR data (i)) = '1' then
+				result := ('0' & result (31 DOWNTO 1)) XOR CRC_POLYNOMIAL;
+			else
+				result := '0' & result (31 DOWNTO 1);
+			end if;
+		end loop;
+		return result;
+	end function crc32_word;
 	
 	signal		iRegAlmostEmpty								: std_logic;						-- internal phantom register which says if there is at least a burst in the FIFO
 	signal		iRegCounterAddress, next_iRegCounterAddress	: std_logic_vector (31 DOWNTO 0);	-- internal phantom register which points on the current adress in the memory
 	signal 		iRegBurstCount, next_iRegBurstCount 		: unsigned (7 DOWNTO 0);
+	signal		iRegBufferAddress, next_iRegBufferAddress	: std_logic_vector (31 DOWNTO 0);	-- address of the buffer of the current frame
+	signal		iRegLength, next_iRegLength					: std_logic_vector (31 DOWNTO 0);	-- length of the buffer of the current frame
+	signal		iRegDescAddress, next_iRegDescAddress		: std_logic_vector (31 DOWNTO 0);	-- address of the descriptor of the current frame
+	signal		iRegDescFlags, next_iRegDescFlags			: std_logic_vector (31 DOWNTO 0);	-- flags of the descriptor of the current frame
+	signal		iRegDescWord, next_iRegDescWord				: unsigned (1 DOWNTO 0);			-- descriptor word being read
+	signal		iRegLoaded, next_iRegLoaded					: std_logic;						-- 1 when the buffer of the current frame is known
+	signal		iRegFrameNumber, next_iRegFrameNumber		: std_logic_vector (31 DOWNTO 0);	-- camera frame of the first burst of the current frame
+	signal		iRegFrameTime, next_iRegFrameTime			: std_logic_vector (31 DOWNTO 0);	-- timestamp of the first burst of the current frame
+	signal		iRegTrailerWord, next_iRegTrailerWord		: unsigned (1 DOWNTO 0);			-- trailer word being written
+	signal		iRegTimestamp								: unsigned (31 DOWNTO 0);			-- free-running counter of AM_Clk cycles
+	signal		iRegDroppedBase, next_iRegDroppedBase		: std_logic_vector (31 DOWNTO 0);	-- dropped lines counter when the previous trailer was written
+	signal		iRegCrc, next_iRegCrc						: std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the words of the current frame written so far
 	
-	TYPE		SM 	IS (WAITDATA, BEGINTRANSFER, BURST);
+	TYPE		SM 	IS (WAITDATA, READDESC, WAITDESC, BEGINTRANSFER, BURST, WRITETRAILER, WRITESTATUS);
 	signal		iRegStateSM, next_iRegStateSM				: SM;
 
 BEGIN
@@ -75,26 +158,74 @@ begin
 		iRegStateSM <= WAITDATA;
 		iRegCounterAddress <= (others => '0');
 		iRegBurstCount <= X"00";
+		iRegBufferAddress <= (others => '0');
+		iRegLength <= (others => '0');
+		iRegDescAddress <= (others => '0');
+		iRegDescFlags <= (others => '0');
+		iRegDescWord <= "00";
+		iRegLoaded <= '0';
+		iRegFrameNumber <= (others => '0');
+		iRegFrameTime <= (others => '0');
+		iRegTrailerWord <= "00";
+		iRegCrc <= (others => '1');
 		
 	elsif rising_edge(AM_Clk) then
 		iRegStateSM <= next_iRegStateSM;
 		iRegCounterAddress <= next_iRegCounterAddress;
 		iRegBurstCount <= next_iRegBurstCount;
+		iRegBufferAddress <= next_iRegBufferAddress;
+		iRegLength <= next_iRegLength;
+		iRegDescAddress <= next_iRegDescAddress;
+		iRegDescFlags <= next_iRegDescFlags;
+		iRegDescWord <= next_iRegDescWord;
+		iRegLoaded <= next_iRegLoaded;
+		iRegFrameNumber <= next_iRegFrameNumber;
+		iRegFrameTime <= next_iRegFrameTime;
+		iRegTrailerWord <= next_iRegTrailerWord;
+		iRegCrc <= next_iRegCrc;
 	end if;
 end process;
 
-process(iRegCounterAddress, iRegStateSM, iRegBurstCount, AM_FIFO_UsedWords, iRegAlmostEmpty, AM_AS_Start, AM_FIFO_ReadData, AM_AS_StartAddress, AM_AB_WaitRequest, AM_AS_Length)
+-- The timestamp and the dropped lines base keep counting while the acquisition is stopped
+process(AM_nReset, AM_Clk)
+begin
+	if AM_nReset = '0' then
+		iRegTimestamp <= (others => '0');
+		iRegDroppedBase <= (others => '0');
+	elsif rising_edge(AM_Clk) then
+		iRegTimestamp <= iRegTimestamp + 1;
+		iRegDroppedBase <= next_iRegDroppedBase;
+	end if;
+end process;
+
+process(iRegCounterAddress, iRegStateSM, iRegBurstCount, AM_FIFO_UsedWords, iRegAlmostEmpty, AM_AS_Start, AM_FIFO_ReadData, AM_AS_StartAddress, AM_AB_WaitRequest, AM_AS_Length,
+		AM_AS_Descriptor, AM_AB_ReadData, AM_AB_ReadDataValid, iRegBufferAddress, iRegLength, iRegDescAddress, iRegDescFlags, iRegDescWord, iRegLoaded,
+		AM_AS_Trailer, AM_AS_Format, AM_CI_FrameCount, AM_CI_DroppedLines, iRegFrameNumber, iRegFrameTime, iRegTrailerWord, iRegTimestamp, iRegDroppedBase,
+		iRegCrc)
 begin
 	next_iRegCounterAddress <= iRegCounterAddress;
 	next_iRegStateSM <= iRegStateSM;
 	next_iRegBurstCount <= iRegBurstCount;
+	next_iRegBufferAddress <= iRegBufferAddress;
+	next_iRegLength <= iRegLength;
+	next_iRegDescAddress <= iRegDescAddress;
+	next_iRegDescFlags <= iRegDescFlags;
+	next_iRegDescWord <= iRegDescWord;
+	next_iRegLoaded <= iRegLoaded;
+	next_iRegFrameNumber <= iRegFrameNumber;
+	next_iRegFrameTime <= iRegFrameTime;
+	next_iRegTrailerWord <= iRegTrailerWord;
+	next_iRegDroppedBase <= iRegDroppedBase;
+	next_iRegCrc <= iRegCrc;
 	
 	AM_FIFO_ReadCheck <= '0';
 	AM_AB_WriteAccess <= '0';
+	AM_AB_ReadAccess <= '0';
 	AM_AB_MemoryAddress <= (others => '0');
 	AM_AB_MemoryData <= (others => '0');
 	AM_AB_BurstCount <= (others => '0');
 	AM_AS_Status <= '0';
+	AM_AS_Crc <= not iRegCrc;
 	
 	if unsigned(AM_FIFO_UsedWords) < BURSTCOUNT_LENGTH then
 		iRegAlmostEmpty <= '1';
@@ -106,17 +237,61 @@ begin
 	
 		when WAITDATA =>
 			if iRegAlmostEmpty = '0' AND AM_AS_Start = '1' then
-				next_iRegStateSM <= BEGINTRANSFER;
+				if iRegLoaded = '0' then	-- first burst of a frame, stamp it for the trailer
+					next_iRegFrameNumber <= AM_CI_FrameCount;
+					next_iRegFrameTime <= std_logic_vector(iRegTimestamp);
+					next_iRegCrc <= (others => '1');
+				end if;
+				
+				if iRegLoaded = '1' then
+					next_iRegStateSM <= BEGINTRANSFER;
+				elsif AM_AS_Descriptor = '1' then	-- first burst of a frame, fetch the descriptor of the buffer
+					next_iRegDescAddress <= AM_AS_StartAddress;
+					next_iRegDescWord <= "00";
+					next_iRegStateSM <= READDESC;
+				else	-- first burst of a frame, the buffer is given by the slave
+					next_iRegBufferAddress <= AM_AS_StartAddress;
+					next_iRegLength <= AM_AS_Length;
+					next_iRegLoaded <= '1';
+					next_iRegStateSM <= BEGINTRANSFER;
+				end if;
+			end if;
+			
+		when READDESC =>
+			AM_AB_BurstCount <= X"01";
+			AM_AB_MemoryAddress <= std_logic_vector(unsigned(iRegDescAddress) + (iRegDescWord & "00"));
+			AM_AB_ReadAccess <= '1';
+			
+			if AM_AB_WaitRequest = '0' then
+				next_iRegStateSM <= WAITDESC;
+			end if;
+			
+		when WAITDESC =>
+			if AM_AB_ReadDataValid = '1' then
+				case iRegDescWord is
+					when "00" => next_iRegBufferAddress <= AM_AB_ReadData;
+					when "01" => next_iRegLength <= AM_AB_ReadData;
+					when others => next_iRegDescFlags <= AM_AB_ReadData;
+				end case;
+				
+				if iRegDescWord = "10" then
+					next_iRegLoaded <= '1';
+					next_iRegStateSM <= BEGINTRANSFER;
+				else
+					next_iRegDescWord <= iRegDescWord + 1;
+					next_iRegStateSM <= READDESC;
+				end if;
 			end if;
 			
 		when BEGINTRANSFER =>
 			AM_AB_BurstCount <= std_logic_vector(BURSTCOUNT_LENGTH);
-			AM_AB_MemoryAddress <= std_logic_vector(unsigned(AM_AS_StartAddress) + unsigned(iRegCounterAddress));
+			AM_AB_MemoryAddress <= std_logic_vector(unsigned(iRegBufferAddress) + unsigned(iRegCounterAddress));
 			AM_AB_MemoryData <= AM_FIFO_ReadData;
 			AM_AB_WriteAccess <= '1';
 			
 			if AM_AB_WaitRequest = '0' then
 				AM_FIFO_ReadCheck <= '1';
+				next_iRegCrc <= crc32_word(iRegCrc, AM_FIFO_ReadData);
 				next_iRegBurstCount <= iRegBurstCount + 1;
 				next_iRegStateSM <= BURST;
 			end if;
@@ -128,6 +303,7 @@ begin
 			if AM_AB_WaitRequest = '0' then
 			
 				AM_FIFO_ReadCheck <= '1';
+				next_iRegCrc <= crc32_word(iRegCrc, AM_FIFO_ReadData);
 				next_iRegBurstCount <= iRegBurstCount + 1;
 				
 				if iRegBurstCount = BURSTCOUNT_LENGTH - 1 then
@@ -136,14 +312,60 @@ begin
 					next_iRegBurstCount <= X"00";
 					next_iRegCounterAddress <= std_logic_vector(unsigned(iRegCounterAddress) + ADDR_INCREMENT); -- increase the iRegCounterAdress register
 					
-					if unsigned(iRegCounterAddress) = unsigned(AM_AS_Length) - ADDR_INCREMENT then
+					if unsigned(iRegCounterAddress) = unsigned(iRegLength) - ADDR_INCREMENT then
 						next_iRegCounterAddress <= (others => '0');
-						AM_AS_Status <= '1'; --tell to the slave that the image is finished
+						next_iRegLoaded <= '0';
+						if AM_AS_Trailer = '1' then
+							next_iRegStateSM <= WRITETRAILER;	-- write the trailer after the frame
+						elsif AM_AS_Descriptor = '1' then
+							next_iRegStateSM <= WRITESTATUS;	-- write the status back before giving the buffer to the firmware
+						else
+							AM_AS_Status <= '1'; --tell to the slave that the image is finished
+							AM_AS_Crc <= not crc32_word(iRegCrc, AM_FIFO_ReadData);	-- the last word is not in iRegCrc yet
+						end if;
 					end if;
 					
 				end if;
 
 			end if;
+			
+		when WRITETRAILER =>
+			AM_AB_BurstCount <= X"01";
+			AM_AB_MemoryAddress <= std_logic_vector(unsigned(iRegBufferAddress) + unsigned(iRegLength) + (iRegTrailerWord & "00"));
+			case iRegTrailerWord is
+				when "00" => AM_AB_MemoryData <= iRegFrameNumber;
+				when "01" => AM_AB_MemoryData <= iRegFrameTime;
+				when "10" => AM_AB_MemoryData <= std_logic_vector(unsigned(AM_CI_DroppedLines) - unsigned(iRegDroppedBase));
+				when others => AM_AB_MemoryData <= TRAILER_MAGIC & iRegDescFlags (7 DOWNTO 0) & AM_AS_Format;
+			end case;
+			AM_AB_WriteAccess <= '1';
+			
+			if AM_AB_WaitRequest = '0' then
+				next_iRegTrailerWord <= iRegTrailerWord + 1;
+				if iRegTrailerWord = "10" then
+					next_iRegDroppedBase <= AM_CI_DroppedLines;
+				end if;
+				
+				if iRegTrailerWord = "11" then
+					if AM_AS_Descriptor = '1' then
+						next_iRegStateSM <= WRITESTATUS;
+					else
+						AM_AS_Status <= '1'; --tell to the slave that the image is finished
+						next_iRegStateSM <= WAITDATA;
+					end if;
+				end if;
+			end if;
+			
+		when WRITESTATUS =>
+			AM_AB_BurstCount <= X"01";
+			AM_AB_MemoryAddress <= std_logic_vector(unsigned(iRegDescAddress) + DESC_STATUS_OFFSET);
+			AM_AB_MemoryData <= X"0000" & iRegDescFlags (7 DOWNTO 0) & X"01";
+			AM_AB_WriteAccess <= '1';
+			
+			if AM_AB_WaitRequest = '0' then
+				AM_AS_Status <= '1'; --tell to the slave that the image is finished
+				next_iRegStateSM <= WAITDATA;
+			end if;
 		
 	end case;
 end process;
@@ -9,8 +9,57 @@
 -- ADRESSES
 --  0x00: AS_ALL_Start information
 --  ---- ---X : X = AS_ALL_Start information, 1 = ON, 0 = OFF
--- 	0x01: AS_ALL_Start address of the stored datas in the memory
+--  ---- --X- : X = descriptor mode, 1 = the buffers are described by a table of descriptors
+--  ---- -X-- : X = trailer, 1 = a 16 bytes trailer is written after each frame (see the Avalon master)
+-- 	0x01: AS_ALL_Start address of the stored datas in the memory (address of buffer 0)
 -- 	0x05: AS_AM_Length of the stored data in the memory
+-- 	0x09: ring head (read only), next buffer to be written by the controller
+-- 	---- XXXX : index of the buffer, bit 7 toggles each time the index wraps
+-- 	0x0A: ring tail, oldest buffer still owned by the firmware
+-- 	---- XXXX : index of the buffer, bit 7 toggles each time the index wraps
+-- 	0x0B: number of buffers in the ring (1 to MAX_BUFFERS), writing it empties the ring
+-- 	0x0C: stride between two consecutive buffers in the memory
+-- 	0x10: format of the output image, writing it also sets the length of a frame
+-- 	---- --XX : downscaling, 00 = 320*240, 01 = 160*120, 10 = 80*60
+-- 	---- XX-- : pixel format, 00 = RGB 5*6*5 (16 bits), 01 = luminance (8 bits),
+-- 	            10 = raw Bayer 640*480 (12 bits in 16 bits), 11 = raw Bayer 640*480 (8 bits)
+-- 	            the downscaling is ignored for the raw formats
+-- 	---X ---- : 1 = bilinear demosaic of the 640*480 window instead of the binning,
+-- 	            the downscaling is ignored
+-- 	-XX- ---- : reduction of the channels to 5*6*5 bits, 00 = truncation,
+-- 	            01 = rounding, 10 = 4*4 ordered dither
+-- 	0x20: colour correction matrix, 9 coefficients of 2 bytes (0x20 to 0x31),
+-- 	      row major RR RG RB GR GG GB BR BG BB, signed with 8 fractional bits
+-- 	0x32: colour correction control
+-- 	---- --XY : X = gamma tables enabled, Y = matrix enabled
+-- 	0x33: gamma table to write, 0 = red, 1 = green, 2 = blue
+-- 	0x34: index of the next gamma table entry to write
+-- 	0x35: gamma table entry, bits 7->0 (write only)
+-- 	0x36: gamma table entry, bits 11->8 (write only), writes the entry and
+-- 	      increments the index
+-- 	0x38: CRC-32 of the buffer pointed by the ring tail (4 bytes, read only),
+-- 	      computed by the master while the frame was written
+-- 	0x40: motion detection control
+-- 	---- -XYZ : X = interrupt on alarm enabled, Y = reference updated with
+-- 	            each frame, Z = motion detection enabled
+-- 	0x41: difference of luminance above which a cell of 8*8 samples has changed
+-- 	0x42: number of changed cells above which a block of 4*4 cells has changed
+-- 	0x44: alarm threshold, number of changed cells above which the alarm is
+-- 	      raised (2 bytes, 0x44 to 0x45)
+-- 	0x46: motion detection status, write 1 to clear a bit
+-- 	---- --XY : X = alarm, Y = new results available
+-- 	0x48: number of changed cells in the last frame (2 bytes, read only)
+-- 	0x4A: number of changed blocks in the last frame (2 bytes, read only)
+-- 	0x50: bitmap of the changed blocks in the last frame (38 bytes, read only),
+-- 	      bit b of byte k is the block 8*k + b, block 20*row + column
+--
+-- The ring is empty when head = tail and full when the indexes are equal but
+-- the wrap bits differ. When the ring is full, the start information is
+-- removed until the firmware releases a buffer by moving the tail.
+--
+-- In descriptor mode, the start address points to a table of 16 bytes
+-- descriptors (one per buffer of the ring, see the Avalon master) and the
+-- stride is not used. The length is then given by each descriptor.
 -- 
 -- INPUTS
 -- AS_nReset <= extern
@@ -20,13 +69,21 @@
 -- AS_AB_ReadEnable <= Avalon Bus
 -- AS_AB_WriteEnable <= Avalon Bus
 -- AS_AB_WriteData <= Avalon Bus
+-- AS_AM_Status, AS_AM_Crc <= Master
+-- AS_MD_* <= Motion detector
 -- 
 -- OUTPUTS
 -- AS_AM_StartAddress => Master
 -- AS_AM_Length => Master
+-- AS_AM_Descriptor => Master
+-- AS_AM_Trailer => Master
 -- AS_ALL_Start information => Master, Camera Controller
+-- AS_CI_Format => Camera Controller
+-- AS_CI_ColorControl, AS_CI_Matrix, AS_CI_Lut* => Camera Controller
+-- AS_MD_Control, AS_MD_PixelThreshold, AS_MD_BlockThreshold => Motion detector
 --
 -- AS_AB_ReadData => Avalon Bus
+-- AS_IRQ => Avalon Bus (interrupt sender)
 
 LIBRARY ieee;
 USE ieee.std_logic_1164.all;
@@ -37,93 +94,238 @@ ENTITY Avalon_slave IS
 		AS_nReset			: IN std_logic;							-- AS_nReset input
 		AS_Clk				: IN std_logic;							-- clock input
 		
-		AS_AB_Address		: IN std_logic_vector (3 DOWNTO 0);		-- address bus
+		AS_AB_Address		: IN std_logic_vector (7 DOWNTO 0);		-- address bus
 		AS_AB_ReadEnable	: IN std_logic;							-- read enabler
 		AS_AB_WriteEnable	: IN std_logic;							-- write enabler
 		AS_AB_ReadData		: OUT std_logic_vector (7 DOWNTO 0);	-- data bus (read)
 		AS_AB_WriteData		: IN std_logic_vector (7 DOWNTO 0);		-- data bus (write)
+		AS_IRQ				: OUT std_logic;						-- interrupt request, 1 on a motion alarm
 		
 		AS_ALL_Start		: OUT std_logic;						-- Start information
 		
 		AS_AM_StartAddress	: OUT std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
 		AS_AM_Length		: OUT std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+		AS_AM_Descriptor	: OUT std_logic;						-- 1 when AS_AM_StartAddress points to a descriptor
 		AS_AM_Status		: IN std_logic;							-- 1 when the image has been written to the memory
+		AS_AM_Crc			: IN std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AS_AM_Status = 1
+		AS_AM_Trailer		: OUT std_logic;						-- 1 when a trailer is written after each frame
 		
-		AS_CI_Pending		: IN std_logic							-- Pending information
+		AS_CI_Pending		: IN std_logic;							-- Pending information
+		AS_CI_Format		: OUT std_logic_vector (7 DOWNTO 0);	-- Format of the output image (downscaling, pixel format)
+		AS_CI_ColorControl	: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+		AS_CI_Matrix		: OUT std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+		AS_CI_LutWrite		: OUT std_logic;						-- 1 = write AS_CI_LutData in a gamma table
+		AS_CI_LutAddress	: OUT std_logic_vector (9 DOWNTO 0);	-- Channel (9->8) and index (7->0) in the gamma tables
+		AS_CI_LutData		: OUT std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
+		
+		AS_MD_Control		: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = motion detection enabled (bit 0), reference updated (bit 1)
+		AS_MD_PixelThreshold: OUT std_logic_vector (7 DOWNTO 0);	-- Difference above which a cell has changed
+		AS_MD_BlockThreshold: OUT std_logic_vector (4 DOWNTO 0);	-- Number of changed cells above which a block has changed
+		AS_MD_Done			: IN std_logic;							-- 1 when the results of a frame are available
+		AS_MD_ChangedCells	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+		AS_MD_ChangedBlocks	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+		AS_MD_Bitmap		: IN std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame
 	);
 END Avalon_slave;
 
 ARCHITECTURE bhv OF Avalon_slave IS	
-	constant	BURST_LENGTH		: unsigned (31 DOWNTO 0) := X"00025800";
+	constant	BURST_LENGTH		: unsigned (31 DOWNTO 0) := X"00025800";	-- default stride, one 320*240*2 frame
+	constant	MAX_BUFFERS			: unsigned (7 DOWNTO 0) := X"10";		-- maximum number of buffers in the ring
+	constant	DESCRIPTOR_SIZE		: unsigned (31 DOWNTO 0) := X"00000010";	-- distance between two descriptors
+	constant	MATRIX_ADDRESS		: natural := 16#20#;				-- address of the first byte of the colour correction matrix
+	constant	BITMAP_ADDRESS		: natural := 16#50#;				-- address of the first byte of the motion bitmap
+	constant	BITMAP_BYTES		: natural := 38;					-- bytes of the motion bitmap, 300 blocks
+	constant	MATRIX_IDENTITY		: std_logic_vector (143 DOWNTO 0) := X"0100" & X"0000" & X"0000" & X"0000" & X"0100" & X"0000" & X"0000" & X"0000" & X"0100";
+	
+	-- Number of bytes of one frame in the given format
+	function frame_length(format : std_logic_vector (7 DOWNTO 0)) return std_logic_vector is
+		variable pixels : unsigned (31 DOWNTO 0);
+	begin
+		case format (1 DOWNTO 0) is
+			when "01" => pixels := X"00004B00";	-- 160*120
+			when "10" => pixels := X"000012C0";	-- 80*60
+			when others => pixels := X"00012C00";	-- 320*240
+		end case;
+		if format (3) = '1' OR format (4) = '1' then	-- raw samples or demosaic, not binned
+			pixels := X"0004B000";	-- 640*480
+		end if;
+		if format (2) = '1' then	-- 1 byte per pixel
+			return std_logic_vector(pixels);
+		else	-- 2 bytes per pixel
+			return std_logic_vector(pixels (30 DOWNTO 0) & '0');
+		end if;
+	end function frame_length;
 
 	signal		iRegStart			: std_logic_vector (7 DOWNTO 0);	-- internal register for the start information
 	signal		iRegStartAddress	: std_logic_vector (31 DOWNTO 0);	-- internal register for the memory Start adress
 	signal		iRegBufferAddress	: std_logic_vector (31 DOWNTO 0);	-- internal register for the buffer address
 	signal		iRegLength			: std_logic_vector (31 DOWNTO 0);	-- internal register for the data stored Length
-	signal		iRegStatus			: std_logic_vector (7 DOWNTO 0);	-- internal register for the status of each buffer
+	signal		iRegStride			: std_logic_vector (31 DOWNTO 0);	-- internal register for the distance between two buffers
+	signal		iRegNumBuffers		: std_logic_vector (7 DOWNTO 0);	-- internal register for the number of buffers in the ring
+	signal		iRegHead			: std_logic_vector (7 DOWNTO 0);	-- internal register for the next buffer to write (bit 7 = wrap)
+	signal		iRegTail			: std_logic_vector (7 DOWNTO 0);	-- internal register for the oldest buffer owned by the firmware (bit 7 = wrap)
+	signal		iRegFull			: std_logic;						-- 1 when every buffer of the ring is owned by the firmware
+	signal		iRegFormat			: std_logic_vector (7 DOWNTO 0);	-- internal register for the format of the output image
+	signal		iRegMatrix			: std_logic_vector (143 DOWNTO 0);	-- internal register for the colour correction matrix
+	signal		iRegColorControl	: std_logic_vector (7 DOWNTO 0);	-- internal register for the colour correction control
+	signal		iRegLutChannel		: std_logic_vector (7 DOWNTO 0);	-- internal register for the gamma table to write
+	signal		iRegLutIndex		: std_logic_vector (7 DOWNTO 0);	-- internal register for the next gamma table entry to write
+	signal		iRegLutData			: std_logic_vector (11 DOWNTO 0);	-- internal register for the gamma table entry
+	signal		iRegLutAddress		: std_logic_vector (9 DOWNTO 0);	-- internal register for the gamma table entry being written
+	signal		iRegLutWrite		: std_logic;						-- 1 during one clock when a gamma table entry is written
+	signal		iRegMotionControl	: std_logic_vector (7 DOWNTO 0);	-- internal register for the motion detection control
+	signal		iRegPixelThreshold	: std_logic_vector (7 DOWNTO 0);	-- internal register for the cell threshold
+	signal		iRegBlockThreshold	: std_logic_vector (7 DOWNTO 0);	-- internal register for the block threshold
+	signal		iRegAlarmThreshold	: std_logic_vector (15 DOWNTO 0);	-- internal register for the alarm threshold
+	signal		iRegMotionStatus	: std_logic_vector (7 DOWNTO 0);	-- internal register for the motion detection status
+	signal		iRegBitmap			: std_logic_vector (8*BITMAP_BYTES - 1 DOWNTO 0);	-- motion bitmap padded to whole bytes
+	TYPE		CrcArray is array (0 TO to_integer(MAX_BUFFERS)-1) of std_logic_vector (31 DOWNTO 0);
+	signal		iRegCrc				: CrcArray;							-- internal register for the CRC-32 of each buffer of the ring
 	signal		prevStatus			: std_logic;						-- previous state of AS_AM_Status
-	signal		nextBuffer			: std_logic_vector (1 DOWNTO 0);	-- next buffer to write
 
 BEGIN
 
+iRegBitmap <= X"0" & AS_MD_Bitmap;
+
+-- The ring is full when both indexes point to the same buffer after a different number of wraps
+iRegFull <= '1' when iRegHead (6 DOWNTO 0) = iRegTail (6 DOWNTO 0) AND iRegHead (7) /= iRegTail (7) else '0';
+
 -- Process to write internal registers through Avalon bus interface
 -- Synchronous access on rising edge of the FPGA's clock
 WriteProcess:
 Process(AS_nReset, AS_Clk)
 Begin
-	if AS_nReset = '0' then	-- reset the four writable registers when pushing the reset key
+	if AS_nReset = '0' then	-- reset the writable registers when pushing the reset key
 		iRegStart			<= (others => '0');
 		iRegStartAddress	<= (others => '0');
 		iRegBufferAddress	<= (others => '0');
 		iRegLength			<= (others => '0');
-		iRegStatus			<= (others => '0');
+		iRegStride			<= std_logic_vector(BURST_LENGTH);
+		iRegNumBuffers		<= X"03";
+		iRegHead			<= (others => '0');
+		iRegTail			<= (others => '0');
+		iRegFormat			<= (others => '0');
+		iRegMatrix			<= MATRIX_IDENTITY;
+		iRegColorControl	<= (others => '0');
+		iRegLutChannel		<= (others => '0');
+		iRegLutIndex		<= (others => '0');
+		iRegLutData			<= (others => '0');
+		iRegLutAddress		<= (others => '0');
+		iRegLutWrite		<= '0';
+		iRegMotionControl	<= (others => '0');
+		iRegPixelThreshold	<= X"10";
+		iRegBlockThreshold	<= X"04";
+		iRegAlarmThreshold	<= (others => '0');
+		iRegMotionStatus	<= (others => '0');
+		iRegCrc				<= (others => (others => '0'));
 		prevStatus 			<= '0';
-		nextBuffer 			<= "00";
 	elsif rising_edge(AS_Clk) then
+		iRegLutWrite <= '0';
 		if AS_AB_WriteEnable = '1' then
+			for k in 0 TO 17 loop	-- bytes of the colour correction matrix
+				if unsigned(AS_AB_Address) = MATRIX_ADDRESS + k then
+					iRegMatrix (8*k + 7 DOWNTO 8*k) <= AS_AB_WriteData;
+				end if;
+			end loop;
+			
 			case AS_AB_Address is
-				when X"0" => iRegStart	<= AS_AB_WriteData;
-				when X"1" => 
+				when X"00" => iRegStart	<= AS_AB_WriteData;
+				when X"01" => 
 						iRegStartAddress (7 DOWNTO 0)	<= AS_AB_WriteData;
 						iRegBufferAddress (7 DOWNTO 0)	<= AS_AB_WriteData;
-				when X"2" => 
+				when X"02" => 
 						iRegStartAddress (15 DOWNTO 8)	<= AS_AB_WriteData;
 						iRegBufferAddress (15 DOWNTO 8)	<= AS_AB_WriteData;
-				when X"3" => 
+				when X"03" => 
 						iRegStartAddress (23 DOWNTO 16)	<= AS_AB_WriteData;
 						iRegBufferAddress (23 DOWNTO 16)<= AS_AB_WriteData;
-				when X"4" => 
+				when X"04" => 
 						iRegStartAddress (31 DOWNTO 24)	<= AS_AB_WriteData;
 						iRegBufferAddress (31 DOWNTO 24)<= AS_AB_WriteData;
-				when X"5" => 
+				when X"05" => 
 						iRegLength (7 DOWNTO 0)			<= AS_AB_WriteData;
-				when X"6" => 
+				when X"06" => 
 						iRegLength (15 DOWNTO 8)		<= AS_AB_WriteData;
-				when X"7" => 
+				when X"07" => 
 						iRegLength (23 DOWNTO 16)		<= AS_AB_WriteData;
-				when X"8" => 
+				when X"08" => 
 						iRegLength (31 DOWNTO 24)		<= AS_AB_WriteData;
-				when X"9" =>
-					iRegStatus	<= AS_AB_WriteData;
+				when X"0A" =>
+						iRegTail						<= AS_AB_WriteData;
+				when X"0B" =>	-- a new ring size empties the ring and restarts from the first buffer
+						if unsigned(AS_AB_WriteData) = 0 then
+							iRegNumBuffers				<= X"01";
+						elsif unsigned(AS_AB_WriteData) > MAX_BUFFERS then
+							iRegNumBuffers				<= std_logic_vector(MAX_BUFFERS);
+						else
+							iRegNumBuffers				<= AS_AB_WriteData;
+						end if;
+						iRegHead						<= (others => '0');
+						iRegTail						<= (others => '0');
+						iRegBufferAddress				<= iRegStartAddress;
+				when X"0C" => 
+						iRegStride (7 DOWNTO 0)			<= AS_AB_WriteData;
+				when X"0D" => 
+						iRegStride (15 DOWNTO 8)		<= AS_AB_WriteData;
+				when X"0E" => 
+						iRegStride (23 DOWNTO 16)		<= AS_AB_WriteData;
+				when X"0F" => 
+						iRegStride (31 DOWNTO 24)		<= AS_AB_WriteData;
+				when X"10" =>	-- the length follows the size of the new format
+						iRegFormat						<= AS_AB_WriteData;
+						iRegLength						<= frame_length(AS_AB_WriteData);
+				when X"32" =>
+						iRegColorControl				<= AS_AB_WriteData;
+				when X"33" =>
+						iRegLutChannel					<= AS_AB_WriteData;
+				when X"34" =>
+						iRegLutIndex					<= AS_AB_WriteData;
+				when X"35" =>
+						iRegLutData (7 DOWNTO 0)		<= AS_AB_WriteData;
+				when X"36" =>	-- write the entry, then move to the next one
+						iRegLutData (11 DOWNTO 8)		<= AS_AB_WriteData (3 DOWNTO 0);
+						iRegLutAddress					<= iRegLutChannel (1 DOWNTO 0) & iRegLutIndex;
+						iRegLutWrite					<= '1';
+						iRegLutIndex					<= std_logic_vector(unsigned(iRegLutIndex) + 1);
+				when X"40" =>
+						iRegMotionControl				<= AS_AB_WriteData;
+				when X"41" =>
+						iRegPixelThreshold				<= AS_AB_WriteData;
+				when X"42" =>
+						iRegBlockThreshold				<= AS_AB_WriteData;
+				when X"44" =>
+						iRegAlarmThreshold (7 DOWNTO 0)	<= AS_AB_WriteData;
+				when X"45" =>
+						iRegAlarmThreshold (15 DOWNTO 8)<= AS_AB_WriteData;
+				when X"46" =>	-- write 1 to clear
+						iRegMotionStatus				<= iRegMotionStatus AND (not AS_AB_WriteData);
 				when others => null;
 			end case;
-		elsif AS_AM_Status = '1' AND prevStatus = '0' then
-			prevStatus <= '1';
-			if iRegStatus (0) = '0' AND nextBuffer = "00" then
-				iRegStatus (0) <= '1';
-				iRegBufferAddress <= std_logic_vector(unsigned(iRegStartAddress) + BURST_LENGTH);
-				nextBuffer <= "01";
-			elsif iRegStatus (1) = '0' AND nextBuffer = "01" then
-				iRegStatus (1) <= '1';
-				iRegBufferAddress <= std_logic_vector(unsigned(iRegStartAddress) + BURST_LENGTH + BURST_LENGTH);
-				nextBuffer <= "10";
-			elsif iRegStatus (2) = '0' AND nextBuffer = "10" then
-				iRegStatus (2) <= '1';
-				iRegBufferAddress <= iRegStartAddress;
-				nextBuffer <= "00";
+		end if;
+		
+		if AS_MD_Done = '1' then	-- new results of the motion detector, wins over the clear
+			iRegMotionStatus (0) <= '1';
+			if unsigned(AS_MD_ChangedCells) > unsigned(iRegAlarmThreshold) then
+				iRegMotionStatus (1) <= '1';
+			end if;
+		end if;
+		
+		prevStatus <= AS_AM_Status;
+		if AS_AM_Status = '1' AND prevStatus = '0' then	-- the buffer pointed by the head is now full, move to the next one
+			if iRegFull = '0' then
+				iRegCrc(to_integer(unsigned(iRegHead (3 DOWNTO 0)))) <= AS_AM_Crc;
+				if unsigned(iRegHead (6 DOWNTO 0)) = unsigned(iRegNumBuffers) - 1 then
+					iRegHead <= (not iRegHead (7)) & "0000000";
+					iRegBufferAddress <= iRegStartAddress;
+				else
+					iRegHead <= std_logic_vector(unsigned(iRegHead) + 1);
+					if iRegStart (1) = '1' then
+						iRegBufferAddress <= std_logic_vector(unsigned(iRegBufferAddress) + DESCRIPTOR_SIZE);
+					else
+						iRegBufferAddress <= std_logic_vector(unsigned(iRegBufferAddress) + unsigned(iRegStride));
+					end if;
+				end if;
 			end if;
-		elsif AS_AM_Status = '0' AND prevStatus = '1' then
-			prevStatus <= '0';
 		end if;
 	end if;
 end process WriteProcess;
@@ -131,38 +333,99 @@ end process WriteProcess;
 -- Process to read internal registers through Avalon bus interface
 -- Synchronous access on rising edge of the FPGA's clock with 1 wait
 ReadProcess:
-Process(AS_AB_ReadEnable, AS_AB_Address, iRegStart, iRegStartAddress, iRegLength, iRegStatus)
+Process(AS_AB_ReadEnable, AS_AB_Address, iRegStart, iRegStartAddress, iRegLength, iRegHead, iRegTail, iRegNumBuffers, iRegStride, iRegFormat,
+		iRegMatrix, iRegColorControl, iRegLutChannel, iRegLutIndex, iRegMotionControl, iRegPixelThreshold, iRegBlockThreshold,
+		iRegAlarmThreshold, iRegMotionStatus, AS_MD_ChangedCells, AS_MD_ChangedBlocks, iRegBitmap, iRegCrc)
 Begin
 	AS_AB_ReadData <= (others => '0');	-- reset the data bus (read) when not used
 	if AS_AB_ReadEnable = '1' then
+		for k in 0 TO 17 loop	-- bytes of the colour correction matrix
+			if unsigned(AS_AB_Address) = MATRIX_ADDRESS + k then
+				AS_AB_ReadData <= iRegMatrix (8*k + 7 DOWNTO 8*k);
+			end if;
+		end loop;
+		for k in 0 TO BITMAP_BYTES-1 loop	-- bytes of the motion bitmap
+			if unsigned(AS_AB_Address) = BITMAP_ADDRESS + k then
+				AS_AB_ReadData <= iRegBitmap (8*k + 7 DOWNTO 8*k);
+			end if;
+		end loop;
+		
 		case AS_AB_Address is
-			when X"0" => AS_AB_ReadData 	<= iRegStart;
-			when X"1" => AS_AB_ReadData 	<= iRegStartAddress (7 DOWNTO 0);
-			when X"2" => AS_AB_ReadData 	<= iRegStartAddress (15 DOWNTO 8);
-			when X"3" => AS_AB_ReadData 	<= iRegStartAddress (23 DOWNTO 16);
-			when X"4" => AS_AB_ReadData 	<= iRegStartAddress (31 DOWNTO 24);
-			when X"5" => AS_AB_ReadData 	<= iRegLength (7 DOWNTO 0);
-			when X"6" => AS_AB_ReadData 	<= iRegLength (15 DOWNTO 8);
-			when X"7" => AS_AB_ReadData 	<= iRegLength (23 DOWNTO 16);
-			when X"8" => AS_AB_ReadData 	<= iRegLength (31 DOWNTO 24);
-			when X"9" => AS_AB_ReadData 	<= iRegStatus;
+			when X"00" => AS_AB_ReadData 	<= iRegStart;
+			when X"01" => AS_AB_ReadData 	<= iRegStartAddress (7 DOWNTO 0);
+			when X"02" => AS_AB_ReadData 	<= iRegStartAddress (15 DOWNTO 8);
+			when X"03" => AS_AB_ReadData 	<= iRegStartAddress (23 DOWNTO 16);
+			when X"04" => AS_AB_ReadData 	<= iRegStartAddress (31 DOWNTO 24);
+			when X"05" => AS_AB_ReadData 	<= iRegLength (7 DOWNTO 0);
+			when X"06" => AS_AB_ReadData 	<= iRegLength (15 DOWNTO 8);
+			when X"07" => AS_AB_ReadData 	<= iRegLength (23 DOWNTO 16);
+			when X"08" => AS_AB_ReadData 	<= iRegLength (31 DOWNTO 24);
+			when X"09" => AS_AB_ReadData 	<= iRegHead;
+			when X"0A" => AS_AB_ReadData 	<= iRegTail;
+			when X"0B" => AS_AB_ReadData 	<= iRegNumBuffers;
+			when X"0C" => AS_AB_ReadData 	<= iRegStride (7 DOWNTO 0);
+			when X"0D" => AS_AB_ReadData 	<= iRegStride (15 DOWNTO 8);
+			when X"0E" => AS_AB_ReadData 	<= iRegStride (23 DOWNTO 16);
+			when X"0F" => AS_AB_ReadData 	<= iRegStride (31 DOWNTO 24);
+			when X"10" => AS_AB_ReadData 	<= iRegFormat;
+			when X"32" => AS_AB_ReadData 	<= iRegColorControl;
+			when X"33" => AS_AB_ReadData 	<= iRegLutChannel;
+			when X"34" => AS_AB_ReadData 	<= iRegLutIndex;
+			when X"38" => AS_AB_ReadData 	<= iRegCrc(to_integer(unsigned(iRegTail (3 DOWNTO 0)))) (7 DOWNTO 0);
+			when X"39" => AS_AB_ReadData 	<= iRegCrc(to_integer(unsigned(iRegTail (3 DOWNTO 0)))) (15 DOWNTO 8);
+			when X"3A" => AS_AB_ReadData 	<= iRegCrc(to_integer(unsigned(iRegTail (3 DOWNTO 0)))) (23 DOWNTO 16);
+			when X"3B" => AS_AB_ReadData 	<= iRegCrc(to_integer(unsigned(iRegTail (3 DOWNTO 0)))) (31 DOWNTO 24);
+			when X"40" => AS_AB_ReadData 	<= iRegMotionControl;
+			when X"41" => AS_AB_ReadData 	<= iRegPixelThreshold;
+			when X"42" => AS_AB_ReadData 	<= iRegBlockThreshold;
+			when X"44" => AS_AB_ReadData 	<= iRegAlarmThreshold (7 DOWNTO 0);
+			when X"45" => AS_AB_ReadData 	<= iRegAlarmThreshold (15 DOWNTO 8);
+			when X"46" => AS_AB_ReadData 	<= iRegMotionStatus;
+			when X"48" => AS_AB_ReadData 	<= AS_MD_ChangedCells (7 DOWNTO 0);
+			when X"49" => AS_AB_ReadData 	<= AS_MD_ChangedCells (15 DOWNTO 8);
+			when X"4A" => AS_AB_ReadData 	<= AS_MD_ChangedBlocks (7 DOWNTO 0);
+			when X"4B" => AS_AB_ReadData 	<= AS_MD_ChangedBlocks (15 DOWNTO 8);
 			when others => null;
 		end case;
 	end if;
 end process ReadProcess;
 
--- Process to update the output towards the master and the camera controller
+-- Process to update the output towards the master, the camera controller and the motion detector
 UpdateOutput:
 Process(AS_nReset, AS_Clk)
 Begin
 	if AS_nReset = '0' then
 		AS_AM_StartAddress <= (others => '0');
 		AS_AM_Length <= (others => '0');
+		AS_AM_Descriptor <= '0';
+		AS_AM_Trailer <= '0';
+		AS_CI_Format <= (others => '0');
+		AS_CI_ColorControl <= "00";
+		AS_CI_Matrix <= MATRIX_IDENTITY;
+		AS_CI_LutWrite <= '0';
+		AS_CI_LutAddress <= (others => '0');
+		AS_CI_LutData <= (others => '0');
+		AS_MD_Control <= "00";
+		AS_MD_PixelThreshold <= (others => '0');
+		AS_MD_BlockThreshold <= (others => '0');
+		AS_IRQ <= '0';
 		AS_ALL_Start <= '0';
 	elsif rising_edge(AS_Clk) then
 		AS_AM_StartAddress <= iRegBufferAddress;
 		AS_AM_Length <= iRegLength;
-		AS_ALL_Start <= (iRegStart (0)) AND (not AS_CI_Pending);
+		AS_AM_Descriptor <= iRegStart (1);
+		AS_AM_Trailer <= iRegStart (2);
+		AS_CI_Format <= iRegFormat;
+		AS_CI_ColorControl <= iRegColorControl (1 DOWNTO 0);
+		AS_CI_Matrix <= iRegMatrix;
+		AS_CI_LutWrite <= iRegLutWrite;
+		AS_CI_LutAddress <= iRegLutAddress;
+		AS_CI_LutData <= iRegLutData;
+		AS_MD_Control <= iRegMotionControl (1 DOWNTO 0);
+		AS_MD_PixelThreshold <= iRegPixelThreshold;
+		AS_MD_BlockThreshold <= iRegBlockThreshold (4 DOWNTO 0);
+		AS_IRQ <= iRegMotionStatus (1) AND iRegMotionControl (2);
+		AS_ALL_Start <= (iRegStart (0)) AND (not AS_CI_Pending) AND (not iRegFull);
 	end if;
 end process UpdateOutput;
 
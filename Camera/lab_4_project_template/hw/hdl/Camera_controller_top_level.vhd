@@ -11,20 +11,27 @@ USE ieee.std_logic_1164.all;
 USE ieee.numeric_std.all;
 
 ENTITY Top_Camera_Controller IS
+	GENERIC(
+		FIFO_DEPTH_LOG2			: natural := 10							-- log2 of the FIFO depth in 16 bits words (10 to 13 -> 2 KB to 16 KB)
+	);
 	PORT(
 		TL_nReset				: IN std_logic;							-- nReset input
 		TL_MainClk				: IN std_logic;							-- main clock input, FIFO read clock input
 		TL_PixClk				: IN std_logic;							-- pixel clock received from the camera, FIFO write clock input
 		
-		TL_AS_AB_Address		: IN std_logic_vector (3 DOWNTO 0);		-- address bus
+		TL_AS_AB_Address		: IN std_logic_vector (7 DOWNTO 0);		-- address bus
 		TL_AS_AB_ReadEnable		: IN std_logic;							-- read enabler
 		TL_AS_AB_WriteEnable	: IN std_logic;							-- write enabler
 		TL_AS_AB_ReadData		: OUT std_logic_vector (7 DOWNTO 0);	-- data bus (read)
 		TL_AS_AB_WriteData		: IN std_logic_vector (7 DOWNTO 0);	-- data bus (write)
+		TL_AS_IRQ				: OUT std_logic;						-- interrupt request, 1 on a motion alarm
 		
 		TL_AM_AB_MemoryAddress	: OUT std_logic_vector (31 DOWNTO 0);	-- Address sent on the Avalon bus
 		TL_AM_AB_MemoryData		: OUT std_logic_vector (31 DOWNTO 0);	-- Datas sent on the Avalon bus
 		TL_AM_AB_WriteAccess	: OUT std_logic;						-- Pin write, 1 when the component wants to use the bus
+		TL_AM_AB_ReadAccess		: OUT std_logic;						-- Pin read, 1 when the component wants to read a descriptor
+		TL_AM_AB_ReadData		: IN std_logic_vector (31 DOWNTO 0);	-- Datas received from the Avalon bus
+		TL_AM_AB_ReadDataValid	: IN std_logic;							-- Pin readdatavalid, 1 when TL_AM_AB_ReadData holds the requested word
 		TL_AM_AB_BurstCount		: OUT std_logic_vector (7 DOWNTO 0);	-- Number of datas in one burst
 		TL_AM_AB_WaitRequest	: IN std_logic;							-- Pin waitrequest which is 0 when the bus is available
 		
@@ -41,23 +48,44 @@ ARCHITECTURE bhv OF Top_Camera_Controller IS
 			AS_nReset			: IN std_logic;							-- nReset input
 			AS_Clk				: IN std_logic;							-- clock input
 		
-			AS_AB_Address		: IN std_logic_vector (3 DOWNTO 0);		-- address bus
+			AS_AB_Address		: IN std_logic_vector (7 DOWNTO 0);		-- address bus
 			AS_AB_ReadEnable	: IN std_logic;							-- read enabler
 			AS_AB_WriteEnable	: IN std_logic;							-- write enabler
 			AS_AB_ReadData		: OUT std_logic_vector (7 DOWNTO 0);	-- data bus (read)
 			AS_AB_WriteData		: IN std_logic_vector (7 DOWNTO 0);	-- data bus (write)
+			AS_IRQ				: OUT std_logic;						-- interrupt request, 1 on a motion alarm
 		
 			AS_ALL_Start		: OUT std_logic;						-- Start information
 			
 			AS_AM_StartAddress	: OUT std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
 			AS_AM_Length		: OUT std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+			AS_AM_Descriptor	: OUT std_logic;						-- 1 when AS_AM_StartAddress points to a descriptor
 			AS_AM_Status		: IN std_logic;							-- 1 when the image has been written to the memory
+			AS_AM_Crc			: IN std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AS_AM_Status = 1
+			AS_AM_Trailer		: OUT std_logic;						-- 1 when a trailer is written after each frame
+			
+			AS_CI_Pending		: IN std_logic;							-- Pending information
+			AS_CI_Format		: OUT std_logic_vector (7 DOWNTO 0);	-- Format of the output image (downscaling, pixel format)
+			AS_CI_ColorControl	: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+			AS_CI_Matrix		: OUT std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+			AS_CI_LutWrite		: OUT std_logic;						-- 1 = write AS_CI_LutData in a gamma table
+			AS_CI_LutAddress	: OUT std_logic_vector (9 DOWNTO 0);	-- Channel (9->8) and index (7->0) in the gamma tables
+			AS_CI_LutData		: OUT std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
 			
-			AS_CI_Pending		: IN std_logic							-- Pending information
+			AS_MD_Control		: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = motion detection enabled (bit 0), reference updated (bit 1)
+			AS_MD_PixelThreshold: OUT std_logic_vector (7 DOWNTO 0);	-- Difference above which a cell has changed
+			AS_MD_BlockThreshold: OUT std_logic_vector (4 DOWNTO 0);	-- Number of changed cells above which a block has changed
+			AS_MD_Done			: IN std_logic;							-- 1 when the results of a frame are available
+			AS_MD_ChangedCells	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+			AS_MD_ChangedBlocks	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+			AS_MD_Bitmap		: IN std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame
 		);
 	END COMPONENT;
 	
 	COMPONENT Avalon_Master
+		GENERIC(
+			FIFO_DEPTH_LOG2		: natural
+		);
         PORT(
 			AM_nReset			: IN std_logic;							-- nReset input
 			AM_Clk				: IN std_logic;							-- clock input
@@ -65,21 +93,34 @@ ARCHITECTURE bhv OF Top_Camera_Controller IS
 			AM_AB_MemoryAddress	: OUT std_logic_vector (31 DOWNTO 0);	-- Address sent on the Avalon bus
 			AM_AB_MemoryData	: OUT std_logic_vector (31 DOWNTO 0);	-- Datas sent on the Avalon bus
 			AM_AB_WriteAccess	: OUT std_logic;						-- Pin write, 1 when the component wants to use the bus
+			AM_AB_ReadAccess	: OUT std_logic;						-- Pin read, 1 when the component wants to read a descriptor
+			AM_AB_ReadData		: IN std_logic_vector (31 DOWNTO 0);	-- Datas received from the Avalon bus
+			AM_AB_ReadDataValid	: IN std_logic;							-- Pin readdatavalid, 1 when AM_AB_ReadData holds the requested word
 			AM_AB_BurstCount	: OUT std_logic_vector (7 DOWNTO 0);	-- Number of datas in one burst
 			AM_AB_WaitRequest	: IN std_logic;							-- Pin waitrequest which is 0 when the bus is available
 		
 			AM_AS_Start			: IN std_logic;							-- Start command
 			AM_AS_StartAddress	: IN std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
 			AM_AS_Length		: IN std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+			AM_AS_Descriptor	: IN std_logic;							-- 1 when AM_AS_StartAddress points to a descriptor
 			AM_AS_Status		: OUT std_logic;						-- 1 when the image has been written to the memory
+			AM_AS_Crc			: OUT std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AM_AS_Status = 1
+			AM_AS_Trailer		: IN std_logic;							-- 1 when a trailer is written after each frame
+			AM_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image, copied in the trailer
+			
+			AM_CI_FrameCount	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+			AM_CI_DroppedLines	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 		
 			AM_FIFO_ReadCheck	: OUT std_logic;						-- 1 = information asked to the Fifo, 0 = no demand
 			AM_FIFO_ReadData	: IN std_logic_vector (31 DOWNTO 0);	-- 1 pixel stored in the FIFO by hte camera controller
-			AM_FIFO_UsedWords	: IN std_logic_vector (8 DOWNTO 0)		-- number of 32 bits words
+			AM_FIFO_UsedWords	: IN std_logic_vector (FIFO_DEPTH_LOG2-2 DOWNTO 0)	-- number of 32 bits words
 		);
 	END COMPONENT;
 	
 	COMPONENT Camera_Interface
+		GENERIC(
+			FIFO_DEPTH_LOG2		: natural
+		);
         PORT(
 			CI_nReset			: IN std_logic;							-- nReset input
 			CI_Clk				: IN std_logic;							-- clock input
@@ -91,26 +132,58 @@ ARCHITECTURE bhv OF Top_Camera_Controller IS
 			
 			CI_AS_Start			: IN std_logic;							-- Start information
 			CI_AS_Pending		: OUT std_logic;						-- Pending information
+			CI_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image (downscaling, pixel format)
+			CI_AS_ColorControl	: IN std_logic_vector (1 DOWNTO 0);		-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+			CI_AS_Matrix		: IN std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+			CI_AS_LutWrite		: IN std_logic;							-- 1 = write CI_AS_LutData in a gamma table
+			CI_AS_LutAddress	: IN std_logic_vector (9 DOWNTO 0);		-- Channel (9->8) and index (7->0) in the gamma tables
+			CI_AS_LutData		: IN std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
+			
+			CI_AM_FrameCount	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+			CI_AM_DroppedLines	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 			
 			CI_FIFO_WriteEnable	: OUT std_logic;						-- 1 = write asked to the FIFO, 0 = no demand
 			CI_FIFO_WriteData	: OUT std_logic_vector (15 DOWNTO 0);	-- 16 bits pixel stored in the FIFO by the camera controller
-			CI_FIFO_UsedWords	: IN std_logic_vector (9 DOWNTO 0)		-- 16 bits used words in the FIFO
+			CI_FIFO_UsedWords	: IN std_logic_vector (FIFO_DEPTH_LOG2-1 DOWNTO 0)	-- 16 bits used words in the FIFO
+		);
+	END COMPONENT;
+	
+	COMPONENT Motion_Detector
+		PORT(
+			MD_nReset			: IN std_logic;							-- nReset input
+			MD_Clk				: IN std_logic;							-- clock input
+			
+			MD_CA_PixClk		: IN std_logic;							-- pixel clock received from the camera
+			MD_CA_Data			: IN std_logic_vector (11 DOWNTO 0);	-- pixel sent by the camera
+			MD_CA_FrameValid	: IN std_logic;							-- 1 if the frame is valid
+			MD_CA_LineValid		: IN std_logic;							-- 1 if the line is valid
+			
+			MD_AS_Control		: IN std_logic_vector (1 DOWNTO 0);		-- 1 = enabled (bit 0), reference updated with each frame (bit 1)
+			MD_AS_PixelThreshold: IN std_logic_vector (7 DOWNTO 0);		-- Difference above which a cell has changed
+			MD_AS_BlockThreshold: IN std_logic_vector (4 DOWNTO 0);		-- Number of changed cells above which a block has changed
+			MD_AS_Done			: OUT std_logic;						-- 1 during one clock when the results of a frame are available
+			MD_AS_ChangedCells	: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+			MD_AS_ChangedBlocks	: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+			MD_AS_Bitmap		: OUT std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame, bit 20*row + column
 		);
 	END COMPONENT;
 	
 	COMPONENT FIFO
+		GENERIC(
+			FIFO_DEPTH_LOG2		: natural
+		);
 		PORT(
 			FIFO_Reset			: IN std_logic;
 		
 			FIFO_WriteClk		: IN STD_LOGIC ;
 			FIFO_CI_WriteData	: IN STD_LOGIC_VECTOR (15 DOWNTO 0);
 			FIFO_CI_WriteEnable	: IN STD_LOGIC ;
-			FIFO_CI_UsedWords	: OUT STD_LOGIC_VECTOR (9 DOWNTO 0);
+			FIFO_CI_UsedWords	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-1 DOWNTO 0);
 			
 			FIFO_ReadClk		: IN STD_LOGIC ;
 			FIFO_AM_ReadData	: OUT STD_LOGIC_VECTOR (31 DOWNTO 0);
 			FIFO_AM_ReadCheck	: IN STD_LOGIC ;
-			FIFO_AM_UsedWords	: OUT STD_LOGIC_VECTOR (8 DOWNTO 0)
+			FIFO_AM_UsedWords	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-2 DOWNTO 0)
 		);
 	END COMPONENT;
 
@@ -119,16 +192,35 @@ signal Sig_Start		: std_logic;
 
 signal Sig_StartAddress	: std_logic_vector (31 DOWNTO 0);
 signal Sig_Length		: std_logic_vector (31 DOWNTO 0);
+signal Sig_Descriptor	: std_logic;
 signal Sig_Status		: std_logic;
+signal Sig_Crc			: std_logic_vector (31 DOWNTO 0);
+signal Sig_Trailer		: std_logic;
+signal Sig_FrameCount	: std_logic_vector (31 DOWNTO 0);
+signal Sig_DroppedLines	: std_logic_vector (31 DOWNTO 0);
 
 signal Sig_ReadCheck	: std_logic;
 signal Sig_ReadData		: std_logic_vector	(31 DOWNTO 0);
-signal Sig_AM_UsedWords	: std_logic_vector (8 DOWNTO 0);
+signal Sig_AM_UsedWords	: std_logic_vector (FIFO_DEPTH_LOG2-2 DOWNTO 0);
 
 signal Sig_WriteEnable	: std_logic;
 signal Sig_WriteData	: std_logic_vector	(15 DOWNTO 0);
-signal Sig_CI_UsedWords	: std_logic_vector (9 DOWNTO 0);
+signal Sig_CI_UsedWords	: std_logic_vector (FIFO_DEPTH_LOG2-1 DOWNTO 0);
 signal Sig_Pending		: std_logic;
+signal Sig_Format		: std_logic_vector (7 DOWNTO 0);
+signal Sig_ColorControl	: std_logic_vector (1 DOWNTO 0);
+signal Sig_Matrix		: std_logic_vector (143 DOWNTO 0);
+signal Sig_LutWrite		: std_logic;
+signal Sig_LutAddress	: std_logic_vector (9 DOWNTO 0);
+signal Sig_LutData		: std_logic_vector (11 DOWNTO 0);
+
+signal Sig_MotionControl	: std_logic_vector (1 DOWNTO 0);
+signal Sig_PixelThreshold	: std_logic_vector (7 DOWNTO 0);
+signal Sig_BlockThreshold	: std_logic_vector (4 DOWNTO 0);
+signal Sig_MotionDone		: std_logic;
+signal Sig_ChangedCells		: std_logic_vector (15 DOWNTO 0);
+signal Sig_ChangedBlocks	: std_logic_vector (15 DOWNTO 0);
+signal Sig_MotionBitmap		: std_logic_vector (299 DOWNTO 0);
 
 BEGIN
 
@@ -142,17 +234,38 @@ BEGIN
 			AS_AB_WriteEnable	=> TL_AS_AB_WriteEnable,
 			AS_AB_ReadData		=> TL_AS_AB_ReadData,
 			AS_AB_WriteData		=> TL_AS_AB_WriteData,
+			AS_IRQ				=> TL_AS_IRQ,
 			
 			AS_ALL_Start 		=> Sig_Start,
 			
 			AS_AM_StartAddress	=> Sig_StartAddress,
 			AS_AM_Length 		=> Sig_Length,
+			AS_AM_Descriptor	=> Sig_Descriptor,
 			AS_AM_Status		=> Sig_Status,
+			AS_AM_Crc			=> Sig_Crc,
+			AS_AM_Trailer		=> Sig_Trailer,
 			
-			AS_CI_Pending		=> Sig_Pending
+			AS_CI_Pending		=> Sig_Pending,
+			AS_CI_Format		=> Sig_Format,
+			AS_CI_ColorControl	=> Sig_ColorControl,
+			AS_CI_Matrix		=> Sig_Matrix,
+			AS_CI_LutWrite		=> Sig_LutWrite,
+			AS_CI_LutAddress	=> Sig_LutAddress,
+			AS_CI_LutData		=> Sig_LutData,
+			
+			AS_MD_Control		=> Sig_MotionControl,
+			AS_MD_PixelThreshold=> Sig_PixelThreshold,
+			AS_MD_BlockThreshold=> Sig_BlockThreshold,
+			AS_MD_Done			=> Sig_MotionDone,
+			AS_MD_ChangedCells	=> Sig_ChangedCells,
+			AS_MD_ChangedBlocks	=> Sig_ChangedBlocks,
+			AS_MD_Bitmap		=> Sig_MotionBitmap
 		);
 		
 	low_Avalon_Master : Avalon_master
+		GENERIC MAP (
+			FIFO_DEPTH_LOG2		=> FIFO_DEPTH_LOG2
+		)
 		PORT MAP (
 			AM_nReset 			=> TL_nReset,
 			AM_Clk 				=> TL_MainClk,
@@ -160,13 +273,23 @@ BEGIN
 			AM_AB_MemoryAddress	=> TL_AM_AB_MemoryAddress,
 			AM_AB_MemoryData	=> TL_AM_AB_MemoryData,
 			AM_AB_WriteAccess	=> TL_AM_AB_WriteAccess,
+			AM_AB_ReadAccess	=> TL_AM_AB_ReadAccess,
+			AM_AB_ReadData		=> TL_AM_AB_ReadData,
+			AM_AB_ReadDataValid	=> TL_AM_AB_ReadDataValid,
 			AM_AB_BurstCount	=> TL_AM_AB_BurstCount,
 			AM_AB_WaitRequest	=> TL_AM_AB_WaitRequest,
 			
 			AM_AS_Start			=> Sig_Start,
 			AM_AS_StartAddress	=> Sig_StartAddress,
 			AM_AS_Length		=> Sig_Length,
+			AM_AS_Descriptor	=> Sig_Descriptor,
 			AM_AS_Status		=> Sig_Status,
+			AM_AS_Crc			=> Sig_Crc,
+			AM_AS_Trailer		=> Sig_Trailer,
+			AM_AS_Format		=> Sig_Format,
+			
+			AM_CI_FrameCount	=> Sig_FrameCount,
+			AM_CI_DroppedLines	=> Sig_DroppedLines,
 			
 			AM_FIFO_ReadCheck	=> Sig_ReadCheck,
 			AM_FIFO_ReadData 	=> Sig_ReadData,
@@ -174,6 +297,9 @@ BEGIN
 		);
 		
 	low_Camera_Interface : Camera_Interface
+		GENERIC MAP (
+			FIFO_DEPTH_LOG2		=> FIFO_DEPTH_LOG2
+		)
 		PORT MAP (
 			CI_nReset			=> TL_nReset,
 			CI_Clk				=> TL_MainClk,
@@ -185,12 +311,40 @@ BEGIN
 			
 			CI_AS_Start			=> Sig_Start,
 			CI_AS_Pending		=> Sig_Pending,
+			CI_AS_Format		=> Sig_Format,
+			CI_AS_ColorControl	=> Sig_ColorControl,
+			CI_AS_Matrix		=> Sig_Matrix,
+			CI_AS_LutWrite		=> Sig_LutWrite,
+			CI_AS_LutAddress	=> Sig_LutAddress,
+			CI_AS_LutData		=> Sig_LutData,
+			
+			CI_AM_FrameCount	=> Sig_FrameCount,
+			CI_AM_DroppedLines	=> Sig_DroppedLines,
 		
 			CI_FIFO_WriteEnable	=> Sig_WriteEnable,
 			CI_FIFO_WriteData	=> Sig_WriteData,
 			CI_FIFO_UsedWords	=> Sig_CI_UsedWords
 		);
 
+	low_Motion_Detector : Motion_Detector
+		PORT MAP (
+			MD_nReset			=> TL_nReset,
+			MD_Clk				=> TL_MainClk,
+			
+			MD_CA_PixClk		=> TL_PixClk,
+			MD_CA_Data			=> TL_CI_CA_Data,
+			MD_CA_FrameValid	=> TL_CI_CA_FrameValid,
+			MD_CA_LineValid		=> TL_CI_CA_LineValid,
+			
+			MD_AS_Control		=> Sig_MotionControl,
+			MD_AS_PixelThreshold=> Sig_PixelThreshold,
+			MD_AS_BlockThreshold=> Sig_BlockThreshold,
+			MD_AS_Done			=> Sig_MotionDone,
+			MD_AS_ChangedCells	=> Sig_ChangedCells,
+			MD_AS_ChangedBlocks	=> Sig_ChangedBlocks,
+			MD_AS_Bitmap		=> Sig_MotionBitmap
+		);
+
 ResetFIFO:
 Process(TL_nReset, Sig_Start)
 Begin
@@ -198,6 +352,9 @@ Begin
 end process ResetFIFO;
 	
 	low_FIFO : FIFO
+		GENERIC MAP (
+			FIFO_DEPTH_LOG2		=> FIFO_DEPTH_LOG2
+		)
 		PORT MAP (
 			FIFO_Reset			=> Sig_Reset,
 		
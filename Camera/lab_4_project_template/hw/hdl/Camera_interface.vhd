@@ -10,12 +10,66 @@
 --   0: status register
 --   1: current RGB pixel register (7->0)
 --   2: current RGB pixel register (12->8)
+--
+-- The 640*480 Bayer window is binned into a 320*240 image. This image can
+-- then be averaged by blocks of 2*2 (160*120) or 4*4 (80*60) pixels, selected
+-- by CI_AS_Format (1 DOWNTO 0):
+--   00: 320*240
+--   01: 160*120
+--   10: 80*60
+--
+-- When CI_AS_Format (4) = 1, the binning and the downscaling are replaced by a
+-- bilinear demosaic of the 640*480 window, which gives a 640*480 image. It
+-- uses the two previous rows of samples and outputs the pixel of the previous
+-- row and previous column, one pixel per CI_CA_PixClk. The missing neighbours
+-- on the borders are mirrored: the last pixel of a row is computed during the
+-- horizontal blanking and the last row during the vertical blanking, which
+-- must last at least 641 pixel clocks (much less than one row of the camera).
+--
+-- The RGB pixels then go through a colour correction stage, 1 pixel per
+-- CI_CA_PixClk with a latency of 3 clocks:
+--   a 3*3 matrix (CI_AS_Matrix, 16 bits signed coefficients with 8 fractional
+--   bits, row major RR RG RB GR GG GB BR BG BB) enabled by CI_AS_ColorControl (0)
+--   a 256 entries gamma table per channel, indexed by the 8 most significant
+--   bits and giving 12 bits, enabled by CI_AS_ColorControl (1). The tables are
+--   written on CI_Clk through CI_AS_LutWrite (address = channel & index).
+--
+-- CI_AS_Format, CI_AS_Matrix and CI_AS_ColorControl are taken while no frame
+-- is captured. They are held from the frame boundary where the capture begins
+-- (iRegNewFrame set) until the acquisition stops or waits for the FIFO, so a
+-- write while the acquisition runs never changes the current frame.
+--
+-- The pixels are written in the FIFO in the format selected by
+-- CI_AS_Format (3 DOWNTO 2):
+--   00: RGB 5*6*5, 1 pixel per 16 bits word
+--   01: luminance Y = (77*R + 150*G + 29*B) / 256 on 8 bits, 2 pixels per
+--       16 bits word, the first pixel in the low byte
+--   10: raw Bayer samples of the 640*480 window on 12 bits, 1 sample per 16
+--       bits word (bits 15->12 = 0), the binning and the downscaling are bypassed
+--   11: raw Bayer samples on 8 bits (11->4), 2 samples per 16 bits word, the
+--       first sample in the low byte
+--
+-- The 12 bits channels are reduced to 5*6*5 bits as selected by
+-- CI_AS_Format (6 DOWNTO 5):
+--   00: truncation
+--   01: rounding to the nearest value, saturated
+--   10: ordered dither, an offset taken from a 4*4 Bayer matrix indexed by the
+--       output column and row (modulo 4) is added before the truncation, so
+--       that the average of a flat area keeps the precision of 12 bits
+--
+-- CI_AM_FrameCount counts the frames of the camera and CI_AM_DroppedLines the
+-- lines of the camera which are not captured (acquisition stopped, FIFO almost
+-- full or waiting for the next frame), both since the reset. The Avalon master
+-- copies them in the trailer of the buffers.
 
 LIBRARY ieee;
 USE ieee.std_logic_1164.all;
 USE ieee.numeric_std.all;
 
 ENTITY Camera_Interface IS
+	GENERIC(
+		FIFO_DEPTH_LOG2		: natural := 10							-- log2 of the FIFO depth in 16 bits words
+	);
 	PORT(
 		CI_nReset			: IN std_logic;							-- nReset input
 		CI_Clk				: IN std_logic;							-- clock input
@@ -27,15 +81,33 @@ ENTITY Camera_Interface IS
 		
 		CI_AS_Start			: IN std_logic;							-- Start information
 		CI_AS_Pending		: OUT std_logic;						-- Pending information
+		CI_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image (downscaling, pixel format)
+		CI_AS_ColorControl	: IN std_logic_vector (1 DOWNTO 0);		-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+		CI_AS_Matrix		: IN std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+		CI_AS_LutWrite		: IN std_logic;							-- 1 = write CI_AS_LutData in a gamma table
+		CI_AS_LutAddress	: IN std_logic_vector (9 DOWNTO 0);		-- Channel (9->8, 0 = R, 1 = G, 2 = B) and index (7->0) in the gamma tables
+		CI_AS_LutData		: IN std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
+		
+		CI_AM_FrameCount	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+		CI_AM_DroppedLines	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 		
 		CI_FIFO_WriteEnable	: OUT std_logic;						-- 1 = write asked to the FIFO, 0 = no demand
 		CI_FIFO_WriteData	: OUT std_logic_vector (15 DOWNTO 0);	-- 16 bits pixel stored in the FIFO by the camera controller
-		CI_FIFO_UsedWords	: IN std_logic_vector (9 DOWNTO 0)		-- 16 bits used words in the FIFO
+		CI_FIFO_UsedWords	: IN std_logic_vector (FIFO_DEPTH_LOG2-1 DOWNTO 0)	-- 16 bits used words in the FIFO
 	);
 END Camera_Interface;
 
 ARCHITECTURE bhv OF Camera_Interface IS
+	constant	PENDING_MARGIN		: natural := 16;					-- free 16 bits words kept in the FIFO before raising the pending flag
+	constant	PENDING_THRESHOLD	: unsigned (FIFO_DEPTH_LOG2-1 DOWNTO 0) := to_unsigned(2**FIFO_DEPTH_LOG2 - PENDING_MARGIN, FIFO_DEPTH_LOG2);
+	
+	constant	SCALED_WIDTH		: natural := 160;					-- maximum width of a downscaled image
+	
 	signal	iRegStart			: std_logic;						-- internal register for the start information
+	signal	iRegScale			: std_logic_vector (1 DOWNTO 0);	-- internal register for the downscaling mode
+	signal	iRegPixelFormat		: std_logic_vector (1 DOWNTO 0);	-- internal register for the format of the pixels in the FIFO
+	signal	iRegDemosaic		: std_logic;						-- internal register for the bilinear demosaic mode
+	signal	iRegReduction		: std_logic_vector (1 DOWNTO 0);	-- internal register for the reduction to 5*6*5 bits
 	signal	iRegPending			: std_logic;						-- internal register for the pending information
 	signal	iRegNewFrame		: std_logic;						-- internal register to know if a new frame is avalaible
 	signal	iRegRow				: std_logic;						-- internal register to know on which row we are
@@ -48,6 +120,114 @@ ARCHITECTURE bhv OF Camera_Interface IS
 	
 	signal	iRegBlue			: std_logic_vector (11 DOWNTO 0); 	-- internal register fot the binning of the actual pixel blue color
 	signal	iRegRGB				: std_logic_vector (15 DOWNTO 0); 	-- internal register for the actual computed pixel with 5*6*5 RGB format
+	signal	iRegSecondPixel		: std_logic;						-- 1 when the next luminance pixel goes in the high byte
+	
+	signal	iRegPixValid		: std_logic;						-- 1 during one pixel clock when a binned pixel is computed
+	signal	iRegPixColumn		: unsigned (8 DOWNTO 0);			-- column of the binned pixel, from 0 to 319
+	signal	iRegPixRed			: unsigned (11 DOWNTO 0);			-- red channel of the binned pixel
+	signal	iRegPixGreen		: unsigned (11 DOWNTO 0);			-- averaged green channel of the binned pixel
+	signal	iRegPixBlue			: unsigned (11 DOWNTO 0);			-- blue channel of the binned pixel
+	
+	TYPE SumLine is array (SCALED_WIDTH-1 DOWNTO 0) of unsigned (15 DOWNTO 0);
+	signal	iRegSumRed			: SumLine;							-- red sums of the downscaled pixels of the current block row
+	signal	iRegSumGreen		: SumLine;							-- green sums of the downscaled pixels of the current block row
+	signal	iRegSumBlue			: SumLine;							-- blue sums of the downscaled pixels of the current block row
+	signal	iRegRowSumRed		: unsigned (15 DOWNTO 0);			-- red sum of the current block on the current row
+	signal	iRegRowSumGreen		: unsigned (15 DOWNTO 0);			-- green sum of the current block on the current row
+	signal	iRegRowSumBlue		: unsigned (15 DOWNTO 0);			-- blue sum of the current block on the current row
+	signal	iRegScaleRow		: unsigned (1 DOWNTO 0);			-- binned row modulo 4
+	
+	signal	iRegRawValid		: std_logic;						-- 1 during one pixel clock when a raw sample is read
+	signal	iRegRawData			: std_logic_vector (11 DOWNTO 0);	-- raw sample read from the camera
+	
+	signal	iRegDemLine1		: Memory;							-- samples of the previous row for the demosaic
+	signal	iRegDemLine2		: Memory;							-- samples of the row before the previous one for the demosaic
+	signal	iRegDemColumn		: unsigned (9 DOWNTO 0);			-- column of the next sample, from 0 to 639
+	signal	iRegDemRow			: unsigned (9 DOWNTO 0);			-- row of the next sample, from 0 to 479
+	signal	iRegDemFlushColumn	: std_logic;						-- 1 when the last pixel of the row must be computed
+	signal	iRegDemFlushRow		: std_logic;						-- 1 when the last row of the frame must be computed
+	
+	TYPE WindowColumn is array (0 TO 2) of unsigned (11 DOWNTO 0);	-- 0 = upper row, 1 = center row, 2 = lower row
+	signal	iRegWinLeft			: WindowColumn;						-- left column of the 3*3 window
+	signal	iRegWinCenter		: WindowColumn;						-- center column of the 3*3 window
+	signal	iRegWinRight		: WindowColumn;						-- right column of the 3*3 window
+	signal	iRegWinValid		: std_logic;						-- 1 when the window is centered on a pixel of the image
+	signal	iRegWinRowOdd		: std_logic;						-- parity of the row of the center pixel
+	signal	iRegWinColumnOdd	: std_logic;						-- parity of the column of the center pixel
+	signal	iRegWinFirstColumn	: std_logic;						-- 1 when the center pixel is on the first column
+	
+	signal	iRegDemValid		: std_logic;						-- 1 during one pixel clock when a demosaiced pixel is computed
+	signal	iRegDemRed			: unsigned (11 DOWNTO 0);			-- red channel of the demosaiced pixel
+	signal	iRegDemGreen		: unsigned (11 DOWNTO 0);			-- green channel of the demosaiced pixel
+	signal	iRegDemBlue			: unsigned (11 DOWNTO 0);			-- blue channel of the demosaiced pixel
+	
+	signal	iRegOutValid		: std_logic;						-- 1 during one pixel clock when a downscaled pixel is computed
+	signal	iRegOutRed			: unsigned (11 DOWNTO 0);			-- red channel of the downscaled pixel
+	signal	iRegOutGreen		: unsigned (11 DOWNTO 0);			-- green channel of the downscaled pixel
+	signal	iRegOutBlue			: unsigned (11 DOWNTO 0);			-- blue channel of the downscaled pixel
+	
+	signal	Sig_ColorValid		: std_logic;						-- pixel to pack, from the downscaling or from the demosaic
+	signal	Sig_ColorRed		: unsigned (11 DOWNTO 0);
+	signal	Sig_ColorGreen		: unsigned (11 DOWNTO 0);
+	signal	Sig_ColorBlue		: unsigned (11 DOWNTO 0);
+	
+	signal	iRegColorControl	: std_logic_vector (1 DOWNTO 0);	-- internal register for the colour correction enables
+	signal	iRegMatrix			: std_logic_vector (143 DOWNTO 0);	-- internal register for the colour correction matrix
+	
+	TYPE Products is array (0 TO 8) of signed (28 DOWNTO 0);
+	signal	iRegCcProducts		: Products;							-- coefficients multiplied by the channels, row major
+	signal	iRegCcInput			: WindowColumn;						-- input pixel (R, G, B) kept for the bypass
+	signal	iRegCcValid1		: std_logic;						-- 1 when iRegCcProducts holds a pixel
+	signal	iRegCcValid2		: std_logic;						-- 1 when iRegCcRed/Green/Blue hold a pixel
+	signal	iRegCcRed			: unsigned (11 DOWNTO 0);			-- red channel after the matrix
+	signal	iRegCcGreen			: unsigned (11 DOWNTO 0);			-- green channel after the matrix
+	signal	iRegCcBlue			: unsigned (11 DOWNTO 0);			-- blue channel after the matrix
+	
+	TYPE GammaTable is array (0 TO 255) of std_logic_vector (11 DOWNTO 0);
+	signal	iRegGammaTableRed	: GammaTable;						-- gamma table of the red channel
+	signal	iRegGammaTableGreen	: GammaTable;						-- gamma table of the green channel
+	signal	iRegGammaTableBlue	: GammaTable;						-- gamma table of the blue channel
+	signal	iRegGammaRed		: std_logic_vector (11 DOWNTO 0);	-- red channel read in the gamma table
+	signal	iRegGammaGreen		: std_logic_vector (11 DOWNTO 0);	-- green channel read in the gamma table
+	signal	iRegGammaBlue		: std_logic_vector (11 DOWNTO 0);	-- blue channel read in the gamma table
+	signal	iRegGammaBypass		: WindowColumn;						-- pixel after the matrix, delayed like the table outputs
+	signal	iRegGammaValid		: std_logic;						-- 1 during one pixel clock when a corrected pixel is ready
+	
+	signal	Sig_CorrectedRed	: unsigned (11 DOWNTO 0);			-- corrected pixel to pack
+	signal	Sig_CorrectedGreen	: unsigned (11 DOWNTO 0);
+	signal	Sig_CorrectedBlue	: unsigned (11 DOWNTO 0);
+	
+	signal	iRegFrameValidSync	: std_logic_vector (1 DOWNTO 0);	-- CI_CA_FrameValid sampled on CI_Clk, bit 1 = previous value
+	signal	iRegLineValidSync	: std_logic_vector (1 DOWNTO 0);	-- CI_CA_LineValid sampled on CI_Clk, bit 1 = previous value
+	signal	iRegFrameCount		: unsigned (31 DOWNTO 0);			-- internal register for the number of camera frames
+	signal	iRegDroppedLines	: unsigned (31 DOWNTO 0);			-- internal register for the number of lines not captured
+	
+	signal	iRegPackColumn		: unsigned (9 DOWNTO 0);			-- column of the next packed pixel
+	signal	iRegPackRow			: unsigned (1 DOWNTO 0);			-- row of the next packed pixel modulo 4
+	
+	TYPE DitherMatrix is array (0 TO 15) of natural range 0 TO 15;
+	constant	BAYER_MATRIX		: DitherMatrix := (0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5);	-- row major
+	
+	-- Reduce a 12 bits channel to its bits most significant bits
+	-- threshold is the entry of the Bayer matrix for the ordered dither
+	function reduce(value : unsigned (11 DOWNTO 0); bits : natural; mode : std_logic_vector (1 DOWNTO 0); threshold : natural) return std_logic_vector is
+		variable offset : natural;
+		variable sum : unsigned (12 DOWNTO 0);
+	begin
+		case mode is
+			when "00" =>	-- truncation
+				offset := 0;
+			when "01" =>	-- half of the least significant bit kept
+				offset := 2**(11-bits);
+			when others =>	-- (threshold + 1/2) / 16 of the least significant bit kept
+				offset := (2*threshold + 1) * 2**(7-bits);
+		end case;
+		sum := resize(value, 13) + offset;
+		if sum (12) = '1' then	-- saturation
+			sum := (others => '1');
+		end if;
+		return std_logic_vector(sum (11 DOWNTO 12-bits));
+	end function reduce;
 
 BEGIN
 
@@ -57,10 +237,24 @@ Process(CI_nReset, CI_Clk)
 Begin
 	if CI_nReset = '0' then
 		iRegStart <= '0';
+		iRegScale <= "00";
+		iRegPixelFormat <= "00";
+		iRegDemosaic <= '0';
+		iRegReduction <= "00";
+		iRegColorControl <= "00";
+		iRegMatrix <= (others => '0');
 		iRegPending <= '0';
 	elsif rising_edge(CI_Clk) then
 		iRegStart <= CI_AS_Start;
-		if CI_FIFO_UsedWords > "1111110000" then
+		if iRegNewFrame = '0' then	-- the settings are held from the frame boundary where the capture begins
+			iRegScale <= CI_AS_Format (1 DOWNTO 0);
+			iRegPixelFormat <= CI_AS_Format (3 DOWNTO 2);
+			iRegDemosaic <= CI_AS_Format (4);
+			iRegReduction <= CI_AS_Format (6 DOWNTO 5);
+			iRegColorControl <= CI_AS_ColorControl;
+			iRegMatrix <= CI_AS_Matrix;
+		end if;
+		if unsigned(CI_FIFO_UsedWords) > PENDING_THRESHOLD then
 			iRegPending <= '1';
 		else
 			iRegPending <= '0';
@@ -83,6 +277,30 @@ Begin
 	end if;
 end process NewFrame;
 
+-- Process to count the frames of the camera and the lines which are not captured
+FrameStatistics:
+Process(CI_nReset, CI_Clk)
+Begin
+	if CI_nReset = '0' then
+		iRegFrameValidSync <= "00";
+		iRegLineValidSync <= "00";
+		iRegFrameCount <= (others => '0');
+		iRegDroppedLines <= (others => '0');
+	elsif rising_edge(CI_Clk) then
+		iRegFrameValidSync <= iRegFrameValidSync (0) & CI_CA_FrameValid;
+		iRegLineValidSync <= iRegLineValidSync (0) & CI_CA_LineValid;
+		if iRegFrameValidSync = "01" then	-- beginning of a frame
+			iRegFrameCount <= iRegFrameCount + 1;
+		end if;
+		if iRegLineValidSync = "01" AND (iRegStart = '0' OR iRegPending = '1' OR iRegNewFrame = '0') then	-- beginning of a line which is not captured
+			iRegDroppedLines <= iRegDroppedLines + 1;
+		end if;
+	end if;
+end process FrameStatistics;
+
+CI_AM_FrameCount <= std_logic_vector(iRegFrameCount);
+CI_AM_DroppedLines <= std_logic_vector(iRegDroppedLines);
+
 -- Process to know the column number and the row parity
 CountColumns:
 Process(CI_nReset, CI_CA_PixClk)
@@ -137,22 +355,24 @@ variable sumG_std_12 : std_logic_vector (11 DOWNTO 0);
 
 Begin
 	if CI_nReset = '0' then
-		iRegRGB <= (others => '0');
+		iRegPixRed <= (others => '0');
+		iRegPixGreen <= (others => '0');
+		iRegPixBlue <= (others => '0');
+		iRegPixColumn <= (others => '0');
 		iRegMemory <= (others => "000000000000");
 		iRegBlue <= (others => '0');
-		iRegFIFOWrite <= '0';
+		iRegPixValid <= '0';
 	elsif falling_edge(CI_CA_PixClk) then	-- read the pixel on the falling edge of the CI_CA_PixClk
-		iRegFIFOWrite <= '0';
+		iRegPixValid <= '0';
 		if CI_CA_FrameValid = '1' AND CI_CA_LineValid = '1' AND iRegStart = '1' AND iRegPending = '0' AND iRegNewFrame = '1' then
 			if iRegRow = '0' then	-- if we are on an even row
-				iRegRGB <= (others => '0');
 				iRegBlue <= (others => '0');
 				iRegMemory(to_integer(unsigned(iRegColumnCounter))) <= CI_CA_Data;	-- put the pixel in the internal memory
 			else	-- if we are on an odd row
 				if iRegColumn = '0' then	-- if we are on an even column (blue pixel)
 					iRegBlue <= CI_CA_Data;	-- but we have to store this blue pixel
 				else	-- if we are on an odd column (green G2 pixel)
-					iRegRGB (15 DOWNTO 11) <= iRegMemory(to_integer(unsigned(iRegColumnCounter))) (11 DOWNTO 7); -- put the red pixel stored in the memory in iRegRGB
+					iRegPixRed <= unsigned(iRegMemory(to_integer(unsigned(iRegColumnCounter)))); -- red pixel stored in the memory
 					
 					iRegColumnCounter_unsign := unsigned(iRegColumnCounter); -- iRegColumnCounter from std_logic_vector to unsigned
 					iRegMemoryG1_unsign_12 := unsigned(iRegMemory(to_integer(iRegColumnCounter_unsign - 1))); -- pixel G1 stored in the memory
@@ -168,25 +388,457 @@ Begin
 						sumG_std_12 := std_logic_vector(sumG_unsign_12);
 					end if;
 					
-					iRegRGB (10 DOWNTO 5) <= sumG_std_12 (11 DOWNTO 6); -- compute the averaged green with the current cam data and the green G1 pixel stored in the memory and put it in iRegRGB
+					iRegPixGreen <= unsigned(sumG_std_12); -- averaged green with the current cam data and the green G1 pixel stored in the memory
 					
-					iRegRGB (4 DOWNTO 0) <= iRegBlue (11 DOWNTO 7);	-- put the blue pixel stored in iRegBlue in iRegRGB
+					iRegPixBlue <= unsigned(iRegBlue);	-- blue pixel stored in iRegBlue
 					
-					iRegFIFOWrite <= '1';
+					iRegPixColumn <= unsigned(iRegColumnCounter (9 DOWNTO 1));
+					iRegPixValid <= '1';
 					if iRegColumnCounter = X"27F" then	-- if iRegColumnCounter = 639, reset it
 						iRegMemory <= (others => "000000000000");
 					end if;
 				end if;
 			end if;
 		elsif iRegStart = '0' OR iRegPending = '1' then
-			iRegRGB <= (others => '0');
 			iRegMemory <= (others => "000000000000");
 			iRegBlue <= (others => '0');
-			iRegFIFOWrite <= '0';
+			iRegPixValid <= '0';
 		end if;
 	end if;
 end process MainProcess;
 
+-- Process to read the raw samples without any binning
+RawCapture:
+Process(CI_nReset, CI_CA_PixClk)
+Begin
+	if CI_nReset = '0' then
+		iRegRawData <= (others => '0');
+		iRegRawValid <= '0';
+	elsif falling_edge(CI_CA_PixClk) then	-- read the pixel on the falling edge of the CI_CA_PixClk
+		iRegRawValid <= '0';
+		if CI_CA_FrameValid = '1' AND CI_CA_LineValid = '1' AND iRegStart = '1' AND iRegPending = '0' AND iRegNewFrame = '1' then
+			iRegRawData <= CI_CA_Data;
+			iRegRawValid <= '1';
+		end if;
+	end if;
+end process RawCapture;
+
+-- Process to average the binned pixels by blocks of 1*1, 2*2 or 4*4
+-- The sums of the blocks of the current block row are kept in iRegSum*
+Downscale:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable subColumn : unsigned (1 DOWNTO 0);	-- column inside the block
+variable lastSub : unsigned (1 DOWNTO 0);	-- last column or row inside the block
+variable outColumn : natural range 0 TO SCALED_WIDTH-1;	-- column of the downscaled pixel
+variable sumRed, sumGreen, sumBlue : unsigned (15 DOWNTO 0);
+
+Begin
+	if CI_nReset = '0' then
+		iRegSumRed <= (others => (others => '0'));
+		iRegSumGreen <= (others => (others => '0'));
+		iRegSumBlue <= (others => (others => '0'));
+		iRegRowSumRed <= (others => '0');
+		iRegRowSumGreen <= (others => '0');
+		iRegRowSumBlue <= (others => '0');
+		iRegScaleRow <= "00";
+		iRegOutRed <= (others => '0');
+		iRegOutGreen <= (others => '0');
+		iRegOutBlue <= (others => '0');
+		iRegOutValid <= '0';
+	elsif rising_edge(CI_CA_PixClk) then	-- the binned pixel is ready half a clock after the falling edge
+		iRegOutValid <= '0';
+		
+		case iRegScale is
+			when "01" =>
+				lastSub := "01";
+				subColumn := "0" & iRegPixColumn (0);
+				outColumn := to_integer(iRegPixColumn (8 DOWNTO 1));
+			when "10" =>
+				lastSub := "11";
+				subColumn := iRegPixColumn (1 DOWNTO 0);
+				outColumn := to_integer(iRegPixColumn (8 DOWNTO 2));
+			when others =>
+				lastSub := "00";
+				subColumn := "00";
+				outColumn := 0;
+		end case;
+		
+		if iRegStart = '0' OR iRegPending = '1' then
+			iRegScaleRow <= "00";
+		elsif iRegPixValid = '1' then
+			-- sum of the block on the current row
+			if subColumn = "00" then
+				sumRed := resize(iRegPixRed, 16);
+				sumGreen := resize(iRegPixGreen, 16);
+				sumBlue := resize(iRegPixBlue, 16);
+			else
+				sumRed := iRegRowSumRed + iRegPixRed;
+				sumGreen := iRegRowSumGreen + iRegPixGreen;
+				sumBlue := iRegRowSumBlue + iRegPixBlue;
+			end if;
+			iRegRowSumRed <= sumRed;
+			iRegRowSumGreen <= sumGreen;
+			iRegRowSumBlue <= sumBlue;
+			
+			if subColumn = lastSub then	-- last column of the block
+				if (iRegScaleRow AND lastSub) /= "00" then	-- add the rows above in the block
+					sumRed := sumRed + iRegSumRed(outColumn);
+					sumGreen := sumGreen + iRegSumGreen(outColumn);
+					sumBlue := sumBlue + iRegSumBlue(outColumn);
+				end if;
+				iRegSumRed(outColumn) <= sumRed;
+				iRegSumGreen(outColumn) <= sumGreen;
+				iRegSumBlue(outColumn) <= sumBlue;
+				
+				if (iRegScaleRow AND lastSub) = lastSub then	-- last row of the block, output the average
+					case iRegScale is
+						when "01" =>
+							iRegOutRed <= sumRed (13 DOWNTO 2);
+							iRegOutGreen <= sumGreen (13 DOWNTO 2);
+							iRegOutBlue <= sumBlue (13 DOWNTO 2);
+						when "10" =>
+							iRegOutRed <= sumRed (15 DOWNTO 4);
+							iRegOutGreen <= sumGreen (15 DOWNTO 4);
+							iRegOutBlue <= sumBlue (15 DOWNTO 4);
+						when others =>
+							iRegOutRed <= sumRed (11 DOWNTO 0);
+							iRegOutGreen <= sumGreen (11 DOWNTO 0);
+							iRegOutBlue <= sumBlue (11 DOWNTO 0);
+					end case;
+					iRegOutValid <= '1';
+				end if;
+			end if;
+			
+			if iRegPixColumn = 319 then	-- end of a binned row
+				iRegScaleRow <= iRegScaleRow + 1;
+			end if;
+		end if;
+	end if;
+end process Downscale;
+
+-- Process to shift the samples in the 3*3 window of the demosaic
+-- The window is centered on the previous row and the previous column
+DemosaicWindow:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable newColumn : WindowColumn;	-- column entering the window
+variable column : natural range 0 TO 639;
+variable shift : boolean;
+
+Begin
+	if CI_nReset = '0' then
+		iRegDemLine1 <= (others => "000000000000");
+		iRegDemLine2 <= (others => "000000000000");
+		iRegDemColumn <= (others => '0');
+		iRegDemRow <= (others => '0');
+		iRegDemFlushColumn <= '0';
+		iRegDemFlushRow <= '0';
+		iRegWinLeft <= (others => (others => '0'));
+		iRegWinCenter <= (others => (others => '0'));
+		iRegWinRight <= (others => (others => '0'));
+		iRegWinValid <= '0';
+		iRegWinRowOdd <= '0';
+		iRegWinColumnOdd <= '0';
+		iRegWinFirstColumn <= '0';
+	elsif rising_edge(CI_CA_PixClk) then	-- the raw sample is ready half a clock after the falling edge
+		iRegWinValid <= '0';
+		shift := false;
+		newColumn := iRegWinCenter;
+		column := to_integer(iRegDemColumn);
+		
+		if iRegStart = '0' OR iRegPending = '1' OR iRegDemosaic = '0' then
+			iRegDemColumn <= (others => '0');
+			iRegDemRow <= (others => '0');
+			iRegDemFlushColumn <= '0';
+			iRegDemFlushRow <= '0';
+		elsif iRegDemFlushColumn = '1' then	-- last pixel of the row, column 638 is mirrored
+			newColumn := iRegWinCenter;
+			shift := true;
+			iRegDemFlushColumn <= '0';
+			iRegDemColumn <= (others => '0');
+			if iRegDemFlushRow = '1' then	-- end of the frame
+				iRegDemFlushRow <= '0';
+				iRegDemRow <= (others => '0');
+			elsif iRegDemRow = 479 then	-- the last row is computed during the vertical blanking
+				iRegDemFlushRow <= '1';
+			else
+				iRegDemRow <= iRegDemRow + 1;
+			end if;
+		elsif iRegDemFlushRow = '1' then	-- last row of the frame, row 478 is mirrored
+			newColumn := (unsigned(iRegDemLine2(column)), unsigned(iRegDemLine1(column)), unsigned(iRegDemLine2(column)));
+			shift := true;
+		elsif iRegRawValid = '1' then
+			newColumn (2) := unsigned(iRegRawData);
+			newColumn (1) := unsigned(iRegDemLine1(column));
+			if iRegDemRow = 1 then	-- first row of the image, row 1 is mirrored
+				newColumn (0) := unsigned(iRegRawData);
+			else
+				newColumn (0) := unsigned(iRegDemLine2(column));
+			end if;
+			iRegDemLine2(column) <= iRegDemLine1(column);
+			iRegDemLine1(column) <= iRegRawData;
+			shift := true;
+		end if;
+		
+		if shift then
+			iRegWinLeft <= iRegWinCenter;
+			iRegWinCenter <= iRegWinRight;
+			iRegWinRight <= newColumn;
+			
+			if iRegDemFlushColumn = '1' then	-- center on the last column
+				iRegWinColumnOdd <= '1';
+				iRegWinFirstColumn <= '0';
+				if iRegDemRow /= 0 OR iRegDemFlushRow = '1' then
+					iRegWinValid <= '1';
+				end if;
+			else	-- center on the previous column
+				iRegWinColumnOdd <= not iRegDemColumn (0);
+				if iRegDemColumn = 1 then
+					iRegWinFirstColumn <= '1';
+				else
+					iRegWinFirstColumn <= '0';
+				end if;
+				if iRegDemColumn /= 0 AND (iRegDemRow /= 0 OR iRegDemFlushRow = '1') then
+					iRegWinValid <= '1';
+				end if;
+				if iRegDemColumn = 639 then
+					iRegDemFlushColumn <= '1';
+				else
+					iRegDemColumn <= iRegDemColumn + 1;
+				end if;
+			end if;
+			
+			if iRegDemFlushRow = '1' then	-- center on the last row
+				iRegWinRowOdd <= '1';
+			else	-- center on the previous row
+				iRegWinRowOdd <= not iRegDemRow (0);
+			end if;
+		end if;
+	end if;
+end process DemosaicWindow;
+
+-- Process to interpolate the missing colors of the center pixel of the window
+-- Even rows are G1 R G1 R ..., odd rows are B G2 B G2 ...
+Demosaic:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable left : WindowColumn;	-- left column, mirrored on the first column
+variable horizontal, vertical : unsigned (12 DOWNTO 0);	-- sums of the 2 horizontal / vertical neighbours
+variable cross, diagonal : unsigned (13 DOWNTO 0);	-- sums of the 4 cross / diagonal neighbours
+
+Begin
+	if CI_nReset = '0' then
+		iRegDemRed <= (others => '0');
+		iRegDemGreen <= (others => '0');
+		iRegDemBlue <= (others => '0');
+		iRegDemValid <= '0';
+	elsif rising_edge(CI_CA_PixClk) then
+		if iRegWinFirstColumn = '1' then
+			left := iRegWinRight;
+		else
+			left := iRegWinLeft;
+		end if;
+		
+		horizontal := resize(left (1), 13) + iRegWinRight (1);
+		vertical := resize(iRegWinCenter (0), 13) + iRegWinCenter (2);
+		cross := resize(horizontal, 14) + vertical;
+		diagonal := resize(left (0), 14) + left (2) + iRegWinRight (0) + iRegWinRight (2);
+		
+		if iRegWinRowOdd = '0' AND iRegWinColumnOdd = '0' then	-- G1
+			iRegDemRed <= horizontal (12 DOWNTO 1);
+			iRegDemGreen <= iRegWinCenter (1);
+			iRegDemBlue <= vertical (12 DOWNTO 1);
+		elsif iRegWinRowOdd = '0' then	-- R
+			iRegDemRed <= iRegWinCenter (1);
+			iRegDemGreen <= cross (13 DOWNTO 2);
+			iRegDemBlue <= diagonal (13 DOWNTO 2);
+		elsif iRegWinColumnOdd = '0' then	-- B
+			iRegDemRed <= diagonal (13 DOWNTO 2);
+			iRegDemGreen <= cross (13 DOWNTO 2);
+			iRegDemBlue <= iRegWinCenter (1);
+		else	-- G2
+			iRegDemRed <= vertical (12 DOWNTO 1);
+			iRegDemGreen <= iRegWinCenter (1);
+			iRegDemBlue <= horizontal (12 DOWNTO 1);
+		end if;
+		
+		iRegDemValid <= iRegWinValid;
+	end if;
+end process Demosaic;
+
+-- Pixel to pack, from the binning path or from the demosaic
+Sig_ColorValid <= iRegDemValid when iRegDemosaic = '1' else iRegOutValid;
+Sig_ColorRed <= iRegDemRed when iRegDemosaic = '1' else iRegOutRed;
+Sig_ColorGreen <= iRegDemGreen when iRegDemosaic = '1' else iRegOutGreen;
+Sig_ColorBlue <= iRegDemBlue when iRegDemosaic = '1' else iRegOutBlue;
+
+-- Process to multiply the pixel by the coefficients of the colour correction matrix
+ColorMatrix:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable channels : WindowColumn;
+
+Begin
+	if CI_nReset = '0' then
+		iRegCcProducts <= (others => (others => '0'));
+		iRegCcInput <= (others => (others => '0'));
+		iRegCcValid1 <= '0';
+	elsif rising_edge(CI_CA_PixClk) then
+		channels := (Sig_ColorRed, Sig_ColorGreen, Sig_ColorBlue);
+		for row in 0 TO 2 loop
+			for column in 0 TO 2 loop
+				iRegCcProducts(3*row + column) <= signed('0' & channels(column)) * signed(iRegMatrix (16*(3*row + column) + 15 DOWNTO 16*(3*row + column)));
+			end loop;
+		end loop;
+		iRegCcInput <= channels;
+		iRegCcValid1 <= Sig_ColorValid;
+	end if;
+end process ColorMatrix;
+
+-- Process to add the products and to saturate the result on 12 bits
+ColorSum:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable sum : signed (30 DOWNTO 0);
+variable result : WindowColumn;
+
+Begin
+	if CI_nReset = '0' then
+		iRegCcRed <= (others => '0');
+		iRegCcGreen <= (others => '0');
+		iRegCcBlue <= (others => '0');
+		iRegCcValid2 <= '0';
+		iRegGammaValid <= '0';
+	elsif rising_edge(CI_CA_PixClk) then
+		for row in 0 TO 2 loop
+			sum := resize(iRegCcProducts(3*row), 31) + iRegCcProducts(3*row + 1) + iRegCcProducts(3*row + 2);
+			if iRegColorControl (0) = '0' then	-- matrix disabled
+				result(row) := iRegCcInput(row);
+			elsif sum < 0 then
+				result(row) := (others => '0');
+			elsif sum (30 DOWNTO 8) > 4095 then
+				result(row) := (others => '1');
+			else
+				result(row) := unsigned(sum (19 DOWNTO 8));
+			end if;
+		end loop;
+		iRegCcRed <= result(0);
+		iRegCcGreen <= result(1);
+		iRegCcBlue <= result(2);
+		iRegCcValid2 <= iRegCcValid1;
+		iRegGammaValid <= iRegCcValid2;	-- the gamma tables are read during the next clock
+	end if;
+end process ColorSum;
+
+-- Process to write the gamma tables, synchronous to the Avalon slave
+GammaWrite:
+Process(CI_Clk)
+Begin
+	if rising_edge(CI_Clk) then
+		if CI_AS_LutWrite = '1' then
+			case CI_AS_LutAddress (9 DOWNTO 8) is
+				when "00" => iRegGammaTableRed(to_integer(unsigned(CI_AS_LutAddress (7 DOWNTO 0)))) <= CI_AS_LutData;
+				when "01" => iRegGammaTableGreen(to_integer(unsigned(CI_AS_LutAddress (7 DOWNTO 0)))) <= CI_AS_LutData;
+				when "10" => iRegGammaTableBlue(to_integer(unsigned(CI_AS_LutAddress (7 DOWNTO 0)))) <= CI_AS_LutData;
+				when others => null;
+			end case;
+		end if;
+	end if;
+end process GammaWrite;
+
+-- Process to read the gamma tables
+Gamma:
+Process(CI_CA_PixClk)
+Begin
+	if rising_edge(CI_CA_PixClk) then	-- no reset, the tables are inferred as memory blocks
+		iRegGammaRed <= iRegGammaTableRed(to_integer(iRegCcRed (11 DOWNTO 4)));
+		iRegGammaGreen <= iRegGammaTableGreen(to_integer(iRegCcGreen (11 DOWNTO 4)));
+		iRegGammaBlue <= iRegGammaTableBlue(to_integer(iRegCcBlue (11 DOWNTO 4)));
+		iRegGammaBypass <= (iRegCcRed, iRegCcGreen, iRegCcBlue);
+	end if;
+end process Gamma;
+
+-- Corrected pixel, from the gamma tables or directly from the matrix
+Sig_CorrectedRed <= unsigned(iRegGammaRed) when iRegColorControl (1) = '1' else iRegGammaBypass(0);
+Sig_CorrectedGreen <= unsigned(iRegGammaGreen) when iRegColorControl (1) = '1' else iRegGammaBypass(1);
+Sig_CorrectedBlue <= unsigned(iRegGammaBlue) when iRegColorControl (1) = '1' else iRegGammaBypass(2);
+
+-- Process to pack the output pixel in the 5*6*5 RGB format, in the luminance format or as raw samples
+Packing:
+Process(CI_nReset, CI_CA_PixClk)
+
+variable luma : unsigned (19 DOWNTO 0);	-- 256 * Y on 12 bits
+variable lastColumn : unsigned (9 DOWNTO 0);	-- last column of the output image
+variable threshold : natural range 0 TO 15;	-- entry of the Bayer matrix of the pixel
+
+Begin
+	if CI_nReset = '0' then
+		iRegRGB <= (others => '0');
+		iRegSecondPixel <= '0';
+		iRegFIFOWrite <= '0';
+		iRegPackColumn <= (others => '0');
+		iRegPackRow <= "00";
+	elsif falling_edge(CI_CA_PixClk) then
+		iRegFIFOWrite <= '0';
+		
+		if iRegDemosaic = '1' then
+			lastColumn := to_unsigned(639, 10);
+		else
+			case iRegScale is
+				when "01" => lastColumn := to_unsigned(159, 10);
+				when "10" => lastColumn := to_unsigned(79, 10);
+				when others => lastColumn := to_unsigned(319, 10);
+			end case;
+		end if;
+		threshold := BAYER_MATRIX(to_integer(iRegPackRow & iRegPackColumn (1 DOWNTO 0)));
+		
+		if iRegStart = '0' OR iRegPending = '1' then
+			iRegSecondPixel <= '0';
+			iRegPackColumn <= (others => '0');
+			iRegPackRow <= "00";
+		elsif iRegPixelFormat (1) = '1' then	-- raw samples
+			if iRegRawValid = '1' then
+				if iRegPixelFormat (0) = '0' then	-- 12 bits, 1 sample per word
+					iRegRGB <= "0000" & iRegRawData;
+					iRegFIFOWrite <= '1';
+				else	-- 8 bits, 2 samples per word
+					if iRegSecondPixel = '0' then
+						iRegRGB (7 DOWNTO 0) <= iRegRawData (11 DOWNTO 4);
+					else
+						iRegRGB (15 DOWNTO 8) <= iRegRawData (11 DOWNTO 4);
+						iRegFIFOWrite <= '1';
+					end if;
+					iRegSecondPixel <= not iRegSecondPixel;
+				end if;
+			end if;
+		elsif iRegGammaValid = '1' then
+			if iRegPackColumn = lastColumn then
+				iRegPackColumn <= (others => '0');
+				iRegPackRow <= iRegPackRow + 1;
+			else
+				iRegPackColumn <= iRegPackColumn + 1;
+			end if;
+			
+			if iRegPixelFormat = "01" then	-- luminance, 2 pixels per word
+				luma := Sig_CorrectedRed * to_unsigned(77, 8) + Sig_CorrectedGreen * to_unsigned(150, 8) + Sig_CorrectedBlue * to_unsigned(29, 8);
+				if iRegSecondPixel = '0' then
+					iRegRGB (7 DOWNTO 0) <= std_logic_vector(luma (19 DOWNTO 12));
+				else
+					iRegRGB (15 DOWNTO 8) <= std_logic_vector(luma (19 DOWNTO 12));
+					iRegFIFOWrite <= '1';
+				end if;
+				iRegSecondPixel <= not iRegSecondPixel;
+			else
+				iRegRGB (15 DOWNTO 11) <= reduce(Sig_CorrectedRed, 5, iRegReduction, threshold);
+				iRegRGB (10 DOWNTO 5) <= reduce(Sig_CorrectedGreen, 6, iRegReduction, threshold);
+				iRegRGB (4 DOWNTO 0) <= reduce(Sig_CorrectedBlue, 5, iRegReduction, threshold);
+				iRegFIFOWrite <= '1';
+			end if;
+		end if;
+	end if;
+end process Packing;
+
 -- Process to put the datas in the FIFO
 TransferData:
 Process(CI_nReset, CI_CA_PixClk)
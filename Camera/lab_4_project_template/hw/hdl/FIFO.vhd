@@ -40,6 +40,10 @@ LIBRARY altera_mf;
 USE altera_mf.all;
 
 ENTITY FIFO IS
+	GENERIC
+	(
+		FIFO_DEPTH_LOG2		: NATURAL := 10							-- log2 of the depth in 16 bits words (10 -> 1024 words = 2 KB, 2 M10K blocks)
+	);
 	PORT
 	(
 		FIFO_Reset			: IN STD_LOGIC ;
@@ -47,20 +51,20 @@ ENTITY FIFO IS
 		FIFO_WriteClk		: IN STD_LOGIC ;
 		FIFO_CI_WriteData	: IN STD_LOGIC_VECTOR (15 DOWNTO 0);
 		FIFO_CI_WriteEnable	: IN STD_LOGIC ;
-		FIFO_CI_UsedWords	: OUT STD_LOGIC_VECTOR (9 DOWNTO 0);
+		FIFO_CI_UsedWords	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-1 DOWNTO 0);
 		
 		FIFO_ReadClk		: IN STD_LOGIC ;
 		FIFO_AM_ReadData	: OUT STD_LOGIC_VECTOR (31 DOWNTO 0);
 		FIFO_AM_ReadCheck	: IN STD_LOGIC ;
-		FIFO_AM_UsedWords	: OUT STD_LOGIC_VECTOR (8 DOWNTO 0)
+		FIFO_AM_UsedWords	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-2 DOWNTO 0)
 	);
 END FIFO;
 
 ARCHITECTURE SYN OF fifo IS
 
 	SIGNAL sub_wire0	: STD_LOGIC_VECTOR (31 DOWNTO 0);
-	SIGNAL sub_wire1	: STD_LOGIC_VECTOR (8 DOWNTO 0);
-	SIGNAL sub_wire2	: STD_LOGIC_VECTOR (9 DOWNTO 0);
+	SIGNAL sub_wire1	: STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-2 DOWNTO 0);
+	SIGNAL sub_wire2	: STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-1 DOWNTO 0);
 
 	COMPONENT dcfifo_mixed_widths
 	GENERIC (
@@ -88,25 +92,25 @@ ARCHITECTURE SYN OF fifo IS
 			wrclk	: IN STD_LOGIC ;
 			wrreq	: IN STD_LOGIC ;
 			q		: OUT STD_LOGIC_VECTOR (31 DOWNTO 0);
-			rdusedw	: OUT STD_LOGIC_VECTOR (8 DOWNTO 0);
-			wrusedw	: OUT STD_LOGIC_VECTOR (9 DOWNTO 0)
+			rdusedw	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-2 DOWNTO 0);
+			wrusedw	: OUT STD_LOGIC_VECTOR (FIFO_DEPTH_LOG2-1 DOWNTO 0)
 	);
 	END COMPONENT;
 
 BEGIN
 	FIFO_AM_ReadData    <= sub_wire0(31 DOWNTO 0);
-	FIFO_AM_UsedWords   <= sub_wire1(8 DOWNTO 0);
-	FIFO_CI_UsedWords   <= sub_wire2(9 DOWNTO 0);
+	FIFO_AM_UsedWords   <= sub_wire1(FIFO_DEPTH_LOG2-2 DOWNTO 0);
+	FIFO_CI_UsedWords   <= sub_wire2(FIFO_DEPTH_LOG2-1 DOWNTO 0);
 
 	dcfifo_mixed_widths_component : dcfifo_mixed_widths
 	GENERIC MAP (
 		intended_device_family => "Cyclone V",
-		lpm_numwords => 1024,
+		lpm_numwords => 2**FIFO_DEPTH_LOG2,
 		lpm_showahead => "ON",
 		lpm_type => "dcfifo_mixed_widths",
 		lpm_width => 16,
-		lpm_widthu => 10,
-		lpm_widthu_r => 9,
+		lpm_widthu => FIFO_DEPTH_LOG2,
+		lpm_widthu_r => FIFO_DEPTH_LOG2-1,
 		lpm_width_r => 32,
 		overflow_checking => "ON",
 		rdsync_delaypipe => 4,
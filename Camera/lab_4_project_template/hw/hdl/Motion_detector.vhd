@@ -0,0 +1,330 @@
+-- Design of a camera management device
+-- Motion detector unit
+--
+-- Authors : Nicolas Berling & Quentin François
+-- Date : ??.11.2016
+--
+-- Motion detector for the camera management device
+--
+-- The 640*480 Bayer window is averaged by cells of 8*8 samples, which gives a
+-- 80*60 luminance image (Y = (R + 2*G + B) / 4 on 8 bits). Each cell is compared
+-- with the same cell of the previous frame, kept in an on-chip memory of
+-- 4800 bytes: the cell has changed when the absolute difference is larger than
+-- MD_AS_PixelThreshold. The reference is then replaced by the new cell when
+-- MD_AS_Control (1) = 1, otherwise it is kept (fixed background).
+--
+-- The cells are grouped in blocks of 4*4 cells (32*32 samples), 20*15 blocks. A
+-- block has changed when more than MD_AS_BlockThreshold of its cells have
+-- changed. At the end of each frame, the changed cells and blocks counts and
+-- the bitmap of the changed blocks (bit 20*row + column) are given to the
+-- Avalon slave with a pulse of MD_AS_Done.
+--
+-- The detector reads the camera by itself, it works whether the acquisition is
+-- started or not. It is enabled by MD_AS_Control (0) and waits for the next
+-- frame after being enabled; the first frame only loads the reference.
+--
+-- INPUTS
+-- MD_nReset <= extern
+-- MD_Clk <= extern
+--
+-- MD_CA_PixClk <= Camera
+-- MD_CA_Data <= Camera
+-- MD_CA_FrameValid <= Camera
+-- MD_CA_LineValid <= Camera
+--
+-- MD_AS_Control <= Slave
+-- MD_AS_PixelThreshold <= Slave
+-- MD_AS_BlockThreshold <= Slave
+--
+-- OUTPUTS
+-- MD_AS_Done => Slave
+-- MD_AS_ChangedCells => Slave
+-- MD_AS_ChangedBlocks => Slave
+-- MD_AS_Bitmap => Slave
+
+LIBRARY ieee;
+USE ieee.std_logic_1164.all;
+USE ieee.numeric_std.all;
+
+ENTITY Motion_detector IS
+	PORT(
+		MD_nReset				: IN std_logic;							-- nReset input
+		MD_Clk					: IN std_logic;							-- clock input
+
+		MD_CA_PixClk			: IN std_logic;							-- pixel clock received from the camera
+		MD_CA_Data				: IN std_logic_vector (11 DOWNTO 0);	-- pixel sent by the camera
+		MD_CA_FrameValid		: IN std_logic;							-- 1 if the frame is valid
+		MD_CA_LineValid			: IN std_logic;							-- 1 if the line is valid
+
+		MD_AS_Control			: IN std_logic_vector (1 DOWNTO 0);		-- 1 = enabled (bit 0), reference updated with each frame (bit 1)
+		MD_AS_PixelThreshold	: IN std_logic_vector (7 DOWNTO 0);		-- Difference above which a cell has changed
+		MD_AS_BlockThreshold	: IN std_logic_vector (4 DOWNTO 0);		-- Number of changed cells above which a block has changed
+		MD_AS_Done				: OUT std_logic;						-- 1 during one clock when the results of a frame are available
+		MD_AS_ChangedCells		: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+		MD_AS_ChangedBlocks		: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+		MD_AS_Bitmap			: OUT std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame, bit 20*row + column
+	);
+END Motion_detector;
+
+ARCHITECTURE bhv OF Motion_detector IS
+	constant	CELL_COLUMNS		: natural := 80;					-- cells in a row, 8 samples each
+	constant	CELLS				: natural := 4800;					-- cells in a frame
+	constant	BLOCK_COLUMNS		: natural := 20;					-- blocks in a row, 4 cells each
+	constant	BLOCKS				: natural := 300;					-- blocks in a frame
+
+	signal	iRegControl			: std_logic_vector (1 DOWNTO 0);	-- internal register for the control
+	signal	iRegPixelThreshold	: unsigned (7 DOWNTO 0);			-- internal register for the pixel threshold
+	signal	iRegBlockThreshold	: unsigned (4 DOWNTO 0);			-- internal register for the block threshold
+
+	signal	iRegSynced			: std_logic;						-- 1 when the counters follow the frame of the camera
+	signal	iRegLineValidOld	: std_logic;						-- previous state of MD_CA_LineValid
+	signal	iRegColumn			: unsigned (9 DOWNTO 0);			-- column of the sample
+	signal	iRegRow				: unsigned (8 DOWNTO 0);			-- row of the sample
+	signal	iRegCellCount		: unsigned (12 DOWNTO 0);			-- index of the next cell
+
+	TYPE Sums is array (0 TO CELL_COLUMNS-1) of unsigned (17 DOWNTO 0);
+	signal	iRegSum				: Sums;								-- sums of the cells of the current row of cells
+
+	signal	iRegCellValid		: std_logic;						-- 1 during one pixel clock when a cell is complete
+	signal	iRegCellValue		: unsigned (7 DOWNTO 0);			-- luminance of the cell
+	signal	iRegCellIndex		: unsigned (12 DOWNTO 0);			-- index of the cell, 80*row + column
+	signal	iRegCellColumn		: unsigned (6 DOWNTO 0);			-- column of the cell
+	signal	iRegCellRow			: unsigned (5 DOWNTO 0);			-- row of the cell
+
+	TYPE Reference is array (0 TO CELLS-1) of std_logic_vector (7 DOWNTO 0);
+	signal	iRegReference		: Reference;						-- cells of the reference frame
+	signal	iRegRefData			: std_logic_vector (7 DOWNTO 0);	-- reference of the cell being compared
+
+	signal	iRegCmpValid		: std_logic;						-- 1 when the cell is compared with its reference
+	signal	iRegCmpValue		: unsigned (7 DOWNTO 0);
+	signal	iRegCmpIndex		: unsigned (12 DOWNTO 0);
+	signal	iRegCmpColumn		: unsigned (6 DOWNTO 0);
+	signal	iRegCmpRow			: unsigned (5 DOWNTO 0);
+
+	TYPE BlockCounts is array (0 TO BLOCK_COLUMNS-1) of unsigned (4 DOWNTO 0);
+	signal	iRegBlockCount		: BlockCounts;						-- changed cells of the blocks of the current row of blocks
+	signal	iRegChangedCells	: unsigned (15 DOWNTO 0);			-- changed cells of the current frame
+	signal	iRegChangedBlocks	: unsigned (15 DOWNTO 0);			-- changed blocks of the current frame
+	signal	iRegBitmap			: std_logic_vector (BLOCKS-1 DOWNTO 0);	-- changed blocks of the current frame
+	signal	iRegFrameEnd		: std_logic;						-- 1 when the last cell of the frame has been compared
+	signal	iRegPrimed			: std_logic;						-- 1 when the reference holds a complete frame
+
+	signal	iRegResultCells		: std_logic_vector (15 DOWNTO 0);	-- results of the last frame, stable during the next frame
+	signal	iRegResultBlocks	: std_logic_vector (15 DOWNTO 0);
+	signal	iRegResultBitmap	: std_logic_vector (BLOCKS-1 DOWNTO 0);
+	signal	iRegResultToggle	: std_logic;						-- toggles when new results are available
+	signal	iRegToggleSync		: std_logic_vector (2 DOWNTO 0);	-- iRegResultToggle synchronized on MD_Clk
+
+BEGIN
+
+-- Process to sample the configuration given by the slave
+Acquisition:
+Process(MD_nReset, MD_Clk)
+Begin
+	if MD_nReset = '0' then
+		iRegControl <= "00";
+		iRegPixelThreshold <= (others => '0');
+		iRegBlockThreshold <= (others => '0');
+	elsif rising_edge(MD_Clk) then
+		iRegControl <= MD_AS_Control;
+		iRegPixelThreshold <= unsigned(MD_AS_PixelThreshold);
+		iRegBlockThreshold <= unsigned(MD_AS_BlockThreshold);
+	end if;
+end process Acquisition;
+
+-- Process to sum the samples of each cell of 8*8 samples
+Accumulate:
+Process(MD_nReset, MD_CA_PixClk)
+
+variable cell : natural range 0 TO CELL_COLUMNS-1;
+variable sum : unsigned (17 DOWNTO 0);
+
+Begin
+	if MD_nReset = '0' then
+		iRegSynced <= '0';
+		iRegLineValidOld <= '0';
+		iRegColumn <= (others => '0');
+		iRegRow <= (others => '0');
+		iRegCellCount <= (others => '0');
+		iRegSum <= (others => (others => '0'));
+		iRegCellValid <= '0';
+		iRegCellValue <= (others => '0');
+		iRegCellIndex <= (others => '0');
+		iRegCellColumn <= (others => '0');
+		iRegCellRow <= (others => '0');
+	elsif falling_edge(MD_CA_PixClk) then	-- read the pixel on the falling edge of the MD_CA_PixClk
+		iRegCellValid <= '0';
+		iRegLineValidOld <= MD_CA_LineValid;
+
+		if iRegControl (0) = '0' then	-- disabled, wait for the next frame
+			iRegSynced <= '0';
+		elsif MD_CA_FrameValid = '0' then	-- vertical blanking, the next frame begins
+			iRegSynced <= '1';
+			iRegColumn <= (others => '0');
+			iRegRow <= (others => '0');
+			iRegCellCount <= (others => '0');
+		elsif iRegSynced = '1' then
+			if MD_CA_LineValid = '1' then
+				if iRegColumn < 640 AND iRegRow < 480 then
+					cell := to_integer(iRegColumn (9 DOWNTO 3));
+					if iRegColumn (2 DOWNTO 0) = "000" AND iRegRow (2 DOWNTO 0) = "000" then	-- first sample of the cell
+						sum := resize(unsigned(MD_CA_Data), 18);
+					else
+						sum := iRegSum(cell) + unsigned(MD_CA_Data);
+					end if;
+					iRegSum(cell) <= sum;
+
+					if iRegColumn (2 DOWNTO 0) = "111" AND iRegRow (2 DOWNTO 0) = "111" then	-- last sample of the cell
+						iRegCellValue <= sum (17 DOWNTO 10);	-- average of 64 samples of 12 bits, on 8 bits
+						iRegCellIndex <= iRegCellCount;
+						iRegCellColumn <= iRegColumn (9 DOWNTO 3);
+						iRegCellRow <= iRegRow (8 DOWNTO 3);
+						iRegCellValid <= '1';
+						iRegCellCount <= iRegCellCount + 1;
+					end if;
+				end if;
+				iRegColumn <= iRegColumn + 1;
+			elsif iRegLineValidOld = '1' then	-- end of a line
+				iRegColumn <= (others => '0');
+				iRegRow <= iRegRow + 1;
+			end if;
+		end if;
+	end if;
+end process Accumulate;
+
+-- Process to read and write the reference frame
+-- The reference of a cell is read during the clock after the cell is complete
+-- and replaced during the next one, always during the first frame
+ReferenceMemory:
+Process(MD_CA_PixClk)
+Begin
+	if falling_edge(MD_CA_PixClk) then	-- no reset, the reference is inferred as a memory block
+		if iRegCmpValid = '1' AND (iRegControl (1) = '1' OR iRegPrimed = '0') then
+			iRegReference(to_integer(iRegCmpIndex)) <= std_logic_vector(iRegCmpValue);
+		end if;
+		iRegRefData <= iRegReference(to_integer(iRegCellIndex));
+	end if;
+end process ReferenceMemory;
+
+-- Process to compare the cells with the reference and to count the changes
+Compare:
+Process(MD_nReset, MD_CA_PixClk)
+
+variable difference : unsigned (7 DOWNTO 0);
+variable blockColumn : natural range 0 TO BLOCK_COLUMNS-1;
+variable count : unsigned (4 DOWNTO 0);
+variable changedCells : unsigned (15 DOWNTO 0);
+variable changedBlocks : unsigned (15 DOWNTO 0);
+
+Begin
+	if MD_nReset = '0' then
+		iRegCmpValid <= '0';
+		iRegCmpValue <= (others => '0');
+		iRegCmpIndex <= (others => '0');
+		iRegCmpColumn <= (others => '0');
+		iRegCmpRow <= (others => '0');
+		iRegBlockCount <= (others => (others => '0'));
+		iRegChangedCells <= (others => '0');
+		iRegChangedBlocks <= (others => '0');
+		iRegBitmap <= (others => '0');
+		iRegFrameEnd <= '0';
+		iRegPrimed <= '0';
+		iRegResultCells <= (others => '0');
+		iRegResultBlocks <= (others => '0');
+		iRegResultBitmap <= (others => '0');
+		iRegResultToggle <= '0';
+	elsif falling_edge(MD_CA_PixClk) then
+		iRegCmpValid <= iRegCellValid;
+		iRegCmpValue <= iRegCellValue;
+		iRegCmpIndex <= iRegCellIndex;
+		iRegCmpColumn <= iRegCellColumn;
+		iRegCmpRow <= iRegCellRow;
+		iRegFrameEnd <= '0';
+
+		if iRegSynced = '0' then
+			iRegPrimed <= '0';
+		end if;
+
+		if iRegCmpValid = '1' then
+			if iRegCmpValue > unsigned(iRegRefData) then
+				difference := iRegCmpValue - unsigned(iRegRefData);
+			else
+				difference := unsigned(iRegRefData) - iRegCmpValue;
+			end if;
+
+			if iRegCmpIndex = 0 then	-- first cell of the frame
+				changedCells := (others => '0');
+				changedBlocks := (others => '0');
+			else
+				changedCells := iRegChangedCells;
+				changedBlocks := iRegChangedBlocks;
+			end if;
+
+			-- changed cells of the block
+			blockColumn := to_integer(iRegCmpColumn (6 DOWNTO 2));
+			if iRegCmpRow (1 DOWNTO 0) = "00" AND iRegCmpColumn (1 DOWNTO 0) = "00" then	-- first cell of the block
+				count := (others => '0');
+			else
+				count := iRegBlockCount(blockColumn);
+			end if;
+
+			if difference > iRegPixelThreshold then
+				changedCells := changedCells + 1;
+				count := count + 1;
+			end if;
+			iRegBlockCount(blockColumn) <= count;
+
+			if iRegCmpRow (1 DOWNTO 0) = "11" AND iRegCmpColumn (1 DOWNTO 0) = "11" then	-- last cell of the block
+				if count > iRegBlockThreshold then
+					iRegBitmap(BLOCK_COLUMNS * to_integer(iRegCmpRow (5 DOWNTO 2)) + blockColumn) <= '1';
+					changedBlocks := changedBlocks + 1;
+				else
+					iRegBitmap(BLOCK_COLUMNS * to_integer(iRegCmpRow (5 DOWNTO 2)) + blockColumn) <= '0';
+				end if;
+			end if;
+
+			iRegChangedCells <= changedCells;
+			iRegChangedBlocks <= changedBlocks;
+
+			if iRegCmpIndex = CELLS-1 then	-- last cell of the frame
+				iRegFrameEnd <= '1';
+			end if;
+		end if;
+
+		-- give the results of the frame, the first frame only loads the reference
+		if iRegFrameEnd = '1' then
+			if iRegPrimed = '1' then
+				iRegResultCells <= std_logic_vector(iRegChangedCells);
+				iRegResultBlocks <= std_logic_vector(iRegChangedBlocks);
+				iRegResultBitmap <= iRegBitmap;
+				iRegResultToggle <= not iRegResultToggle;
+			end if;
+			iRegPrimed <= iRegSynced;
+		end if;
+	end if;
+end process Compare;
+
+-- Process to give the results to the slave, synchronous to MD_Clk
+-- The results are stable during a whole frame after each toggle
+UpdateOutput:
+Process(MD_nReset, MD_Clk)
+Begin
+	if MD_nReset = '0' then
+		iRegToggleSync <= "000";
+		MD_AS_Done <= '0';
+		MD_AS_ChangedCells <= (others => '0');
+		MD_AS_ChangedBlocks <= (others => '0');
+		MD_AS_Bitmap <= (others => '0');
+	elsif rising_edge(MD_Clk) then
+		iRegToggleSync <= iRegToggleSync (1 DOWNTO 0) & iRegResultToggle;
+		MD_AS_Done <= '0';
+		if iRegToggleSync (2) /= iRegToggleSync (1) then
+			MD_AS_ChangedCells <= iRegResultCells;
+			MD_AS_ChangedBlocks <= iRegResultBlocks;
+			MD_AS_Bitmap <= iRegResultBitmap;
+			MD_AS_Done <= '1';
+		end if;
+	end if;
+end process UpdateOutput;
+
+END bhv;
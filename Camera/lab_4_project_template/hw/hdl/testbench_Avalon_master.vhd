@@ -41,13 +41,23 @@ component Avalon_master is
 		AM_AB_MemoryAddress	: OUT std_logic_vector (31 DOWNTO 0);	-- Adress sent on the Avalon bus
 		AM_AB_MemoryData	: OUT std_logic_vector (31 DOWNTO 0);	-- Datas sent on the Avalon bus
 		AM_AB_WriteAccess	: OUT std_logic;						-- Pin write, 1 when the component wants to use the bus
+		AM_AB_ReadAccess	: OUT std_logic;						-- Pin read, 1 when the component wants to read a descriptor
+		AM_AB_ReadData		: IN std_logic_vector (31 DOWNTO 0);	-- Datas received from the Avalon bus
+		AM_AB_ReadDataValid	: IN std_logic;							-- Pin readdatavalid, 1 when AM_AB_ReadData holds the requested word
 		AM_AB_BurstCount	: OUT std_logic_vector (7 DOWNTO 0);	-- Number of datas in one burst
 		AM_AB_WaitRequest	: IN std_logic;							-- Pin waitrequest which is 0 when the bus is available
 		
 		AM_AS_Start			: IN std_logic;							-- Start command
 		AM_AS_StartAddress	: IN std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
 		AM_AS_Length		: IN std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+		AM_AS_Descriptor	: IN std_logic;							-- 1 when AM_AS_StartAddress points to a descriptor
 		AM_AS_Status		: OUT std_logic;						-- 1 when the image has been written to the memory
+		AM_AS_Crc			: OUT std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AM_AS_Status = 1
+		AM_AS_Trailer		: IN std_logic;							-- 1 when a trailer is written after each frame
+		AM_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image, copied in the trailer
+		
+		AM_CI_FrameCount	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+		AM_CI_DroppedLines	: IN std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 		
 		AM_FIFO_ReadCheck	: OUT std_logic;						-- 1 = information asked to the Fifo, 0 = no demand
 		AM_FIFO_ReadData	: IN std_logic_vector (31 DOWNTO 0);	-- 1 pixel stored in the FIFO by hte camera controller
@@ -62,13 +72,23 @@ signal AM_Clk_test				: std_logic := '0';
 signal AM_AB_MemoryAddress_test	: std_logic_vector (31 DOWNTO 0);
 signal AM_AB_MemoryData_test	: std_logic_vector (31 DOWNTO 0);
 signal AM_AB_WriteAccess_test	: std_logic;
+signal AM_AB_ReadAccess_test	: std_logic;
+signal AM_AB_ReadData_test		: std_logic_vector (31 DOWNTO 0) := X"00000000";
+signal AM_AB_ReadDataValid_test	: std_logic := '0';
 signal AM_AB_BurstCount_test	: std_logic_vector (7 DOWNTO 0);
 signal AM_AB_WaitRequest_test	: std_logic := '0';
 
 signal AM_AS_Start_test			: std_logic := '0';
 signal AM_AS_StartAddress_test	: std_logic_vector (31 DOWNTO 0) := X"10000000";
 signal AM_AS_Length_test		: std_logic_vector (31 DOWNTO 0) := X"00025800";
+signal AM_AS_Descriptor_test	: std_logic := '0';
 signal AM_AS_Status_test		: std_logic;
+signal AM_AS_Crc_test			: std_logic_vector (31 DOWNTO 0);
+signal AM_AS_Trailer_test		: std_logic := '0';
+signal AM_AS_Format_test		: std_logic_vector (7 DOWNTO 0) := X"00";
+
+signal AM_CI_FrameCount_test	: std_logic_vector (31 DOWNTO 0) := X"00000007";
+signal AM_CI_DroppedLines_test	: std_logic_vector (31 DOWNTO 0) := X"00000000";
 
 signal AM_FIFO_ReadCheck_test	: std_logic;
 signal AM_FIFO_ReadData_test	: std_logic_vector (31 DOWNTO 0) := X"00000000";
@@ -87,13 +107,23 @@ DUT : Avalon_master	-- Component to test as Device Under Test
 		AM_AB_MemoryAddress => AM_AB_MemoryAddress_test,
 		AM_AB_MemoryData 	=> AM_AB_MemoryData_test,
 		AM_AB_WriteAccess 	=> AM_AB_WriteAccess_test,
+		AM_AB_ReadAccess 	=> AM_AB_ReadAccess_test,
+		AM_AB_ReadData 		=> AM_AB_ReadData_test,
+		AM_AB_ReadDataValid	=> AM_AB_ReadDataValid_test,
 		AM_AB_BurstCount 	=> AM_AB_BurstCount_test,
 		AM_AB_WaitRequest 	=> AM_AB_WaitRequest_test,
 		
 		AM_AS_StartAddress 	=> AM_AS_StartAddress_test,
 		AM_AS_Length 		=> AM_AS_Length_test,
 		AM_AS_Start 		=> AM_AS_Start_test,
+		AM_AS_Descriptor	=> AM_AS_Descriptor_test,
 		AM_AS_Status 		=> AM_AS_Status_test,
+		AM_AS_Crc			=> AM_AS_Crc_test,
+		AM_AS_Trailer		=> AM_AS_Trailer_test,
+		AM_AS_Format		=> AM_AS_Format_test,
+		
+		AM_CI_FrameCount	=> AM_CI_FrameCount_test,
+		AM_CI_DroppedLines	=> AM_CI_DroppedLines_test,
 		
 		AM_FIFO_ReadCheck 	=> AM_FIFO_ReadCheck_test,
 		AM_FIFO_ReadData 	=> AM_FIFO_ReadData_test,
@@ -144,6 +174,24 @@ Begin
 	wait;
 end process transfer_fifo;
 
+-- Process to answer the descriptor reads, one word one clock after the request
+-- Descriptor : buffer at 0x10100000, one frame of 0x25800 bytes, buffer id 5
+memory_desc :
+Process
+Begin
+	wait until rising_edge(AM_Clk_test);
+	AM_AB_ReadDataValid_test <= '0';
+	if AM_AB_ReadAccess_test = '1' AND AM_AB_WaitRequest_test = '0' then
+		AM_AB_ReadDataValid_test <= '1';
+		case AM_AB_MemoryAddress_test (3 DOWNTO 0) is
+			when X"0" => AM_AB_ReadData_test <= X"10100000";
+			when X"4" => AM_AB_ReadData_test <= X"00025800";
+			when X"8" => AM_AB_ReadData_test <= X"00000005";
+			when others => AM_AB_ReadData_test <= X"00000000";
+		end case;
+	end if;
+end process memory_desc;
+
 --	Process to test the component
 test :
 Process
@@ -193,8 +241,15 @@ Begin
 	wait until rising_edge(AM_Clk_test);
 	AM_AS_Start_test <= '0';
 	
+	-- Second image in descriptor mode with a trailer, the start address points to the descriptor
+	-- The trailer is expected at 0x10125800 : 8, timestamp, 0x1E0, 0xCA3E0500
 	wait for 50*HalfPeriod;
 	wait until rising_edge(AM_Clk_test);
+	AM_AS_StartAddress_test <= X"10200000";
+	AM_AS_Descriptor_test <= '1';
+	AM_AS_Trailer_test <= '1';
+	AM_CI_FrameCount_test <= X"00000008";
+	AM_CI_DroppedLines_test <= X"000001E0";
 	AM_AS_Start_test <= '1';
 
 	wait;
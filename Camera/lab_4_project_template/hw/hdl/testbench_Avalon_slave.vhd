@@ -38,19 +38,37 @@ component Avalon_slave is
 		AS_nReset			: IN std_logic;							-- nReset input
 		AS_Clk				: IN std_logic;							-- clock input
 		
-		AS_AB_Address		: IN std_logic_vector (3 DOWNTO 0);		-- address bus
+		AS_AB_Address		: IN std_logic_vector (7 DOWNTO 0);		-- address bus
 		AS_AB_ReadEnable	: IN std_logic;							-- read enabler
 		AS_AB_WriteEnable	: IN std_logic;							-- write enabler
 		AS_AB_ReadData		: OUT std_logic_vector (7 DOWNTO 0);	-- data bus (read)
 		AS_AB_WriteData		: IN std_logic_vector (7 DOWNTO 0);		-- data bus (write)
+		AS_IRQ				: OUT std_logic;						-- interrupt request, 1 on a motion alarm
 		
 		AS_ALL_Start		: OUT std_logic;						-- Start information
 		
 		AS_AM_StartAddress	: OUT std_logic_vector (31 DOWNTO 0); 	-- Start Adress in the memory
 		AS_AM_Length		: OUT std_logic_vector (31 DOWNTO 0);	-- Length of the stored datas
+		AS_AM_Descriptor	: OUT std_logic;						-- 1 when AS_AM_StartAddress points to a descriptor
 		AS_AM_Status		: IN std_logic;							-- 1 when the image has been written to the memory
+		AS_AM_Crc			: IN std_logic_vector (31 DOWNTO 0);	-- CRC-32 of the image, valid when AS_AM_Status = 1
+		AS_AM_Trailer		: OUT std_logic;						-- 1 when a trailer is written after each frame
 		
-		AS_CI_Pending		: IN std_logic							-- Pending information
+		AS_CI_Pending		: IN std_logic;							-- Pending information
+		AS_CI_Format		: OUT std_logic_vector (7 DOWNTO 0);	-- Format of the output image (downscaling, pixel format)
+		AS_CI_ColorControl	: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+		AS_CI_Matrix		: OUT std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+		AS_CI_LutWrite		: OUT std_logic;						-- 1 = write AS_CI_LutData in a gamma table
+		AS_CI_LutAddress	: OUT std_logic_vector (9 DOWNTO 0);	-- Channel (9->8) and index (7->0) in the gamma tables
+		AS_CI_LutData		: OUT std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
+		
+		AS_MD_Control		: OUT std_logic_vector (1 DOWNTO 0);	-- 1 = motion detection enabled (bit 0), reference updated (bit 1)
+		AS_MD_PixelThreshold: OUT std_logic_vector (7 DOWNTO 0);	-- Difference above which a cell has changed
+		AS_MD_BlockThreshold: OUT std_logic_vector (4 DOWNTO 0);	-- Number of changed cells above which a block has changed
+		AS_MD_Done			: IN std_logic;							-- 1 when the results of a frame are available
+		AS_MD_ChangedCells	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+		AS_MD_ChangedBlocks	: IN std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+		AS_MD_Bitmap		: IN std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame
 	);
 end component;
 
@@ -58,19 +76,37 @@ end component;
 signal AS_nReset_test			: std_logic := '1';
 signal AS_Clk_test				: std_logic := '0';
 
-signal AS_AB_Address_test		: std_logic_vector (3 DOWNTO 0) := X"0";
+signal AS_AB_Address_test		: std_logic_vector (7 DOWNTO 0) := X"00";
 signal AS_AB_ReadEnable_test	: std_logic := '0';
 signal AS_AB_WriteEnable_test	: std_logic := '0';
 signal AS_AB_ReadData_test		: std_logic_vector (7 DOWNTO 0);
 signal AS_AB_WriteData_test		: std_logic_vector (7 DOWNTO 0) := X"00";
+signal AS_IRQ_test				: std_logic;
 
 signal AS_ALL_Start_test		: std_logic;
 
 signal AS_AM_StartAddress_test	: std_logic_vector (31 DOWNTO 0);
 signal AS_AM_Length_test		: std_logic_vector (31 DOWNTO 0);
+signal AS_AM_Descriptor_test	: std_logic;
+signal AS_AM_Trailer_test		: std_logic;
 signal AS_AM_Status_test		: std_logic := '0';
+signal AS_AM_Crc_test			: std_logic_vector (31 DOWNTO 0) := X"00000000";
 
 signal AS_CI_Pending_test		: std_logic := '0';
+signal AS_CI_Format_test		: std_logic_vector (7 DOWNTO 0);
+signal AS_CI_ColorControl_test	: std_logic_vector (1 DOWNTO 0);
+signal AS_CI_Matrix_test		: std_logic_vector (143 DOWNTO 0);
+signal AS_CI_LutWrite_test		: std_logic;
+signal AS_CI_LutAddress_test	: std_logic_vector (9 DOWNTO 0);
+signal AS_CI_LutData_test		: std_logic_vector (11 DOWNTO 0);
+
+signal AS_MD_Control_test		: std_logic_vector (1 DOWNTO 0);
+signal AS_MD_PixelThreshold_test: std_logic_vector (7 DOWNTO 0);
+signal AS_MD_BlockThreshold_test: std_logic_vector (4 DOWNTO 0);
+signal AS_MD_Done_test			: std_logic := '0';
+signal AS_MD_ChangedCells_test	: std_logic_vector (15 DOWNTO 0) := X"0000";
+signal AS_MD_ChangedBlocks_test	: std_logic_vector (15 DOWNTO 0) := X"0000";
+signal AS_MD_Bitmap_test		: std_logic_vector (299 DOWNTO 0) := (others => '0');
 
 signal end_sim	: boolean := false;
 constant HalfPeriod  : TIME := 10 ns;  -- clk_FPGA = 50 MHz -> T_FPGA = 20ns -> T/2 = 10 ns
@@ -86,14 +122,32 @@ DUT : Avalon_slave	-- Component to test as Device Under Test
 		AS_AB_WriteEnable 	=> AS_AB_WriteEnable_test,
 		AS_AB_ReadData 		=> AS_AB_ReadData_test,
 		AS_AB_WriteData 	=> AS_AB_WriteData_test,
+		AS_IRQ				=> AS_IRQ_test,
 		
 		AS_ALL_Start 		=> AS_ALL_Start_test,
 		
 		AS_AM_StartAddress 	=> AS_AM_StartAddress_test,
 		AS_AM_Length 		=> AS_AM_Length_test,
+		AS_AM_Descriptor	=> AS_AM_Descriptor_test,
 		AS_AM_Status 		=> AS_AM_Status_test,
+		AS_AM_Crc			=> AS_AM_Crc_test,
+		AS_AM_Trailer		=> AS_AM_Trailer_test,
+		
+		AS_CI_Pending		=> AS_CI_Pending_test,
+		AS_CI_Format		=> AS_CI_Format_test,
+		AS_CI_ColorControl	=> AS_CI_ColorControl_test,
+		AS_CI_Matrix		=> AS_CI_Matrix_test,
+		AS_CI_LutWrite		=> AS_CI_LutWrite_test,
+		AS_CI_LutAddress	=> AS_CI_LutAddress_test,
+		AS_CI_LutData		=> AS_CI_LutData_test,
 		
-		AS_CI_Pending		=> AS_CI_Pending_test
+		AS_MD_Control		=> AS_MD_Control_test,
+		AS_MD_PixelThreshold=> AS_MD_PixelThreshold_test,
+		AS_MD_BlockThreshold=> AS_MD_BlockThreshold_test,
+		AS_MD_Done			=> AS_MD_Done_test,
+		AS_MD_ChangedCells	=> AS_MD_ChangedCells_test,
+		AS_MD_ChangedBlocks	=> AS_MD_ChangedBlocks_test,
+		AS_MD_Bitmap		=> AS_MD_Bitmap_test
 	);
 
 -- Process to generate the clock during the whole simulation
@@ -134,7 +188,7 @@ Process
 		
 		wait until rising_edge(AS_Clk_test);	-- then reset everything
 		AS_AB_WriteEnable_test <= '0';
-		AS_AB_Address_test <= X"0";
+		AS_AB_Address_test <= X"00";
 		AS_AB_WriteData_test <= X"00";
 	end procedure write_register;
 
@@ -148,7 +202,7 @@ Process
 		wait until rising_edge(AS_Clk_test);
 		wait until rising_edge(AS_Clk_test);	-- then reset everything
 		AS_AB_ReadEnable_test <= '0';
-		AS_AB_Address_test <= X"0";
+		AS_AB_Address_test <= X"00";
 	end procedure read_register;
 
 Begin
@@ -156,84 +210,138 @@ Begin
 	toggle_reset;
 	
 	-- Writing AS_ALL_Start information = 0
-	write_register(X"0", X"00");
+	write_register(X"00", X"00");
 	
 	-- Writing start_adress = 0x01000000
-	write_register(X"1", X"00");
-	write_register(X"2", X"00");
-	write_register(X"3", X"00");
-	write_register(X"4", X"01");
+	write_register(X"01", X"00");
+	write_register(X"02", X"00");
+	write_register(X"03", X"00");
+	write_register(X"04", X"01");
 	
 	-- Writing AS_AM_Length = 320*240*2 = 0x00025800
-	write_register(X"5", X"00");
-	write_register(X"6", X"58");
-	write_register(X"7", X"02");
-	write_register(X"8", X"00");
+	write_register(X"05", X"00");
+	write_register(X"06", X"58");
+	write_register(X"07", X"02");
+	write_register(X"08", X"00");
 	
-	-- Reset Status
-	write_register(X"9", X"00");
+	-- Ring of 4 buffers spaced by 0x00030000, this also empties the ring
+	write_register(X"0C", X"00");
+	write_register(X"0D", X"00");
+	write_register(X"0E", X"03");
+	write_register(X"0F", X"00");
+	write_register(X"0B", X"04");
 	
 	-- Writing AS_ALL_Start information = 1
-	write_register(X"0", X"01");
+	write_register(X"00", X"01");
 	
 	-- Reading AS_ALL_Start information
-	read_register(X"0");
+	read_register(X"00");
 	
 	-- Reading the AS_AM_StartAddress
-	read_register(X"1");
-	read_register(X"2");
-	read_register(X"3");
-	read_register(X"4");
+	read_register(X"01");
+	read_register(X"02");
+	read_register(X"03");
+	read_register(X"04");
 	
 	-- Reading the AS_AM_Length
-	read_register(X"5");
-	read_register(X"6");
-	read_register(X"7");
-	read_register(X"8");
+	read_register(X"05");
+	read_register(X"06");
+	read_register(X"07");
+	read_register(X"08");
+	
+	-- Four frames fill the ring, the start information must fall after the fourth one
+	for frame in 1 to 4 loop
+		wait until rising_edge(AS_Clk_test);
+		AS_AM_Status_test <= '1';
+		AS_AM_Crc_test <= std_logic_vector(to_unsigned(frame, 8)) & X"C0FFEE";
+		wait until rising_edge(AS_Clk_test);
+		AS_AM_Status_test <= '0';
+		
+		-- Reading the ring head
+		read_register(X"09");
+	end loop;
 	
+	-- A frame completion while the ring is full must not move the head
 	wait until rising_edge(AS_Clk_test);
 	AS_AM_Status_test <= '1';
 	wait until rising_edge(AS_Clk_test);
 	AS_AM_Status_test <= '0';
+	read_register(X"09");
+	
+	-- The CRC follows the tail: 0x01C0FFEE for buffer 0, 0x03C0FFEE for buffer 2
+	read_register(X"38");
+	read_register(X"3B");
 	
-	read_register(X"9");
+	-- Releasing two buffers restarts the acquisition
+	write_register(X"0A", X"02");
+	read_register(X"0A");
+	read_register(X"3B");
 	
 	wait until rising_edge(AS_Clk_test);
 	AS_AM_Status_test <= '1';
 	wait until rising_edge(AS_Clk_test);
 	AS_AM_Status_test <= '0';
+	read_register(X"09");
 	
-	-- Writing AS_AM_Status of buffers
-	write_register(X"9", X"02");
+	-- Selecting the 160*120 format sets the length to 0x9600
+	write_register(X"10", X"01");
+	read_register(X"10");
+	read_register(X"05");
+	read_register(X"06");
 	
-	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '1';
-	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '0';
+	-- Selecting the 160*120 luminance format sets the length to 0x4B00
+	write_register(X"10", X"05");
+	read_register(X"05");
+	read_register(X"06");
 	
-	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '1';
-	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '0';
+	-- Selecting the raw 12 bits format sets the length to 0x96000
+	write_register(X"10", X"08");
+	read_register(X"05");
+	read_register(X"06");
+	read_register(X"07");
+	
+	-- Writing the green to green coefficient (1.5) and two entries of the green gamma table
+	write_register(X"28", X"80");
+	write_register(X"29", X"01");
+	read_register(X"28");
+	write_register(X"33", X"01");
+	write_register(X"34", X"10");
+	write_register(X"35", X"34");
+	write_register(X"36", X"02");
+	write_register(X"35", X"56");
+	write_register(X"36", X"03");
+	read_register(X"34");
+	write_register(X"32", X"03");
 	
-	-- Writing AS_AM_Status of buffers
-	write_register(X"9", X"05");
+	-- Motion detection with the interrupt, alarm above 0x0100 changed cells
+	write_register(X"44", X"00");
+	write_register(X"45", X"01");
+	write_register(X"40", X"07");
 	
+	-- Results below the alarm threshold, only the new results bit is set
 	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '1';
+	AS_MD_ChangedCells_test <= X"0080";
+	AS_MD_ChangedBlocks_test <= X"0002";
+	AS_MD_Bitmap_test (21) <= '1';
+	AS_MD_Bitmap_test (22) <= '1';
+	AS_MD_Done_test <= '1';
 	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '0';
-	
-	-- Writing AS_AM_Status of buffers
-	write_register(X"9", X"03");
+	AS_MD_Done_test <= '0';
+	read_register(X"46");
+	read_register(X"48");
+	read_register(X"52");
+	write_register(X"46", X"01");
 	
+	-- Results above the alarm threshold raise the interrupt until the alarm is cleared
 	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '1';
+	AS_MD_ChangedCells_test <= X"0180";
+	AS_MD_Done_test <= '1';
 	wait until rising_edge(AS_Clk_test);
-	AS_AM_Status_test <= '0';
-	
-	-- Reading AS_AM_Status of buffers
-	read_register(X"9");
+	AS_MD_Done_test <= '0';
+	read_register(X"46");
+	read_register(X"49");
+	write_register(X"46", X"03");
+	read_register(X"46");
 	
 	-- Receiving the pending information
 	wait until rising_edge(AS_Clk_test);
@@ -39,15 +39,19 @@ component Top_Camera_Controller is
 		TL_MainClk				: IN std_logic;							-- main clock input, FIFO read clock input
 		TL_PixClk				: IN std_logic;							-- pixel clock received from the camera, FIFO write clock input
 		
-		TL_AS_AB_Address		: IN std_logic_vector (3 DOWNTO 0);		-- address bus
+		TL_AS_AB_Address		: IN std_logic_vector (7 DOWNTO 0);		-- address bus
 		TL_AS_AB_ReadEnable		: IN std_logic;							-- read enabler
 		TL_AS_AB_WriteEnable	: IN std_logic;							-- write enabler
 		TL_AS_AB_ReadData		: OUT std_logic_vector (7 DOWNTO 0);	-- data bus (read)
 		TL_AS_AB_WriteData		: IN std_logic_vector (7 DOWNTO 0);	-- data bus (write)
+		TL_AS_IRQ				: OUT std_logic;						-- interrupt request, 1 on a motion alarm
 		
 		TL_AM_AB_MemoryAddress	: OUT std_logic_vector (31 DOWNTO 0);	-- Address sent on the Avalon bus
 		TL_AM_AB_MemoryData		: OUT std_logic_vector (31 DOWNTO 0);	-- Datas sent on the Avalon bus
 		TL_AM_AB_WriteAccess	: OUT std_logic;						-- Pin write, 1 when the component wants to use the bus
+		TL_AM_AB_ReadAccess		: OUT std_logic;						-- Pin read, 1 when the component wants to read a descriptor
+		TL_AM_AB_ReadData		: IN std_logic_vector (31 DOWNTO 0);	-- Datas received from the Avalon bus
+		TL_AM_AB_ReadDataValid	: IN std_logic;							-- Pin readdatavalid, 1 when TL_AM_AB_ReadData holds the requested word
 		TL_AM_AB_BurstCount		: OUT std_logic_vector (7 DOWNTO 0);	-- Number of datas in one burst
 		TL_AM_AB_WaitRequest	: IN std_logic;							-- Pin waitrequest which is 0 when the bus is available
 		
@@ -62,15 +66,19 @@ signal TL_nReset_test				: std_logic := '1';
 signal TL_MainClk_test				: std_logic := '0';
 signal TL_PixClk_test				: std_logic := '0';
 
-signal TL_AS_AB_Address_test		: std_logic_vector (3 DOWNTO 0) := "0000";
+signal TL_AS_AB_Address_test		: std_logic_vector (7 DOWNTO 0) := X"00";
 signal TL_AS_AB_ReadEnable_test		: std_logic := '0';
 signal TL_AS_AB_WriteEnable_test	: std_logic := '0';
 signal TL_AS_AB_ReadData_test		: std_logic_vector (7 DOWNTO 0);
 signal TL_AS_AB_WriteData_test		: std_logic_vector (7 DOWNTO 0) := X"00";
+signal TL_AS_IRQ_test				: std_logic;
 
 signal TL_AM_AB_MemoryAddress_test	: std_logic_vector (31 DOWNTO 0);
 signal TL_AM_AB_MemoryData_test		: std_logic_vector (31 DOWNTO 0);
 signal TL_AM_AB_WriteAccess_test	: std_logic;
+signal TL_AM_AB_ReadAccess_test		: std_logic;
+signal TL_AM_AB_ReadData_test		: std_logic_vector (31 DOWNTO 0) := X"00000000";
+signal TL_AM_AB_ReadDataValid_test	: std_logic := '0';
 signal TL_AM_AB_BurstCount_test		: std_logic_vector (7 DOWNTO 0);
 signal TL_AM_AB_WaitRequest_test	: std_logic := '0';
 
@@ -95,10 +103,14 @@ DUT : Top_Camera_Controller	-- Component to test as Device Under Test
 		TL_AS_AB_WriteEnable 	=> TL_AS_AB_WriteEnable_test,
 		TL_AS_AB_ReadData 		=> TL_AS_AB_ReadData_test,
 		TL_AS_AB_WriteData 		=> TL_AS_AB_WriteData_test,
+		TL_AS_IRQ				=> TL_AS_IRQ_test,
 
 		TL_AM_AB_MemoryAddress 	=> TL_AM_AB_MemoryAddress_test,
 		TL_AM_AB_MemoryData 	=> TL_AM_AB_MemoryData_test,
 		TL_AM_AB_WriteAccess 	=> TL_AM_AB_WriteAccess_test,
+		TL_AM_AB_ReadAccess 	=> TL_AM_AB_ReadAccess_test,
+		TL_AM_AB_ReadData 		=> TL_AM_AB_ReadData_test,
+		TL_AM_AB_ReadDataValid 	=> TL_AM_AB_ReadDataValid_test,
 		TL_AM_AB_BurstCount 	=> TL_AM_AB_BurstCount_test,
 		TL_AM_AB_WaitRequest 	=> TL_AM_AB_WaitRequest_test,
 
@@ -232,7 +244,7 @@ Process
 		
 		wait until rising_edge(TL_MainClk_test);	-- then reset everything
 		TL_AS_AB_WriteEnable_test <= '0';
-		TL_AS_AB_Address_test <= X"0";
+		TL_AS_AB_Address_test <= X"00";
 		TL_AS_AB_WriteData_test <= X"00";
 	end procedure write_register;
 
@@ -246,7 +258,7 @@ Process
 		wait until rising_edge(TL_MainClk_test);
 		wait until rising_edge(TL_MainClk_test);	-- then reset everything
 		TL_AS_AB_ReadEnable_test <= '0';
-		TL_AS_AB_Address_test <= X"0";
+		TL_AS_AB_Address_test <= X"00";
 	end procedure read_register;
 	
 Begin
@@ -254,43 +266,43 @@ Begin
 	toggle_reset;
 	
 	-- Writing start_adress = 0x10000000
-	write_register(X"1", X"00");
-	write_register(X"2", X"00");
-	write_register(X"3", X"00");
-	write_register(X"4", X"10");
+	write_register(X"01", X"00");
+	write_register(X"02", X"00");
+	write_register(X"03", X"00");
+	write_register(X"04", X"10");
 	
 	-- Writing AS_AM_Length = 320*240*2 = 0x00025800
-	write_register(X"5", X"00");
-	write_register(X"6", X"58");
-	write_register(X"7", X"02");
-	write_register(X"8", X"00");
+	write_register(X"05", X"00");
+	write_register(X"06", X"58");
+	write_register(X"07", X"02");
+	write_register(X"08", X"00");
 	
 	-- Writing AS_AMCI_Start information = 1
-	write_register(X"0", X"01");
+	write_register(X"00", X"01");
 	
 	-- Reading the registers
-	read_register(X"0");
-	read_register(X"1");
-	read_register(X"2");
-	read_register(X"3");
-	read_register(X"4");
-	read_register(X"5");
-	read_register(X"6");
-	read_register(X"7");
-	read_register(X"8");
-	read_register(X"9");
+	read_register(X"00");
+	read_register(X"01");
+	read_register(X"02");
+	read_register(X"03");
+	read_register(X"04");
+	read_register(X"05");
+	read_register(X"06");
+	read_register(X"07");
+	read_register(X"08");
+	read_register(X"09");
 	
 	wait for 620000*HalfPeriod_cam;
 	wait until rising_edge(TL_PixClk_test);
-	write_register(X"0", X"00");
+	write_register(X"00", X"00");
 	
 	wait for 50*HalfPeriod_cam;
 	wait until rising_edge(TL_PixClk_test);
-	write_register(X"0", X"01");
+	write_register(X"00", X"01");
 	
 	wait for 620000*HalfPeriod_cam;
 	wait until rising_edge(TL_PixClk_test);
-	read_register(X"9");
+	read_register(X"09");
 	
 	wait for 100*HalfPeriod;
 	TL_AM_AB_WaitRequest_test <= '1';
@@ -299,7 +311,7 @@ Begin
 	
 	wait for 620000*HalfPeriod_cam;
 	wait until rising_edge(TL_PixClk_test);
-	read_register(X"9");
+	read_register(X"09");
 	
 	wait;
 end process test;
@@ -316,14 +328,14 @@ end process test;
 		
 		-- wait until rising_edge(TL_MainClk_test);	-- then reset everything
 		-- TL_AS_AB_ReadEnable_test <= '0';
-		-- TL_AS_AB_Address_test <= X"0";
+		-- TL_AS_AB_Address_test <= X"00";
 	-- end procedure read_register;
 
 -- Begin
 	-- if not end_sim then
 		-- wait for 100000*HalfPeriod_cam;
 		-- wait until rising_edge(TL_PixClk_test);
-		-- read_register(X"1");
+		-- read_register(X"01");
 	-- else
 		-- wait;
 	-- end if;
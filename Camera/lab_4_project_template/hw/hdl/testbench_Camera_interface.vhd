@@ -45,6 +45,15 @@ component Camera_Interface is
 		
 		CI_AS_Start			: IN std_logic;							-- Start information
 		CI_AS_Pending		: OUT std_logic;						-- Pending information
+		CI_AS_Format		: IN std_logic_vector (7 DOWNTO 0);		-- Format of the output image (downscaling, pixel format)
+		CI_AS_ColorControl	: IN std_logic_vector (1 DOWNTO 0);		-- 1 = matrix enabled (bit 0), gamma enabled (bit 1)
+		CI_AS_Matrix		: IN std_logic_vector (143 DOWNTO 0);	-- Colour correction matrix, 9 coefficients of 16 bits
+		CI_AS_LutWrite		: IN std_logic;							-- 1 = write CI_AS_LutData in a gamma table
+		CI_AS_LutAddress	: IN std_logic_vector (9 DOWNTO 0);		-- Channel (9->8) and index (7->0) in the gamma tables
+		CI_AS_LutData		: IN std_logic_vector (11 DOWNTO 0);	-- Gamma table entry
+		
+		CI_AM_FrameCount	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera frames since the reset
+		CI_AM_DroppedLines	: OUT std_logic_vector (31 DOWNTO 0);	-- Number of camera lines not captured since the reset
 		
 		CI_FIFO_WriteEnable	: OUT std_logic;						-- 1 = write asked to the FIFO, 0 = no demand
 		CI_FIFO_WriteData	: OUT std_logic_vector (15 DOWNTO 0);	-- 16 bits pixel stored in the FIFO by the camera controller
@@ -63,6 +72,15 @@ signal CI_CA_LineValid_test		: std_logic := '0';
 
 signal CI_AS_Start_test			: std_logic := '0';
 signal CI_AS_Pending_test		: std_logic;
+signal CI_AS_Format_test		: std_logic_vector (7 DOWNTO 0) := X"00";
+signal CI_AS_ColorControl_test	: std_logic_vector (1 DOWNTO 0) := "00";
+signal CI_AS_Matrix_test		: std_logic_vector (143 DOWNTO 0) := X"0100" & X"0000" & X"0000" & X"0000" & X"0100" & X"0000" & X"0000" & X"0000" & X"0100";
+signal CI_AS_LutWrite_test		: std_logic := '0';
+signal CI_AS_LutAddress_test	: std_logic_vector (9 DOWNTO 0) := (others => '0');
+signal CI_AS_LutData_test		: std_logic_vector (11 DOWNTO 0) := (others => '0');
+
+signal CI_AM_FrameCount_test	: std_logic_vector (31 DOWNTO 0);
+signal CI_AM_DroppedLines_test	: std_logic_vector (31 DOWNTO 0);
 
 signal CI_FIFO_WriteEnable_test	: std_logic;
 signal CI_FIFO_WriteData_test	: std_logic_vector (15 DOWNTO 0);
@@ -86,6 +104,15 @@ DUT : Camera_Interface	-- Component to test as Device Under Test
 		
 		CI_AS_Start 		=> CI_AS_Start_test,
 		CI_AS_Pending		=> CI_AS_Pending_test,
+		CI_AS_Format		=> CI_AS_Format_test,
+		CI_AS_ColorControl	=> CI_AS_ColorControl_test,
+		CI_AS_Matrix		=> CI_AS_Matrix_test,
+		CI_AS_LutWrite		=> CI_AS_LutWrite_test,
+		CI_AS_LutAddress	=> CI_AS_LutAddress_test,
+		CI_AS_LutData		=> CI_AS_LutData_test,
+		
+		CI_AM_FrameCount	=> CI_AM_FrameCount_test,
+		CI_AM_DroppedLines	=> CI_AM_DroppedLines_test,
 		
 		CI_FIFO_WriteEnable => CI_FIFO_WriteEnable_test,
 		CI_FIFO_WriteData 	=> CI_FIFO_WriteData_test,
@@ -211,6 +238,17 @@ Begin
 	-- Toggling the reset
 	toggle_reset;
 	
+	-- Load linear gamma tables and enable the colour correction, the output stays the same in 5*6*5
+	loop_lut: FOR i IN 0 TO 767 LOOP
+		wait until rising_edge(CI_Clk_test);
+		CI_AS_LutAddress_test <= std_logic_vector(to_unsigned(i / 256, 2)) & std_logic_vector(to_unsigned(i mod 256, 8));
+		CI_AS_LutData_test <= std_logic_vector(to_unsigned(i mod 256, 8)) & "0000";
+		CI_AS_LutWrite_test <= '1';
+	END LOOP loop_lut;
+	wait until rising_edge(CI_Clk_test);
+	CI_AS_LutWrite_test <= '0';
+	CI_AS_ColorControl_test <= "11";
+	
 	-- Start the acquisition
 	wait until rising_edge(CI_Clk_test);
 	CI_AS_Start_test <= '1';
@@ -225,6 +263,24 @@ Begin
 	-- CI_AS_Start_test <= '1';
 	CI_FIFO_UsedWords_test <= "0000111110";
 	
+	-- Restart the acquisition with the bilinear demosaic and the ordered dither for the second image
+	wait for 300000*HalfPeriod_cam;
+	wait until rising_edge(CI_Clk_test);
+	CI_AS_Start_test <= '0';
+	CI_AS_Format_test <= X"50";
+	
+	wait until rising_edge(CI_Clk_test);
+	CI_AS_Start_test <= '1';
+	
+	-- Restart the acquisition in the 160*120 luminance format for the last image
+	wait for 300000*HalfPeriod_cam;
+	wait until rising_edge(CI_Clk_test);
+	CI_AS_Start_test <= '0';
+	CI_AS_Format_test <= X"05";
+	
+	wait until rising_edge(CI_Clk_test);
+	CI_AS_Start_test <= '1';
+	
 	wait;
 end process test;
 
@@ -0,0 +1,213 @@
+-- Testbench for the motion detector
+-- Motion detector unit
+--
+-- Authors : Nicolas Berling & Quentin François
+-- Date : ??.11.2016
+--
+-- 4 process :
+--	Process to generate the clock during the whole simulation
+--	Process to generate the pixel clock during the whole simulation
+--	Process to generate the frames of the camera
+--	Process to test the component
+--
+-- Tests done :
+--	The first frame after enabling the detector only loads the reference
+--	A frame identical to the reference gives no changed cell
+--	A bright square of 64*64 samples gives 64 changed cells and 4 changed blocks
+--	(blocks 20*7 + 7, 20*7 + 8, 20*8 + 7 and 20*8 + 8)
+--	With a fixed reference, the next frames are still compared with the square
+
+LIBRARY ieee;
+USE ieee.std_logic_1164.all;
+USE ieee.numeric_std.all;
+
+entity testbench is
+	-- Nothing as input/output
+end testbench;
+
+ARCHITECTURE bhv OF testbench IS
+-- The system to test under simulation
+component Motion_Detector is
+	PORT(
+		MD_nReset			: IN std_logic;							-- nReset input
+		MD_Clk				: IN std_logic;							-- clock input
+
+		MD_CA_PixClk		: IN std_logic;							-- pixel clock received from the camera
+		MD_CA_Data			: IN std_logic_vector (11 DOWNTO 0);	-- pixel sent by the camera
+		MD_CA_FrameValid	: IN std_logic;							-- 1 if the frame is valid
+		MD_CA_LineValid		: IN std_logic;							-- 1 if the line is valid
+
+		MD_AS_Control		: IN std_logic_vector (1 DOWNTO 0);		-- 1 = enabled (bit 0), reference updated with each frame (bit 1)
+		MD_AS_PixelThreshold: IN std_logic_vector (7 DOWNTO 0);		-- Difference above which a cell has changed
+		MD_AS_BlockThreshold: IN std_logic_vector (4 DOWNTO 0);		-- Number of changed cells above which a block has changed
+		MD_AS_Done			: OUT std_logic;						-- 1 during one clock when the results of a frame are available
+		MD_AS_ChangedCells	: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed cells in the last frame
+		MD_AS_ChangedBlocks	: OUT std_logic_vector (15 DOWNTO 0);	-- Number of changed blocks in the last frame
+		MD_AS_Bitmap		: OUT std_logic_vector (299 DOWNTO 0)	-- Changed blocks of the last frame, bit 20*row + column
+	);
+end component;
+
+-- The signals provided by the testbench :
+signal MD_nReset_test				: std_logic := '1';
+signal MD_Clk_test					: std_logic := '0';
+
+signal MD_CA_PixClk_test			: std_logic := '0';
+signal MD_CA_Data_test				: std_logic_vector (11 DOWNTO 0) := X"000";
+signal MD_CA_FrameValid_test		: std_logic := '0';
+signal MD_CA_LineValid_test			: std_logic := '0';
+
+signal MD_AS_Control_test			: std_logic_vector (1 DOWNTO 0) := "00";
+signal MD_AS_PixelThreshold_test	: std_logic_vector (7 DOWNTO 0) := X"10";
+signal MD_AS_BlockThreshold_test	: std_logic_vector (4 DOWNTO 0) := "00100";
+signal MD_AS_Done_test				: std_logic;
+signal MD_AS_ChangedCells_test		: std_logic_vector (15 DOWNTO 0);
+signal MD_AS_ChangedBlocks_test		: std_logic_vector (15 DOWNTO 0);
+signal MD_AS_Bitmap_test			: std_logic_vector (299 DOWNTO 0);
+
+signal end_sim	: boolean := false;
+
+constant HalfPeriod  : TIME := 10 ns;  -- clk_FPGA = 50 MHz -> T_FPGA = 20ns -> T/2 = 10 ns
+constant HalfPeriod_cam  : TIME := 26.7 ns;  -- clk_CAM = 18.73 MHz -> T_CAM = 53.4 ns -> T/2 = 26.7 ns
+
+BEGIN
+DUT : Motion_Detector	-- Component to test as Device Under Test
+	Port MAP(	-- from component => signal in the architecture
+		MD_nReset 			=> MD_nReset_test,
+		MD_Clk 				=> MD_Clk_test,
+
+		MD_CA_PixClk 		=> MD_CA_PixClk_test,
+		MD_CA_Data 			=> MD_CA_Data_test,
+		MD_CA_FrameValid 	=> MD_CA_FrameValid_test,
+		MD_CA_LineValid 	=> MD_CA_LineValid_test,
+
+		MD_AS_Control		=> MD_AS_Control_test,
+		MD_AS_PixelThreshold=> MD_AS_PixelThreshold_test,
+		MD_AS_BlockThreshold=> MD_AS_BlockThreshold_test,
+		MD_AS_Done			=> MD_AS_Done_test,
+		MD_AS_ChangedCells	=> MD_AS_ChangedCells_test,
+		MD_AS_ChangedBlocks	=> MD_AS_ChangedBlocks_test,
+		MD_AS_Bitmap		=> MD_AS_Bitmap_test
+	);
+
+-- Process to generate the clock during the whole simulation
+clk_process :
+Process
+Begin
+	if not end_sim then	-- generate the clock while simulation is running
+		MD_Clk_test <= '0';
+		wait for HalfPeriod;
+		MD_Clk_test <= '1';
+		wait for HalfPeriod;
+	else	-- when the simulation is ended, just wait
+		wait;
+	end if;
+end process clk_process;
+
+-- Process to generate the pixel clock during the whole simulation
+PixClk_process :
+Process
+Begin
+	if not end_sim then	-- generate the clock while simulation is running
+		MD_CA_PixClk_test <= '0';
+		wait for HalfPeriod_cam;
+		MD_CA_PixClk_test <= '1';
+		wait for HalfPeriod_cam;
+	else	-- when the simulation is ended, just wait
+		wait;
+	end if;
+end process PixClk_process;
+
+-- Process to generate 5 frames of 640*480 samples, the frame 3 holds a bright
+-- square of 64*64 samples at the rows and columns 224 to 287
+CamData :
+Process
+Begin
+	-- vertical blanking before the first frame
+	for i in 1 to 100 loop
+		wait until rising_edge(MD_CA_PixClk_test);
+	end loop;
+
+	loop_img: FOR img IN 1 TO 5 LOOP
+		MD_CA_FrameValid_test <= '1';
+		loop_row: FOR row IN 0 TO 479 LOOP
+			wait until rising_edge(MD_CA_PixClk_test);
+			MD_CA_LineValid_test <= '1';
+			loop_col: FOR col IN 0 TO 639 LOOP
+				if img = 3 AND row >= 224 AND row < 288 AND col >= 224 AND col < 288 then
+					MD_CA_Data_test <= X"F00";
+				else
+					MD_CA_Data_test <= std_logic_vector(to_unsigned(256 + 2*col, 12));
+				end if;
+				wait until rising_edge(MD_CA_PixClk_test);
+			END LOOP loop_col;
+			MD_CA_LineValid_test <= '0';
+
+			-- horizontal blanking
+			for i in 1 to 20 loop
+				wait until rising_edge(MD_CA_PixClk_test);
+			end loop;
+		END LOOP loop_row;
+		MD_CA_FrameValid_test <= '0';
+
+		-- vertical blanking
+		for i in 1 to 1000 loop
+			wait until rising_edge(MD_CA_PixClk_test);
+		end loop;
+	END LOOP loop_img;
+
+	-- Set end_sim to "true", so the clock generation stops
+	end_sim <= true;
+	wait;
+end process CamData;
+
+--	Process to test the component
+test :
+Process
+
+	-- Procedure to toggle the reset
+	Procedure toggle_reset is
+	Begin
+		wait until rising_edge(MD_Clk_test);
+		MD_nReset_test <= '0';
+
+		wait until rising_edge(MD_Clk_test);
+		MD_nReset_test <= '1';
+	end procedure toggle_reset;
+
+Begin
+	-- Toggling the reset
+	toggle_reset;
+
+	-- Enable the detector, the reference follows each frame
+	wait until rising_edge(MD_Clk_test);
+	MD_AS_Control_test <= "11";
+
+	-- Frame 2 is identical to frame 1: no changed cell
+	wait until rising_edge(MD_Clk_test) AND MD_AS_Done_test = '1';
+	wait until rising_edge(MD_Clk_test);
+	assert unsigned(MD_AS_ChangedCells_test) = 0 report "frame 2: changed cells" severity error;
+	assert unsigned(MD_AS_ChangedBlocks_test) = 0 report "frame 2: changed blocks" severity error;
+
+	-- Frame 3 holds the square: 8*8 changed cells in 2*2 blocks
+	wait until rising_edge(MD_Clk_test) AND MD_AS_Done_test = '1';
+	wait until rising_edge(MD_Clk_test);
+	assert unsigned(MD_AS_ChangedCells_test) = 64 report "frame 3: changed cells" severity error;
+	assert unsigned(MD_AS_ChangedBlocks_test) = 4 report "frame 3: changed blocks" severity error;
+	assert MD_AS_Bitmap_test (147) = '1' AND MD_AS_Bitmap_test (148) = '1' AND
+		MD_AS_Bitmap_test (167) = '1' AND MD_AS_Bitmap_test (168) = '1' report "frame 3: bitmap" severity error;
+
+	-- Keep the reference of frame 3, frame 4 without the square differs from it
+	MD_AS_Control_test <= "01";
+	wait until rising_edge(MD_Clk_test) AND MD_AS_Done_test = '1';
+	wait until rising_edge(MD_Clk_test);
+	assert unsigned(MD_AS_ChangedCells_test) = 64 report "frame 4: changed cells" severity error;
+
+	-- Frame 5 is still compared with frame 3
+	wait until rising_edge(MD_Clk_test) AND MD_AS_Done_test = '1';
+	wait until rising_edge(MD_Clk_test);
+	assert unsigned(MD_AS_ChangedCells_test) = 64 report "frame 5: changed cells" severity error;
+
+	wait;
+end process test;
+
+END bhv;
@@ -0,0 +1,212 @@
+package require -exact qsys 15.1
+
+
+#
+# module camera_controller
+#
+set_module_property DESCRIPTION "Writes the frames of a TRDB-D5M camera to a ring of buffers in memory, with motion detection"
+set_module_property NAME camera_controller
+set_module_property VERSION 2.7
+set_module_property INTERNAL false
+set_module_property OPAQUE_ADDRESS_MAP true
+set_module_property AUTHOR "Nicolas Berling & Quentin François"
+set_module_property DISPLAY_NAME camera_controller
+set_module_property INSTANTIATE_IN_SYSTEM_MODULE true
+set_module_property EDITABLE true
+set_module_property REPORT_TO_TALKBACK false
+set_module_property ALLOW_GREYBOX_GENERATION false
+set_module_property REPORT_HIERARCHY false
+
+
+#
+# file sets
+#
+add_fileset QUARTUS_SYNTH QUARTUS_SYNTH "" ""
+set_fileset_property QUARTUS_SYNTH TOP_LEVEL Top_Camera_Controller
+set_fileset_property QUARTUS_SYNTH ENABLE_RELATIVE_INCLUDE_PATHS false
+set_fileset_property QUARTUS_SYNTH ENABLE_FILE_OVERWRITE_MODE false
+add_fileset_file FIFO.vhd VHDL PATH ../../../hdl/FIFO.vhd
+add_fileset_file Camera_interface.vhd VHDL PATH ../../../hdl/Camera_interface.vhd
+add_fileset_file Motion_detector.vhd VHDL PATH ../../../hdl/Motion_detector.vhd
+add_fileset_file Avalon_slave.vhd VHDL PATH ../../../hdl/Avalon_slave.vhd
+add_fileset_file Avalon_master.vhd VHDL PATH ../../../hdl/Avalon_master.vhd
+add_fileset_file Camera_controller_top_level.vhd VHDL PATH ../../../hdl/Camera_controller_top_level.vhd TOP_LEVEL_FILE
+
+add_fileset SIM_VHDL SIM_VHDL "" ""
+set_fileset_property SIM_VHDL TOP_LEVEL Top_Camera_Controller
+set_fileset_property SIM_VHDL ENABLE_RELATIVE_INCLUDE_PATHS false
+set_fileset_property SIM_VHDL ENABLE_FILE_OVERWRITE_MODE true
+add_fileset_file FIFO.vhd VHDL PATH ../../../hdl/FIFO.vhd
+add_fileset_file Camera_interface.vhd VHDL PATH ../../../hdl/Camera_interface.vhd
+add_fileset_file Motion_detector.vhd VHDL PATH ../../../hdl/Motion_detector.vhd
+add_fileset_file Avalon_slave.vhd VHDL PATH ../../../hdl/Avalon_slave.vhd
+add_fileset_file Avalon_master.vhd VHDL PATH ../../../hdl/Avalon_master.vhd
+add_fileset_file Camera_controller_top_level.vhd VHDL PATH ../../../hdl/Camera_controller_top_level.vhd
+
+
+#
+# parameters
+#
+add_parameter FIFO_DEPTH_LOG2 NATURAL 10
+set_parameter_property FIFO_DEPTH_LOG2 DISPLAY_NAME "FIFO depth (log2)"
+set_parameter_property FIFO_DEPTH_LOG2 TYPE NATURAL
+set_parameter_property FIFO_DEPTH_LOG2 ALLOWED_RANGES {10:13}
+set_parameter_property FIFO_DEPTH_LOG2 DESCRIPTION "log2 of the depth of the pixel FIFO in 16-bit words (2 KB to 16 KB)"
+set_parameter_property FIFO_DEPTH_LOG2 HDL_PARAMETER true
+
+
+#
+# display items
+#
+
+
+#
+# connection point avalon_slave_0
+#
+add_interface avalon_slave_0 avalon end
+set_interface_property avalon_slave_0 addressUnits WORDS
+set_interface_property avalon_slave_0 associatedClock clock_sink
+set_interface_property avalon_slave_0 associatedReset reset_sink
+set_interface_property avalon_slave_0 bitsPerSymbol 8
+set_interface_property avalon_slave_0 burstOnBurstBoundariesOnly false
+set_interface_property avalon_slave_0 burstcountUnits WORDS
+set_interface_property avalon_slave_0 explicitAddressSpan 0
+set_interface_property avalon_slave_0 holdTime 0
+set_interface_property avalon_slave_0 linewrapBursts false
+set_interface_property avalon_slave_0 maximumPendingReadTransactions 0
+set_interface_property avalon_slave_0 maximumPendingWriteTransactions 0
+set_interface_property avalon_slave_0 readLatency 0
+set_interface_property avalon_slave_0 readWaitTime 1
+set_interface_property avalon_slave_0 setupTime 0
+set_interface_property avalon_slave_0 timingUnits Cycles
+set_interface_property avalon_slave_0 writeWaitTime 0
+set_interface_property avalon_slave_0 ENABLED true
+set_interface_property avalon_slave_0 EXPORT_OF ""
+set_interface_property avalon_slave_0 PORT_NAME_MAP ""
+set_interface_property avalon_slave_0 CMSIS_SVD_VARIABLES ""
+set_interface_property avalon_slave_0 SVD_ADDRESS_GROUP ""
+
+add_interface_port avalon_slave_0 TL_AS_AB_ReadEnable read Input 1
+add_interface_port avalon_slave_0 TL_AS_AB_WriteEnable write Input 1
+add_interface_port avalon_slave_0 TL_AS_AB_Address address Input 8
+add_interface_port avalon_slave_0 TL_AS_AB_ReadData readdata Output 8
+add_interface_port avalon_slave_0 TL_AS_AB_WriteData writedata Input 8
+set_interface_assignment avalon_slave_0 embeddedsw.configuration.isFlash 0
+set_interface_assignment avalon_slave_0 embeddedsw.configuration.isMemoryDevice 0
+set_interface_assignment avalon_slave_0 embeddedsw.configuration.isNonVolatileStorage 0
+set_interface_assignment avalon_slave_0 embeddedsw.configuration.isPrintableDevice 0
+
+
+#
+# connection point avalon_master
+#
+add_interface avalon_master avalon start
+set_interface_property avalon_master addressUnits SYMBOLS
+set_interface_property avalon_master associatedClock clock_sink
+set_interface_property avalon_master associatedReset reset_sink
+set_interface_property avalon_master bitsPerSymbol 8
+set_interface_property avalon_master burstOnBurstBoundariesOnly false
+set_interface_property avalon_master burstcountUnits WORDS
+set_interface_property avalon_master doStreamReads false
+set_interface_property avalon_master doStreamWrites false
+set_interface_property avalon_master holdTime 0
+set_interface_property avalon_master linewrapBursts false
+set_interface_property avalon_master maximumPendingReadTransactions 0
+set_interface_property avalon_master maximumPendingWriteTransactions 0
+set_interface_property avalon_master readLatency 0
+set_interface_property avalon_master readWaitTime 1
+set_interface_property avalon_master setupTime 0
+set_interface_property avalon_master timingUnits Cycles
+set_interface_property avalon_master writeWaitTime 0
+set_interface_property avalon_master ENABLED true
+set_interface_property avalon_master EXPORT_OF ""
+set_interface_property avalon_master PORT_NAME_MAP ""
+set_interface_property avalon_master CMSIS_SVD_VARIABLES ""
+set_interface_property avalon_master SVD_ADDRESS_GROUP ""
+
+add_interface_port avalon_master TL_AM_AB_BurstCount burstcount Output 8
+add_interface_port avalon_master TL_AM_AB_MemoryAddress address Output 32
+add_interface_port avalon_master TL_AM_AB_MemoryData writedata Output 32
+add_interface_port avalon_master TL_AM_AB_WaitRequest waitrequest Input 1
+add_interface_port avalon_master TL_AM_AB_WriteAccess write Output 1
+add_interface_port avalon_master TL_AM_AB_ReadAccess read Output 1
+add_interface_port avalon_master TL_AM_AB_ReadData readdata Input 32
+add_interface_port avalon_master TL_AM_AB_ReadDataValid readdatavalid Input 1
+
+
+#
+# connection point conduit_end
+#
+add_interface conduit_end conduit end
+set_interface_property conduit_end associatedClock ""
+set_interface_property conduit_end associatedReset ""
+set_interface_property conduit_end ENABLED true
+set_interface_property conduit_end EXPORT_OF ""
+set_interface_property conduit_end PORT_NAME_MAP ""
+set_interface_property conduit_end CMSIS_SVD_VARIABLES ""
+set_interface_property conduit_end SVD_ADDRESS_GROUP ""
+
+add_interface_port conduit_end TL_CI_CA_Data data Input 12
+add_interface_port conduit_end TL_CI_CA_FrameValid frame_valid Input 1
+add_interface_port conduit_end TL_CI_CA_LineValid line_valid Input 1
+
+
+#
+# connection point clock_sink
+#
+add_interface clock_sink clock end
+set_interface_property clock_sink clockRate 0
+set_interface_property clock_sink ENABLED true
+set_interface_property clock_sink EXPORT_OF ""
+set_interface_property clock_sink PORT_NAME_MAP ""
+set_interface_property clock_sink CMSIS_SVD_VARIABLES ""
+set_interface_property clock_sink SVD_ADDRESS_GROUP ""
+
+add_interface_port clock_sink TL_MainClk clk Input 1
+
+
+#
+# connection point clock_sink_1
+#
+add_interface clock_sink_1 clock end
+set_interface_property clock_sink_1 clockRate 0
+set_interface_property clock_sink_1 ENABLED true
+set_interface_property clock_sink_1 EXPORT_OF ""
+set_interface_property clock_sink_1 PORT_NAME_MAP ""
+set_interface_property clock_sink_1 CMSIS_SVD_VARIABLES ""
+set_interface_property clock_sink_1 SVD_ADDRESS_GROUP ""
+
+add_interface_port clock_sink_1 TL_PixClk clk Input 1
+
+
+#
+# connection point reset_sink
+#
+add_interface reset_sink reset end
+set_interface_property reset_sink associatedClock clock_sink
+set_interface_property reset_sink synchronousEdges DEASSERT
+set_interface_property reset_sink ENABLED true
+set_interface_property reset_sink EXPORT_OF ""
+set_interface_property reset_sink PORT_NAME_MAP ""
+set_interface_property reset_sink CMSIS_SVD_VARIABLES ""
+set_interface_property reset_sink SVD_ADDRESS_GROUP ""
+
+add_interface_port reset_sink TL_nReset reset_n Input 1
+
+
+#
+# connection point interrupt_sender (motion alarm)
+#
+add_interface interrupt_sender interrupt end
+set_interface_property interrupt_sender associatedAddressablePoint avalon_slave_0
+set_interface_property interrupt_sender associatedClock clock_sink
+set_interface_property interrupt_sender associatedReset reset_sink
+set_interface_property interrupt_sender bridgedReceiverOffset ""
+set_interface_property interrupt_sender bridgesToReceiver ""
+set_interface_property interrupt_sender ENABLED true
+set_interface_property interrupt_sender EXPORT_OF ""
+set_interface_property interrupt_sender PORT_NAME_MAP ""
+set_interface_property interrupt_sender CMSIS_SVD_VARIABLES ""
+set_interface_property interrupt_sender SVD_ADDRESS_GROUP ""
+
+add_interface_port interrupt_sender TL_AS_IRQ irq Output 1
@@ -0,0 +1,164 @@
+/*
+ * Host benchmark of alt_utoa() (camera_controller_bsp/HAL/src/alt_utoa.c)
+ * against the conversion by divisions of alt_log_printf and newlib.
+ *
+ * The Nios II of the system has no hardware divider (-mno-hw-div): each / or
+ * % is a call to the shift-subtract loop of libgcc (udivmodsi4), modelled
+ * here by soft_udivmod() so that the host division instruction does not hide
+ * the cost. The results are checked against snprintf.
+ *
+ * Build and run on the host, from sw/nios/application:
+ *   gcc -O2 -I../camera_controller_bsp/HAL/inc bench/utoa_bench.c \
+ *       ../camera_controller_bsp/HAL/src/alt_utoa.c -o utoa_bench && ./utoa_bench
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES()    __rdtsc()
+#define UNIT        "cycles"
+#else
+#define CYCLES()    ((uint64_t) clock() * (1000000000 / CLOCKS_PER_SEC))
+#define UNIT        "ns"
+#endif
+
+#include "sys/alt_stdio.h"
+
+#define COUNT       (1000000)
+
+/*
+ * soft_udivmod
+ *
+ * Division by shifts and subtractions, as libgcc does without divider.
+ */
+static uint32_t __attribute__ ((noinline)) soft_udivmod(uint32_t num, uint32_t den, uint32_t *mod) {
+    uint32_t bit = 1;
+    uint32_t res = 0;
+
+    while ((den < num) && (bit != 0) && ((den & (1UL << 31)) == 0)) {
+        den <<= 1;
+        bit <<= 1;
+    }
+    while (bit != 0) {
+        if (num >= den) {
+            num -= den;
+            res |= bit;
+        }
+        bit >>= 1;
+        den >>= 1;
+    }
+
+    *mod = num;
+    return res;
+}
+
+/*
+ * div_utoa
+ *
+ * Conversion by divisions by 10, a remainder and a quotient per digit.
+ */
+static int div_utoa(uint32_t value, char *buf) {
+    char digits[10];
+    uint32_t mod = 0;
+    int count = 0;
+    int i = 0;
+
+    /* value % 10 and value / 10 are two calls, __umodsi3 and __udivsi3 */
+    do {
+        soft_udivmod(value, 10, &mod);
+        digits[count++] = '0' + mod;
+        value = soft_udivmod(value, 10, &mod);
+    } while (value != 0);
+
+    for (i = 0; i < count; i++) {
+        buf[i] = digits[count - 1 - i];
+    }
+    buf[count] = '\0';
+
+    return count;
+}
+
+/*
+ * check
+ *
+ * Returns the number of values whose conversion differs from snprintf.
+ */
+static uint32_t check(uint32_t value) {
+    char expected[16];
+    char buf[16];
+    uint32_t errors = 0;
+
+    snprintf(expected, sizeof(expected), "%u", value);
+    if ((alt_utoa(value, buf) != (int) strlen(expected)) || (strcmp(buf, expected) != 0)) {
+        errors++;
+    }
+    if ((div_utoa(value, buf) != (int) strlen(expected)) || (strcmp(buf, expected) != 0)) {
+        errors++;
+    }
+
+    return errors;
+}
+
+/*
+ * bench
+ *
+ * Returns the average time of a conversion of the values.
+ */
+static double bench(int (*convert)(uint32_t, char *), const uint32_t *values) {
+    char buf[16];
+    volatile int sink = 0;
+    uint64_t start = 0;
+    uint32_t i = 0;
+
+    start = CYCLES();
+    for (i = 0; i < COUNT; i++) {
+        sink += convert(values[i], buf);
+    }
+
+    return (double) (CYCLES() - start) / COUNT;
+}
+
+static int alt_utoa_u32(uint32_t value, char *buf) {
+    return alt_utoa(value, buf);
+}
+
+static int snprintf_utoa(uint32_t value, char *buf) {
+    return snprintf(buf, 16, "%u", value);
+}
+
+int main(void) {
+    static uint32_t pixels[COUNT];
+    static uint32_t words[COUNT];
+    uint32_t errors = 0;
+    uint32_t value = 0;
+    uint32_t i = 0;
+
+    /* all the values of up to 6 digits, the powers of ten and the extremes */
+    for (value = 0; value < 1000000; value++) {
+        errors += check(value);
+    }
+    for (value = 1; value <= 1000000000; value *= 10) {
+        errors += check(value - 1) + check(value) + check(value + 1);
+    }
+    errors += check(UINT32_MAX) + check(UINT32_MAX - 1) + check(4000000000u) + check(3999999999u);
+
+    srand(1);
+    for (i = 0; i < COUNT; i++) {
+        pixels[i] = rand() & 0xFFFF;   /* the frame text export */
+        words[i] = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+        errors += check(words[i]);
+    }
+
+    printf("%u errors\n", errors);
+    printf("%-12s %12s %12s (%s per conversion)\n", "", "16-bit", "32-bit", UNIT);
+    printf("%-12s %12.1f %12.1f\n", "alt_utoa", bench(alt_utoa_u32, pixels), bench(alt_utoa_u32, words));
+    printf("%-12s %12.1f %12.1f\n", "divisions", bench(div_utoa, pixels), bench(div_utoa, words));
+    printf("%-12s %12.1f %12.1f\n", "snprintf", bench(snprintf_utoa, pixels), bench(snprintf_utoa, words));
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,854 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "sys/alt_irq.h"
+#endif
+
+#include "camera_controller.h"
+#include "camera_controller_regs.h"
+#include "../trace/trace.h"
+#include "../sections/sections.h"
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static void write_word_reg(camera_controller_dev *dev, uint32_t ofst, uint32_t value);
+static uint32_t read_word_reg(camera_controller_dev *dev, uint32_t ofst);
+static uint16_t read_half_reg(camera_controller_dev *dev, uint32_t ofst);
+static uint8_t next_ring_index(camera_controller_dev *dev, uint8_t index);
+static bool is_started(camera_controller_dev *dev);
+static bool is_descriptor_mode(camera_controller_dev *dev);
+static bool write_format_field(camera_controller_dev *dev, uint8_t msk, uint8_t ofst, uint8_t value);
+#ifdef __nios2_arch__
+static void motion_isr(void *context);
+#endif
+
+/*
+ * write_word_reg
+ *
+ * Writes a 32-bit value to the 4 consecutive 8-bit registers starting at ofst.
+ */
+static void write_word_reg(camera_controller_dev *dev, uint32_t ofst, uint32_t value) {
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(uint32_t); i++) {
+        CAMERA_CONTROLLER_WR_REG(dev->base, ofst + i, (value >> (8 * i)) & 0xFF);
+    }
+}
+
+/*
+ * read_word_reg
+ *
+ * Reads a 32-bit value from the 4 consecutive 8-bit registers starting at ofst.
+ */
+static uint32_t read_word_reg(camera_controller_dev *dev, uint32_t ofst) {
+    uint32_t i = 0;
+    uint32_t value = 0;
+
+    for (i = 0; i < sizeof(uint32_t); i++) {
+        value |= ((uint32_t) CAMERA_CONTROLLER_RD_REG(dev->base, ofst + i)) << (8 * i);
+    }
+
+    return value;
+}
+
+/*
+ * read_half_reg
+ *
+ * Reads a 16-bit value from the 2 consecutive 8-bit registers starting at ofst.
+ */
+static uint16_t read_half_reg(camera_controller_dev *dev, uint32_t ofst) {
+    return CAMERA_CONTROLLER_RD_REG(dev->base, ofst) | (CAMERA_CONTROLLER_RD_REG(dev->base, ofst + 1) << 8);
+}
+
+/*
+ * next_ring_index
+ *
+ * Returns the ring index (wrap bit included) following the supplied one.
+ */
+static uint8_t next_ring_index(camera_controller_dev *dev, uint8_t index) {
+    uint8_t buffer = index & CAMERA_CONTROLLER_RING_INDEX_MSK;
+    uint8_t wrap = index & CAMERA_CONTROLLER_RING_WRAP_MSK;
+
+    if (buffer + 1 >= dev->num_buffers) {
+        return wrap ^ CAMERA_CONTROLLER_RING_WRAP_MSK;
+    } else {
+        return wrap | (buffer + 1);
+    }
+}
+
+/*
+ * is_started
+ *
+ * Returns true if the acquisition is enabled, and false otherwise.
+ */
+static bool is_started(camera_controller_dev *dev) {
+    return (CAMERA_CONTROLLER_RD_START(dev->base) & CAMERA_CONTROLLER_START_START) != 0;
+}
+
+/*
+ * is_descriptor_mode
+ *
+ * Returns true if the buffers are described by a descriptor table, and false
+ * if they are evenly spaced by the stride.
+ */
+static bool is_descriptor_mode(camera_controller_dev *dev) {
+    return dev->desc_table != NULL;
+}
+
+/*
+ * write_format_field
+ *
+ * Replaces one field of the format register and updates the frame length,
+ * which the controller recomputes on every write of the format register. In
+ * an evenly spaced ring already configured, the new frame (and its trailer)
+ * must fit in the stride, otherwise the previous format is written back.
+ *
+ * Returns true if successful (controller stopped and frame fitting in the
+ * buffers), and false otherwise.
+ */
+static bool write_format_field(camera_controller_dev *dev, uint8_t msk, uint8_t ofst, uint8_t value) {
+    uint8_t previous = CAMERA_CONTROLLER_RD_FORMAT(dev->base);
+    uint8_t format = previous;
+    uint32_t length = 0;
+    uint32_t size = 0;
+
+    if (is_started(dev)) {
+        return false;
+    }
+
+    format &= ~msk;
+    format |= (value << ofst) & msk;
+    CAMERA_CONTROLLER_WR_FORMAT(dev->base, format);
+
+    length = camera_controller_frame_length(dev);
+    size = dev->trailer ? length + CAMERA_CONTROLLER_TRAILER_SIZE : length;
+    if (!is_descriptor_mode(dev) && (dev->stride != 0) && (size > dev->stride)) {
+        /* the controller recomputes the previous length as well */
+        CAMERA_CONTROLLER_WR_FORMAT(dev->base, previous);
+        return false;
+    }
+
+    dev->length = length;
+
+    return true;
+}
+
+#ifdef __nios2_arch__
+/*
+ * motion_isr
+ *
+ * Interrupt handler of the motion alarm, reading the results clears the
+ * interrupt and calls the callback of the device.
+ */
+static void ALT_HOT_TEXT motion_isr(void *context) {
+    camera_controller_motion motion;
+
+    TRACE_BEGIN(TRACE_ID_CAMERA_ISR);
+    camera_controller_motion_poll((camera_controller_dev *) context, &motion);
+    TRACE_END(TRACE_ID_CAMERA_ISR);
+}
+#endif
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * camera_controller_inst
+ *
+ * Constructs a device structure.
+ */
+camera_controller_dev camera_controller_inst(void *base) {
+    camera_controller_dev dev;
+
+    dev.base = base;
+    dev.start_address = 0;
+    dev.length = 0;
+    dev.stride = 0;
+    dev.num_buffers = 0;
+    dev.desc_table = NULL;
+    dev.trailer = false;
+    dev.desc_trailer_fits = false;
+    dev.motion_callback = NULL;
+    dev.motion_context = NULL;
+
+    return dev;
+}
+
+/*
+ * camera_controller_init
+ *
+ * Initializes the camera controller.
+ *
+ * This routine stops the acquisition and empties the ring of buffers.
+ */
+void camera_controller_init(camera_controller_dev *dev) {
+    camera_controller_stop(dev);
+
+    dev->num_buffers = CAMERA_CONTROLLER_RD_RING_SIZE(dev->base);
+    CAMERA_CONTROLLER_WR_RING_SIZE(dev->base, dev->num_buffers);
+}
+
+/*
+ * camera_controller_set_scale
+ *
+ * Selects the size of the output image. The controller sets the length of a
+ * frame accordingly, camera_controller_frame_length() returns it.
+ *
+ * Returns true if successful (controller stopped and frame fitting in the
+ * buffers of the ring), and false otherwise.
+ */
+bool camera_controller_set_scale(camera_controller_dev *dev, camera_controller_scale scale) {
+    if (scale > CAMERA_CONTROLLER_SCALE_80X60) {
+        return false;
+    }
+
+    return write_format_field(dev, CAMERA_CONTROLLER_FORMAT_SCALE_MSK, CAMERA_CONTROLLER_FORMAT_SCALE_OFST, scale);
+}
+
+/*
+ * camera_controller_set_pixel_format
+ *
+ * Selects the format of the pixels written in the buffers. The controller sets
+ * the length of a frame accordingly.
+ *
+ * Returns true if successful (controller stopped and frame fitting in the
+ * buffers of the ring), and false otherwise.
+ */
+bool camera_controller_set_pixel_format(camera_controller_dev *dev, camera_controller_pixel_format pixel_format) {
+    if (pixel_format > CAMERA_CONTROLLER_PIXEL_RAW8) {
+        return false;
+    }
+
+    return write_format_field(dev, CAMERA_CONTROLLER_FORMAT_PIXEL_MSK, CAMERA_CONTROLLER_FORMAT_PIXEL_OFST, pixel_format);
+}
+
+/*
+ * camera_controller_get_pixel_format
+ *
+ * Returns the format of the pixels written in the buffers.
+ */
+camera_controller_pixel_format camera_controller_get_pixel_format(camera_controller_dev *dev) {
+    uint8_t format = CAMERA_CONTROLLER_RD_FORMAT(dev->base);
+
+    return (camera_controller_pixel_format) ((format & CAMERA_CONTROLLER_FORMAT_PIXEL_MSK) >> CAMERA_CONTROLLER_FORMAT_PIXEL_OFST);
+}
+
+/*
+ * camera_controller_bytes_per_pixel
+ *
+ * Returns the number of bytes of one pixel in the current format.
+ */
+uint8_t camera_controller_bytes_per_pixel(camera_controller_dev *dev) {
+    switch (camera_controller_get_pixel_format(dev)) {
+    case CAMERA_CONTROLLER_PIXEL_Y8:
+    case CAMERA_CONTROLLER_PIXEL_RAW8:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+/*
+ * camera_controller_set_demosaic
+ *
+ * Selects how the Bayer samples are converted to RGB pixels. The controller
+ * sets the length of a frame accordingly.
+ *
+ * Returns true if successful (controller stopped and frame fitting in the
+ * buffers of the ring), and false otherwise.
+ */
+bool camera_controller_set_demosaic(camera_controller_dev *dev, camera_controller_demosaic demosaic) {
+    if (demosaic > CAMERA_CONTROLLER_DEMOSAIC_BILINEAR) {
+        return false;
+    }
+
+    return write_format_field(dev, CAMERA_CONTROLLER_FORMAT_DEMOSAIC_MSK, CAMERA_CONTROLLER_FORMAT_DEMOSAIC_OFST, demosaic);
+}
+
+/*
+ * camera_controller_set_reduction
+ *
+ * Selects how the channels are reduced to 5/6/5 bits in the RGB565 format.
+ * The other formats are not affected.
+ *
+ * Returns true if successful (controller stopped), and false otherwise.
+ */
+bool camera_controller_set_reduction(camera_controller_dev *dev, camera_controller_reduction reduction) {
+    if (reduction > CAMERA_CONTROLLER_REDUCTION_DITHER) {
+        return false;
+    }
+
+    return write_format_field(dev, CAMERA_CONTROLLER_FORMAT_REDUCTION_MSK, CAMERA_CONTROLLER_FORMAT_REDUCTION_OFST, reduction);
+}
+
+/*
+ * camera_controller_set_color_matrix
+ *
+ * Loads the 3x3 colour correction matrix, given row major (RR RG RB GR GG GB
+ * BR BG BB). The coefficients are signed with 8 fractional bits, so
+ * CAMERA_CONTROLLER_COLOR_MATRIX_ONE is 1.0.
+ *
+ * Returns true if successful (controller stopped), and false otherwise.
+ */
+bool camera_controller_set_color_matrix(camera_controller_dev *dev, const int16_t *matrix) {
+    uint32_t i = 0;
+    uint32_t ofst = CAMERA_CONTROLLER_COLOR_MATRIX_OFST;
+
+    if (is_started(dev)) {
+        return false;
+    }
+
+    for (i = 0; i < CAMERA_CONTROLLER_COLOR_MATRIX_SIZE; i++) {
+        CAMERA_CONTROLLER_WR_REG(dev->base, ofst, ((uint16_t) matrix[i]) & 0xFF);
+        CAMERA_CONTROLLER_WR_REG(dev->base, ofst + 1, ((uint16_t) matrix[i]) >> 8);
+        ofst += sizeof(int16_t);
+    }
+
+    return true;
+}
+
+/*
+ * camera_controller_set_gamma_table
+ *
+ * Loads the CAMERA_CONTROLLER_GAMMA_TABLE_SIZE entries of the gamma table of
+ * one channel. Entry i gives the 12-bit output value of the input values whose
+ * 8 most significant bits are i.
+ *
+ * Returns true if successful (controller stopped), and false otherwise.
+ */
+bool camera_controller_set_gamma_table(camera_controller_dev *dev, camera_controller_channel channel, const uint16_t *table) {
+    uint32_t i = 0;
+
+    if (is_started(dev) || (channel > CAMERA_CONTROLLER_CHANNEL_BLUE)) {
+        return false;
+    }
+
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_GAMMA_CHANNEL_OFST, channel);
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_GAMMA_INDEX_OFST, 0);
+
+    /* the index is incremented by the controller after each entry */
+    for (i = 0; i < CAMERA_CONTROLLER_GAMMA_TABLE_SIZE; i++) {
+        CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_GAMMA_DATA_LOW_OFST, table[i] & 0xFF);
+        CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_GAMMA_DATA_HIGH_OFST, (table[i] >> 8) & CAMERA_CONTROLLER_GAMMA_DATA_HIGH_MSK);
+    }
+
+    return true;
+}
+
+/*
+ * camera_controller_enable_color_correction
+ *
+ * Enables or bypasses the colour correction matrix and the gamma tables.
+ *
+ * Returns true if successful (controller stopped), and false otherwise.
+ */
+bool camera_controller_enable_color_correction(camera_controller_dev *dev, bool matrix, bool gamma) {
+    uint8_t control = 0;
+
+    if (is_started(dev)) {
+        return false;
+    }
+
+    if (matrix) {
+        control |= CAMERA_CONTROLLER_COLOR_CONTROL_MATRIX_MSK;
+    }
+    if (gamma) {
+        control |= CAMERA_CONTROLLER_COLOR_CONTROL_GAMMA_MSK;
+    }
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_COLOR_CONTROL_OFST, control);
+
+    return true;
+}
+
+/*
+ * camera_controller_bandwidth
+ *
+ * Returns the number of bytes per second written to the memory by the
+ * controller at the given frame rate in the current format.
+ */
+uint32_t camera_controller_bandwidth(camera_controller_dev *dev, uint32_t frames_per_second) {
+    return camera_controller_frame_length(dev) * frames_per_second;
+}
+
+/*
+ * camera_controller_max_frame_rate
+ *
+ * Returns the highest frame rate whose bandwidth in the current format fits
+ * in the given number of bytes per second, so the firmware can pick a frame
+ * rate the memory can sustain.
+ */
+uint32_t camera_controller_max_frame_rate(camera_controller_dev *dev, uint32_t bytes_per_second) {
+    uint32_t length = camera_controller_frame_length(dev);
+
+    if (length == 0) {
+        return 0;
+    }
+
+    return bytes_per_second / length;
+}
+
+/*
+ * camera_controller_frame_length
+ *
+ * Returns the number of bytes of one frame in the current format.
+ */
+uint32_t camera_controller_frame_length(camera_controller_dev *dev) {
+    return read_word_reg(dev, CAMERA_CONTROLLER_LENGTH_OFST);
+}
+
+/*
+ * camera_controller_frame_width
+ *
+ * Returns the number of pixels of one line in the current format.
+ */
+uint16_t camera_controller_frame_width(camera_controller_dev *dev) {
+    uint8_t format = CAMERA_CONTROLLER_RD_FORMAT(dev->base);
+    uint8_t scale = (format & CAMERA_CONTROLLER_FORMAT_SCALE_MSK) >> CAMERA_CONTROLLER_FORMAT_SCALE_OFST;
+
+    if ((camera_controller_get_pixel_format(dev) >= CAMERA_CONTROLLER_PIXEL_RAW12) || (format & CAMERA_CONTROLLER_FORMAT_DEMOSAIC_MSK)) {
+        return 640;
+    }
+
+    return 320 >> scale;
+}
+
+/*
+ * camera_controller_frame_height
+ *
+ * Returns the number of lines of one frame in the current format.
+ */
+uint16_t camera_controller_frame_height(camera_controller_dev *dev) {
+    uint8_t format = CAMERA_CONTROLLER_RD_FORMAT(dev->base);
+    uint8_t scale = (format & CAMERA_CONTROLLER_FORMAT_SCALE_MSK) >> CAMERA_CONTROLLER_FORMAT_SCALE_OFST;
+
+    if ((camera_controller_get_pixel_format(dev) >= CAMERA_CONTROLLER_PIXEL_RAW12) || (format & CAMERA_CONTROLLER_FORMAT_DEMOSAIC_MSK)) {
+        return 480;
+    }
+
+    return 240 >> scale;
+}
+
+/*
+ * camera_controller_configure
+ *
+ * Configures the ring of buffers. Buffer k starts at start_address + k * stride
+ * and receives length bytes per frame, plus CAMERA_CONTROLLER_TRAILER_SIZE
+ * bytes when the trailer is enabled. length must be a non-zero multiple of 64
+ * bytes (the bursts of the controller), otherwise the controller never ends a
+ * frame.
+ *
+ * Returns true if successful (values within bounds and controller stopped),
+ * and false otherwise.
+ */
+bool camera_controller_configure(camera_controller_dev *dev, uint32_t start_address, uint32_t length, uint32_t stride, uint8_t num_buffers) {
+    uint32_t size = dev->trailer ? length + CAMERA_CONTROLLER_TRAILER_SIZE : length;
+    bool valid = (length != 0) && (length % 64 == 0) && (num_buffers >= 1) && (num_buffers <= CAMERA_CONTROLLER_RING_SIZE_MAX) &&
+                 (size <= stride) && !is_started(dev);
+
+    if (!valid) {
+        return false;
+    }
+
+    write_word_reg(dev, CAMERA_CONTROLLER_START_ADDRESS_OFST, start_address);
+    write_word_reg(dev, CAMERA_CONTROLLER_LENGTH_OFST, length);
+    write_word_reg(dev, CAMERA_CONTROLLER_RING_STRIDE_OFST, stride);
+    CAMERA_CONTROLLER_WR_RING_SIZE(dev->base, num_buffers);
+
+    dev->start_address = start_address;
+    dev->length = length;
+    dev->stride = stride;
+    dev->num_buffers = num_buffers;
+    dev->desc_table = NULL;
+
+    return true;
+}
+
+/*
+ * camera_controller_configure_descriptors
+ *
+ * Configures the ring of buffers from a table of descriptors, which lets every
+ * buffer live anywhere in memory and have its own length. desc_table is the
+ * table as seen by the CPU and desc_table_address the same table as seen by the
+ * controller. It must hold num_buffers * CAMERA_CONTROLLER_DESC_SIZE bytes and
+ * stay allocated while the acquisition runs. The size of every buffer must
+ * cover its length, plus CAMERA_CONTROLLER_TRAILER_SIZE bytes when the trailer
+ * is enabled.
+ *
+ * Returns true if successful (values within bounds and controller stopped),
+ * and false otherwise.
+ */
+bool camera_controller_configure_descriptors(camera_controller_dev *dev, void *desc_table, uint32_t desc_table_address, const camera_controller_buffer *buffers, uint8_t num_buffers) {
+    uint8_t i = 0;
+    bool trailer_fits = true;
+    bool valid = (desc_table != NULL) && (num_buffers >= 1) && (num_buffers <= CAMERA_CONTROLLER_RING_SIZE_MAX) && !is_started(dev);
+
+    if (!valid) {
+        return false;
+    }
+
+    for (i = 0; i < num_buffers; i++) {
+        if ((buffers[i].length == 0) || (buffers[i].length % 64 != 0) || (buffers[i].size < buffers[i].length)) {
+            return false;
+        }
+        if (buffers[i].size - buffers[i].length < CAMERA_CONTROLLER_TRAILER_SIZE) {
+            trailer_fits = false;
+        }
+    }
+
+    if (dev->trailer && !trailer_fits) {
+        return false;
+    }
+
+    for (i = 0; i < num_buffers; i++) {
+        CAMERA_CONTROLLER_WR_DESC(desc_table, i, CAMERA_CONTROLLER_DESC_ADDRESS_OFST, buffers[i].address);
+        CAMERA_CONTROLLER_WR_DESC(desc_table, i, CAMERA_CONTROLLER_DESC_LENGTH_OFST, buffers[i].length);
+        CAMERA_CONTROLLER_WR_DESC(desc_table, i, CAMERA_CONTROLLER_DESC_FLAGS_OFST, buffers[i].id & CAMERA_CONTROLLER_DESC_FLAGS_ID_MSK);
+        CAMERA_CONTROLLER_WR_DESC(desc_table, i, CAMERA_CONTROLLER_DESC_STATUS_OFST, 0);
+    }
+
+    write_word_reg(dev, CAMERA_CONTROLLER_START_ADDRESS_OFST, desc_table_address);
+    CAMERA_CONTROLLER_WR_RING_SIZE(dev->base, num_buffers);
+
+    dev->start_address = desc_table_address;
+    dev->length = 0;
+    dev->stride = CAMERA_CONTROLLER_DESC_SIZE;
+    dev->num_buffers = num_buffers;
+    dev->desc_table = desc_table;
+    dev->desc_trailer_fits = trailer_fits;
+
+    return true;
+}
+
+/*
+ * camera_controller_enable_trailer
+ *
+ * Enables or disables the trailer written by the controller right after each
+ * frame. Every buffer must then hold CAMERA_CONTROLLER_TRAILER_SIZE more bytes
+ * than a frame, which is checked against the stride of an evenly spaced ring
+ * or the size of each buffer of a descriptor table. The ring must be
+ * configured first, even for a single buffer.
+ *
+ * Returns true if successful (ring configured, buffers large enough and
+ * controller stopped), and false otherwise.
+ */
+bool camera_controller_enable_trailer(camera_controller_dev *dev, bool enable) {
+    bool fits = false;
+
+    if (is_started(dev)) {
+        return false;
+    }
+
+    if (is_descriptor_mode(dev)) {
+        fits = dev->desc_trailer_fits;
+    } else {
+        fits = (dev->stride != 0) && (dev->length + CAMERA_CONTROLLER_TRAILER_SIZE <= dev->stride);
+    }
+
+    if (enable && !fits) {
+        return false;
+    }
+
+    dev->trailer = enable;
+
+    return true;
+}
+
+/*
+ * camera_controller_start
+ *
+ * Starts the acquisition.
+ *
+ * You must previously configure the controller by calling
+ * camera_controller_configure() before calling this function.
+ */
+void camera_controller_start(camera_controller_dev *dev) {
+    uint8_t start = CAMERA_CONTROLLER_START_START;
+
+    if (is_descriptor_mode(dev)) {
+        start |= CAMERA_CONTROLLER_START_DESCRIPTOR_MSK;
+    }
+    if (dev->trailer) {
+        start |= CAMERA_CONTROLLER_START_TRAILER_MSK;
+    }
+
+    CAMERA_CONTROLLER_WR_START(dev->base, start);
+}
+
+/*
+ * camera_controller_stop
+ *
+ * Stops the acquisition. The frames already in the ring stay available.
+ */
+void camera_controller_stop(camera_controller_dev *dev) {
+    CAMERA_CONTROLLER_WR_START(dev->base, CAMERA_CONTROLLER_START_STOP);
+}
+
+/*
+ * camera_controller_frames_ready
+ *
+ * Returns the number of complete frames owned by the firmware.
+ */
+uint8_t ALT_HOT_TEXT camera_controller_frames_ready(camera_controller_dev *dev) {
+    uint8_t head = CAMERA_CONTROLLER_RD_RING_HEAD(dev->base);
+    uint8_t tail = CAMERA_CONTROLLER_RD_RING_TAIL(dev->base);
+    uint8_t head_index = head & CAMERA_CONTROLLER_RING_INDEX_MSK;
+    uint8_t tail_index = tail & CAMERA_CONTROLLER_RING_INDEX_MSK;
+
+    if ((head & CAMERA_CONTROLLER_RING_WRAP_MSK) == (tail & CAMERA_CONTROLLER_RING_WRAP_MSK)) {
+        return head_index - tail_index;
+    } else {
+        return dev->num_buffers - tail_index + head_index;
+    }
+}
+
+/*
+ * camera_controller_get_frame
+ *
+ * Gets the address of the oldest complete frame, without releasing it.
+ *
+ * Returns true if a frame is available, and false otherwise.
+ */
+bool ALT_HOT_TEXT camera_controller_get_frame(camera_controller_dev *dev, uint32_t *address) {
+    uint8_t tail = CAMERA_CONTROLLER_RD_RING_TAIL(dev->base) & CAMERA_CONTROLLER_RING_INDEX_MSK;
+
+    if (camera_controller_frames_ready(dev) == 0) {
+        return false;
+    }
+
+    if (is_descriptor_mode(dev)) {
+        *address = CAMERA_CONTROLLER_RD_DESC(dev->desc_table, tail, CAMERA_CONTROLLER_DESC_ADDRESS_OFST);
+    } else {
+        *address = dev->start_address + tail * dev->stride;
+    }
+    return true;
+}
+
+/*
+ * camera_controller_get_buffer
+ *
+ * Gets the oldest complete buffer (address, number of bytes written and
+ * identifier), without releasing it. In descriptor mode, the values come from
+ * the descriptor and its status written back by the controller, and the size
+ * is the part of the buffer known to be reserved.
+ *
+ * Returns true if a frame is available, and false otherwise.
+ */
+bool camera_controller_get_buffer(camera_controller_dev *dev, camera_controller_buffer *buffer) {
+    uint8_t tail = CAMERA_CONTROLLER_RD_RING_TAIL(dev->base) & CAMERA_CONTROLLER_RING_INDEX_MSK;
+    uint32_t status = 0;
+
+    if (!camera_controller_get_frame(dev, &buffer->address)) {
+        return false;
+    }
+
+    if (is_descriptor_mode(dev)) {
+        status = CAMERA_CONTROLLER_RD_DESC(dev->desc_table, tail, CAMERA_CONTROLLER_DESC_STATUS_OFST);
+        buffer->length = CAMERA_CONTROLLER_RD_DESC(dev->desc_table, tail, CAMERA_CONTROLLER_DESC_LENGTH_OFST);
+        buffer->size = dev->desc_trailer_fits ? buffer->length + CAMERA_CONTROLLER_TRAILER_SIZE : buffer->length;
+        buffer->id = (status & CAMERA_CONTROLLER_DESC_STATUS_ID_MSK) >> CAMERA_CONTROLLER_DESC_STATUS_ID_SHFT;
+    } else {
+        buffer->length = dev->length;
+        buffer->size = dev->stride;
+        buffer->id = tail;
+    }
+    return true;
+}
+
+/*
+ * camera_controller_get_trailer
+ *
+ * Reads the trailer of the oldest complete frame, without releasing it. frame
+ * is the buffer as seen by the CPU (the address returned by
+ * camera_controller_get_frame() may differ when the memory is reached through
+ * a bridge).
+ *
+ * Returns true if a frame is available and its trailer is valid, and false
+ * otherwise (no frame, trailer disabled or overwritten).
+ */
+bool camera_controller_get_trailer(camera_controller_dev *dev, const void *frame, camera_controller_trailer *trailer) {
+    camera_controller_buffer buffer;
+    uint32_t info = 0;
+
+    if (!dev->trailer || !camera_controller_get_buffer(dev, &buffer)) {
+        return false;
+    }
+
+    info = CAMERA_CONTROLLER_RD_TRAILER(frame, buffer.length, CAMERA_CONTROLLER_TRAILER_INFO_OFST);
+    if ((info & CAMERA_CONTROLLER_TRAILER_INFO_MAGIC_MSK) >> CAMERA_CONTROLLER_TRAILER_INFO_MAGIC_SHFT != CAMERA_CONTROLLER_TRAILER_MAGIC) {
+        return false;
+    }
+
+    trailer->frame = CAMERA_CONTROLLER_RD_TRAILER(frame, buffer.length, CAMERA_CONTROLLER_TRAILER_FRAME_OFST);
+    trailer->timestamp = CAMERA_CONTROLLER_RD_TRAILER(frame, buffer.length, CAMERA_CONTROLLER_TRAILER_TIMESTAMP_OFST);
+    trailer->dropped_lines = CAMERA_CONTROLLER_RD_TRAILER(frame, buffer.length, CAMERA_CONTROLLER_TRAILER_DROPPED_OFST);
+    trailer->format = info & CAMERA_CONTROLLER_TRAILER_INFO_FORMAT_MSK;
+    trailer->id = (info & CAMERA_CONTROLLER_TRAILER_INFO_ID_MSK) >> CAMERA_CONTROLLER_TRAILER_INFO_ID_SHFT;
+
+    return true;
+}
+
+/*
+ * camera_controller_get_crc
+ *
+ * Gets the CRC-32 of the oldest complete frame, computed by the controller on
+ * the words it wrote (the trailer excluded), without releasing it. It equals
+ * camera_controller_crc32(CAMERA_CONTROLLER_CRC_INIT, frame, length) when the
+ * frame in memory is intact.
+ *
+ * Returns true if a frame is available, and false otherwise.
+ */
+bool camera_controller_get_crc(camera_controller_dev *dev, uint32_t *crc) {
+    if (camera_controller_frames_ready(dev) == 0) {
+        return false;
+    }
+
+    *crc = read_word_reg(dev, CAMERA_CONTROLLER_FRAME_CRC_OFST);
+    return true;
+}
+
+/*
+ * camera_controller_release_frame
+ *
+ * Gives the oldest complete frame back to the controller, which restarts the
+ * acquisition if it was stopped because the ring was full.
+ */
+void ALT_HOT_TEXT camera_controller_release_frame(camera_controller_dev *dev) {
+    uint8_t tail = CAMERA_CONTROLLER_RD_RING_TAIL(dev->base);
+
+    if (camera_controller_frames_ready(dev) != 0) {
+        if (is_descriptor_mode(dev)) {
+            CAMERA_CONTROLLER_WR_DESC(dev->desc_table, tail & CAMERA_CONTROLLER_RING_INDEX_MSK, CAMERA_CONTROLLER_DESC_STATUS_OFST, 0);
+        }
+        CAMERA_CONTROLLER_WR_RING_TAIL(dev->base, next_ring_index(dev, tail));
+    }
+}
+
+/*
+ * camera_controller_motion_configure
+ *
+ * Sets the thresholds of the motion detection: a cell has changed when its
+ * luminance (8 bits) moved by more than pixel_threshold, a block has changed
+ * when more than block_threshold of its 16 cells have changed, and the alarm
+ * is raised when more than alarm_threshold cells have changed in a frame.
+ *
+ * The detector runs on the camera stream whether the acquisition is started
+ * or not, so the thresholds can be changed at any time.
+ *
+ * Returns true if successful (values within bounds), and false otherwise.
+ */
+bool camera_controller_motion_configure(camera_controller_dev *dev, uint8_t pixel_threshold, uint8_t block_threshold, uint16_t alarm_threshold) {
+    if (block_threshold > CAMERA_CONTROLLER_MOTION_BLOCK_MAX) {
+        return false;
+    }
+
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_PIXEL_OFST, pixel_threshold);
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_BLOCK_OFST, block_threshold);
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_ALARM_OFST, alarm_threshold & 0xFF);
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_ALARM_OFST + 1, alarm_threshold >> 8);
+
+    return true;
+}
+
+/*
+ * camera_controller_motion_enable
+ *
+ * Enables or disables the motion detection. The first frame after enabling it
+ * only loads the reference. When update_reference is true, the reference is
+ * replaced by each frame (motion between consecutive frames), otherwise it
+ * keeps the first frame (changes from a fixed background).
+ */
+void camera_controller_motion_enable(camera_controller_dev *dev, bool enable, bool update_reference) {
+    uint8_t control = CAMERA_CONTROLLER_RD_REG(dev->base, CAMERA_CONTROLLER_MOTION_CONTROL_OFST);
+
+    control &= CAMERA_CONTROLLER_MOTION_IRQ_MSK;
+    if (enable) {
+        control |= CAMERA_CONTROLLER_MOTION_ENABLE_MSK;
+    }
+    if (update_reference) {
+        control |= CAMERA_CONTROLLER_MOTION_UPDATE_MSK;
+    }
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_CONTROL_OFST, control);
+}
+
+/*
+ * camera_controller_motion_set_callback
+ *
+ * Sets the function called by camera_controller_motion_poll() when the results
+ * of a frame raise the alarm. context is given back to the function. With the
+ * interrupt registered, the function runs in the interrupt handler.
+ */
+void camera_controller_motion_set_callback(camera_controller_dev *dev, camera_controller_motion_callback callback, void *context) {
+    dev->motion_callback = callback;
+    dev->motion_context = context;
+}
+
+/*
+ * camera_controller_motion_poll
+ *
+ * Reads the results of the last frame if they were not read yet, and clears
+ * the alarm. The callback is called if the results raise the alarm. The
+ * results stay stable during the whole next frame.
+ *
+ * Returns true if new results were read, and false otherwise.
+ */
+bool ALT_HOT_TEXT camera_controller_motion_poll(camera_controller_dev *dev, camera_controller_motion *motion) {
+    uint8_t status = CAMERA_CONTROLLER_RD_REG(dev->base, CAMERA_CONTROLLER_MOTION_STATUS_OFST);
+    uint32_t i = 0;
+
+    if ((status & CAMERA_CONTROLLER_MOTION_RESULT_MSK) == 0) {
+        return false;
+    }
+
+    motion->changed_cells = read_half_reg(dev, CAMERA_CONTROLLER_MOTION_CELLS_OFST);
+    motion->changed_blocks = read_half_reg(dev, CAMERA_CONTROLLER_MOTION_BLOCKS_OFST);
+    motion->alarm = (status & CAMERA_CONTROLLER_MOTION_ALARM_MSK) != 0;
+    for (i = 0; i < CAMERA_CONTROLLER_MOTION_BITMAP_SIZE; i++) {
+        motion->bitmap[i] = CAMERA_CONTROLLER_RD_REG(dev->base, CAMERA_CONTROLLER_MOTION_BITMAP_OFST + i);
+    }
+
+    /* only the bits read are cleared, results of a new frame are not lost */
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_STATUS_OFST, status & (CAMERA_CONTROLLER_MOTION_RESULT_MSK | CAMERA_CONTROLLER_MOTION_ALARM_MSK));
+
+    if (motion->alarm && (dev->motion_callback != NULL)) {
+        dev->motion_callback(dev, motion, dev->motion_context);
+    }
+
+    return true;
+}
+
+#ifdef __nios2_arch__
+/*
+ * camera_controller_motion_register_irq
+ *
+ * Registers the interrupt handler of the motion alarm and enables the
+ * interrupt, so the callback runs as soon as a frame raises the alarm instead
+ * of waiting for camera_controller_motion_poll(). Use the
+ * <prefix>_IRQ_INTERRUPT_CONTROLLER_ID and <prefix>_IRQ values of system.h.
+ *
+ * Returns true if successful, and false otherwise (interrupt sender not
+ * connected, irq < 0).
+ */
+bool camera_controller_motion_register_irq(camera_controller_dev *dev, int ic_id, int irq) {
+    uint8_t control = 0;
+
+    if ((irq < 0) || (ic_id < 0)) {
+        return false;
+    }
+
+    if (alt_ic_isr_register(ic_id, irq, motion_isr, dev, NULL) != 0) {
+        return false;
+    }
+
+    control = CAMERA_CONTROLLER_RD_REG(dev->base, CAMERA_CONTROLLER_MOTION_CONTROL_OFST);
+    CAMERA_CONTROLLER_WR_REG(dev->base, CAMERA_CONTROLLER_MOTION_CONTROL_OFST, control | CAMERA_CONTROLLER_MOTION_IRQ_MSK);
+
+    return true;
+}
+#endif
@@ -0,0 +1,185 @@
+#ifndef __CAMERA_CONTROLLER_H__
+#define __CAMERA_CONTROLLER_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+struct camera_controller_dev;
+struct camera_controller_motion;
+
+/*
+ * Function called by camera_controller_motion_poll() when the results of a
+ * frame raise the motion alarm, possibly from the interrupt handler
+ */
+typedef void (*camera_controller_motion_callback)(struct camera_controller_dev *dev, const struct camera_controller_motion *motion, void *context);
+
+/* camera_controller device structure */
+typedef struct camera_controller_dev {
+    void     *base;          /* Base address of component */
+    uint32_t start_address;  /* Address of the first buffer of the ring */
+    uint32_t length;         /* Number of bytes written in each buffer */
+    uint32_t stride;         /* Distance between two consecutive buffers */
+    uint8_t  num_buffers;    /* Number of buffers in the ring */
+    void     *desc_table;    /* Descriptor table as seen by the CPU, NULL if not in descriptor mode */
+    bool     trailer;        /* True if a trailer is written after each frame */
+    bool     desc_trailer_fits; /* True if every descriptor buffer has room for a trailer */
+    camera_controller_motion_callback motion_callback; /* Called on a motion alarm, NULL if none */
+    void     *motion_context; /* Argument given to motion_callback */
+} camera_controller_dev;
+
+/* Downscaling of the 320x240 binned image */
+typedef enum camera_controller_scale {
+    CAMERA_CONTROLLER_SCALE_320X240 = 0,
+    CAMERA_CONTROLLER_SCALE_160X120 = 1,
+    CAMERA_CONTROLLER_SCALE_80X60   = 2
+} camera_controller_scale;
+
+/*
+ * Format of the pixels in the buffers
+ *
+ * RGB565: 16 bits per pixel, 2 pixels per 32-bit word, first pixel in the low half
+ * Y8: 8-bit luminance, 4 pixels per 32-bit word, first pixel in the low byte
+ * RAW12: 640x480 Bayer samples (G1 R / B G2), 12 bits in the low bits of a 16-bit half word
+ * RAW8: 640x480 Bayer samples, 8 most significant bits, 4 samples per 32-bit word
+ *
+ * The raw formats bypass the binning and ignore the scale.
+ */
+typedef enum camera_controller_pixel_format {
+    CAMERA_CONTROLLER_PIXEL_RGB565 = 0,
+    CAMERA_CONTROLLER_PIXEL_Y8     = 1,
+    CAMERA_CONTROLLER_PIXEL_RAW12  = 2,
+    CAMERA_CONTROLLER_PIXEL_RAW8   = 3
+} camera_controller_pixel_format;
+
+/*
+ * Conversion of the Bayer samples to RGB pixels
+ *
+ * BINNING: each 2x2 quad gives one pixel, 320x240 image that can be downscaled
+ * BILINEAR: bilinear interpolation of each sample, 640x480 image, the scale is ignored
+ */
+typedef enum camera_controller_demosaic {
+    CAMERA_CONTROLLER_DEMOSAIC_BINNING  = 0,
+    CAMERA_CONTROLLER_DEMOSAIC_BILINEAR = 1
+} camera_controller_demosaic;
+
+/*
+ * Reduction of the 12-bit channels to the 5/6/5 bits of the RGB565 format
+ *
+ * TRUNCATE: the least significant bits are dropped
+ * ROUND: rounding to the nearest value
+ * DITHER: 4x4 ordered (Bayer) dither, avoids the banding of the gradients
+ */
+typedef enum camera_controller_reduction {
+    CAMERA_CONTROLLER_REDUCTION_TRUNCATE = 0,
+    CAMERA_CONTROLLER_REDUCTION_ROUND    = 1,
+    CAMERA_CONTROLLER_REDUCTION_DITHER   = 2
+} camera_controller_reduction;
+
+/* Colour channel of a gamma table */
+typedef enum camera_controller_channel {
+    CAMERA_CONTROLLER_CHANNEL_RED   = 0,
+    CAMERA_CONTROLLER_CHANNEL_GREEN = 1,
+    CAMERA_CONTROLLER_CHANNEL_BLUE  = 2
+} camera_controller_channel;
+
+/* Buffer described by one entry of a descriptor table */
+typedef struct camera_controller_buffer {
+    uint32_t address;        /* Address of the buffer as seen by the controller */
+    uint32_t length;         /* Number of bytes written in the buffer (multiple of 64) */
+    uint32_t size;           /* Bytes reserved at address, at least length (+ trailer) */
+    uint8_t  id;             /* Identifier copied to the status when the buffer is full */
+} camera_controller_buffer;
+
+/*
+ * Trailer written by the controller after a frame
+ *
+ * The frame numbers of two consecutive buffers differ by more than 1 when
+ * frames were skipped (ring full), and dropped_lines is not 0 when lines were
+ * lost since the previous buffer (FIFO overflow, acquisition stopped).
+ */
+typedef struct camera_controller_trailer {
+    uint32_t frame;          /* Number of the camera frame since the reset of the controller */
+    uint32_t timestamp;      /* Main clock cycles when the first pixels of the frame were written */
+    uint32_t dropped_lines;  /* Camera lines not captured since the previous trailer */
+    uint8_t  format;         /* Value of the format register (scale, pixel format, ...) */
+    uint8_t  id;             /* Buffer identifier in descriptor mode, 0 otherwise */
+} camera_controller_trailer;
+
+/*
+ * Motion detection
+ *
+ * The 640x480 Bayer window is averaged by cells of 8x8 samples (80x60 cells)
+ * and each cell is compared with a reference frame. Cells are grouped in
+ * blocks of 4x4 cells (20x15 blocks). Bit b of byte k of the bitmap is block
+ * 8 * k + b, block 20 * row + column.
+ */
+#define CAMERA_CONTROLLER_MOTION_CELLS          (80 * 60)
+#define CAMERA_CONTROLLER_MOTION_BLOCK_COLUMNS  (20)
+#define CAMERA_CONTROLLER_MOTION_BLOCK_ROWS     (15)
+#define CAMERA_CONTROLLER_MOTION_BLOCKS         (CAMERA_CONTROLLER_MOTION_BLOCK_COLUMNS * CAMERA_CONTROLLER_MOTION_BLOCK_ROWS)
+#define CAMERA_CONTROLLER_MOTION_BITMAP_SIZE    ((CAMERA_CONTROLLER_MOTION_BLOCKS + 7) / 8)
+
+/* Results of the motion detection for one frame */
+typedef struct camera_controller_motion {
+    uint16_t changed_cells;  /* Cells whose luminance moved by more than the pixel threshold */
+    uint16_t changed_blocks; /* Blocks with more changed cells than the block threshold */
+    bool     alarm;          /* True if changed_cells is above the alarm threshold */
+    uint8_t  bitmap[CAMERA_CONTROLLER_MOTION_BITMAP_SIZE]; /* Changed blocks */
+} camera_controller_motion;
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+camera_controller_dev camera_controller_inst(void *base);
+
+/*
+ * Helper macro for easily constructing device structures. The user needs to
+ * provide the component's prefix, and the corresponding device structure is
+ * returned.
+ */
+#define CAMERA_CONTROLLER_INST(prefix)                 \
+    camera_controller_inst(((void *) prefix ## _BASE))
+
+void camera_controller_init(camera_controller_dev *dev);
+
+bool camera_controller_set_scale(camera_controller_dev *dev, camera_controller_scale scale);
+bool camera_controller_set_pixel_format(camera_controller_dev *dev, camera_controller_pixel_format pixel_format);
+camera_controller_pixel_format camera_controller_get_pixel_format(camera_controller_dev *dev);
+uint8_t camera_controller_bytes_per_pixel(camera_controller_dev *dev);
+bool camera_controller_set_demosaic(camera_controller_dev *dev, camera_controller_demosaic demosaic);
+bool camera_controller_set_reduction(camera_controller_dev *dev, camera_controller_reduction reduction);
+bool camera_controller_set_color_matrix(camera_controller_dev *dev, const int16_t *matrix);
+bool camera_controller_set_gamma_table(camera_controller_dev *dev, camera_controller_channel channel, const uint16_t *table);
+bool camera_controller_enable_color_correction(camera_controller_dev *dev, bool matrix, bool gamma);
+uint32_t camera_controller_bandwidth(camera_controller_dev *dev, uint32_t frames_per_second);
+uint32_t camera_controller_max_frame_rate(camera_controller_dev *dev, uint32_t bytes_per_second);
+uint32_t camera_controller_frame_length(camera_controller_dev *dev);
+uint16_t camera_controller_frame_width(camera_controller_dev *dev);
+uint16_t camera_controller_frame_height(camera_controller_dev *dev);
+
+bool camera_controller_configure(camera_controller_dev *dev, uint32_t start_address, uint32_t length, uint32_t stride, uint8_t num_buffers);
+bool camera_controller_configure_descriptors(camera_controller_dev *dev, void *desc_table, uint32_t desc_table_address, const camera_controller_buffer *buffers, uint8_t num_buffers);
+bool camera_controller_enable_trailer(camera_controller_dev *dev, bool enable);
+void camera_controller_start(camera_controller_dev *dev);
+void camera_controller_stop(camera_controller_dev *dev);
+
+uint8_t camera_controller_frames_ready(camera_controller_dev *dev);
+bool camera_controller_get_frame(camera_controller_dev *dev, uint32_t *address);
+bool camera_controller_get_buffer(camera_controller_dev *dev, camera_controller_buffer *buffer);
+bool camera_controller_get_trailer(camera_controller_dev *dev, const void *frame, camera_controller_trailer *trailer);
+bool camera_controller_get_crc(camera_controller_dev *dev, uint32_t *crc);
+void camera_controller_release_frame(camera_controller_dev *dev);
+
+bool camera_controller_motion_configure(camera_controller_dev *dev, uint8_t pixel_threshold, uint8_t block_threshold, uint16_t alarm_threshold);
+void camera_controller_motion_enable(camera_controller_dev *dev, bool enable, bool update_reference);
+void camera_controller_motion_set_callback(camera_controller_dev *dev, camera_controller_motion_callback callback, void *context);
+bool camera_controller_motion_poll(camera_controller_dev *dev, camera_controller_motion *motion);
+#ifdef __nios2_arch__
+bool camera_controller_motion_register_irq(camera_controller_dev *dev, int ic_id, int irq);
+#endif
+
+#endif /* __CAMERA_CONTROLLER_H__ */
@@ -0,0 +1,454 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "camera_controller_compress.h"
+#include "../sections/sections.h"
+
+/* Adaptive Golomb-Rice code of one channel */
+typedef struct channel_context {
+    uint8_t  shift;          /* Position of the channel in the pixel */
+    uint8_t  bits;           /* Number of bits of the channel */
+    uint32_t sum;            /* Sum of the recent mapped residuals */
+    uint32_t count;          /* Number of recent residuals */
+} channel_context;
+
+/* Bits written most significant first in a byte buffer */
+typedef struct bit_writer {
+    uint8_t  *dst;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t acc;
+    uint32_t bits;
+    bool     overflow;
+} bit_writer;
+
+/* Bits read most significant first from a byte buffer */
+typedef struct bit_reader {
+    const uint8_t *src;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t acc;
+    uint32_t bits;
+} bit_reader;
+
+#define CONTEXT_RESET   (64)   /* halve the statistics after this many residuals */
+
+/* Previous and current lines of the frame, the frame may be in uncached memory */
+static uint16_t lines[2][CAMERA_CONTROLLER_COMPRESS_MAX_WIDTH] ALT_FAST_DATA;
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static uint8_t init_channels(camera_controller_pixel_format format, channel_context *channels);
+static void put_bits(bit_writer *writer, uint32_t value, uint32_t n);
+static uint32_t get_bits(bit_reader *reader, uint32_t n);
+static uint32_t predict(uint32_t a, uint32_t b, uint32_t c);
+static uint32_t rice_parameter(channel_context *channel);
+static void update_context(channel_context *channel, uint32_t mapped);
+static void encode_sample(bit_writer *writer, channel_context *channel, uint32_t value, uint32_t prediction);
+static uint32_t decode_sample(bit_reader *reader, channel_context *channel, uint32_t prediction);
+static void write_le(uint8_t *dst, uint32_t value, uint32_t n);
+static uint32_t read_le(const uint8_t *src, uint32_t n);
+
+/*
+ * init_channels
+ *
+ * Describes the channels of a pixel format and resets their statistics.
+ *
+ * Returns the number of channels, 0 if the format is not supported.
+ */
+static uint8_t init_channels(camera_controller_pixel_format format, channel_context *channels) {
+    static const uint8_t rgb565[3][2] = {{11, 5}, {5, 6}, {0, 5}};
+    uint8_t num_channels = 0;
+    uint8_t i = 0;
+
+    switch (format) {
+    case CAMERA_CONTROLLER_PIXEL_RGB565:
+        num_channels = 3;
+        for (i = 0; i < num_channels; i++) {
+            channels[i].shift = rgb565[i][0];
+            channels[i].bits = rgb565[i][1];
+        }
+        break;
+    case CAMERA_CONTROLLER_PIXEL_Y8:
+        num_channels = 1;
+        channels[0].shift = 0;
+        channels[0].bits = 8;
+        break;
+    default:
+        return 0;
+    }
+
+    for (i = 0; i < num_channels; i++) {
+        channels[i].sum = 4;
+        channels[i].count = 1;
+    }
+
+    return num_channels;
+}
+
+/*
+ * put_bits
+ *
+ * Appends the n (at most 24) low bits of value.
+ */
+static void ALT_HOT_TEXT put_bits(bit_writer *writer, uint32_t value, uint32_t n) {
+    writer->acc = (writer->acc << n) | value;
+    writer->bits += n;
+
+    while (writer->bits >= 8) {
+        writer->bits -= 8;
+        if (writer->pos < writer->size) {
+            writer->dst[writer->pos++] = writer->acc >> writer->bits;
+        } else {
+            writer->overflow = true;
+        }
+    }
+}
+
+/*
+ * get_bits
+ *
+ * Returns the next n (at most 24) bits, zeros past the end of the buffer.
+ */
+static uint32_t get_bits(bit_reader *reader, uint32_t n) {
+    while (reader->bits < n) {
+        reader->acc <<= 8;
+        if (reader->pos < reader->size) {
+            reader->acc |= reader->src[reader->pos++];
+        }
+        reader->bits += 8;
+    }
+
+    reader->bits -= n;
+    return (reader->acc >> reader->bits) & ((1 << n) - 1);
+}
+
+/*
+ * predict
+ *
+ * Median edge detector: a is the left neighbour, b the upper one and c the
+ * upper left one.
+ */
+static uint32_t ALT_HOT_TEXT predict(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t low = (a < b) ? a : b;
+    uint32_t high = (a < b) ? b : a;
+
+    if (c >= high) {
+        return low;
+    } else if (c <= low) {
+        return high;
+    } else {
+        return a + b - c;
+    }
+}
+
+/*
+ * rice_parameter
+ *
+ * Returns the smallest k such that count * 2^k >= sum, which follows the mean
+ * of the recent residuals without a division.
+ */
+static uint32_t ALT_HOT_TEXT rice_parameter(channel_context *channel) {
+    uint32_t k = 0;
+
+    while (((channel->count << k) < channel->sum) && (k < channel->bits)) {
+        k++;
+    }
+
+    return k;
+}
+
+/*
+ * update_context
+ *
+ * Adds a mapped residual to the statistics of the channel.
+ */
+static void ALT_HOT_TEXT update_context(channel_context *channel, uint32_t mapped) {
+    channel->sum += mapped;
+    channel->count++;
+
+    if (channel->count >= CONTEXT_RESET) {
+        channel->sum >>= 1;
+        channel->count >>= 1;
+    }
+}
+
+/*
+ * encode_sample
+ *
+ * Writes the code of one channel. The residual modulo 2^bits is mapped to
+ * 0, -1, 1, -2, ... -> 0, 1, 2, 3, ... then coded with q = mapped >> k ones, a
+ * zero and the k low bits. Codes of 2 * bits ones or more are escaped: 2 * bits
+ * ones followed by the mapped residual on bits bits.
+ */
+static void ALT_HOT_TEXT encode_sample(bit_writer *writer, channel_context *channel, uint32_t value, uint32_t prediction) {
+    uint32_t mask = (1 << channel->bits) - 1;
+    uint32_t limit = 2 * channel->bits;
+    uint32_t residual = (value - prediction) & mask;
+    uint32_t mapped = 0;
+    uint32_t k = rice_parameter(channel);
+    uint32_t q = 0;
+
+    if (residual & (1 << (channel->bits - 1))) {    /* negative */
+        mapped = 2 * (mask - residual) + 1;
+    } else {
+        mapped = 2 * residual;
+    }
+
+    q = mapped >> k;
+    if (q < limit) {
+        put_bits(writer, (1 << (q + 1)) - 2, q + 1);
+        put_bits(writer, mapped & ((1 << k) - 1), k);
+    } else {
+        put_bits(writer, (1 << limit) - 1, limit);
+        put_bits(writer, mapped, channel->bits);
+    }
+
+    update_context(channel, mapped);
+}
+
+/*
+ * decode_sample
+ *
+ * Reads the code of one channel and returns its value.
+ */
+static uint32_t decode_sample(bit_reader *reader, channel_context *channel, uint32_t prediction) {
+    uint32_t mask = (1 << channel->bits) - 1;
+    uint32_t limit = 2 * channel->bits;
+    uint32_t k = rice_parameter(channel);
+    uint32_t q = 0;
+    uint32_t mapped = 0;
+    uint32_t residual = 0;
+
+    while ((q < limit) && get_bits(reader, 1)) {
+        q++;
+    }
+
+    if (q < limit) {
+        mapped = (q << k) | get_bits(reader, k);
+    } else {
+        mapped = get_bits(reader, channel->bits);
+    }
+
+    if (mapped & 1) {
+        residual = mask - (mapped >> 1);
+    } else {
+        residual = mapped >> 1;
+    }
+
+    update_context(channel, mapped);
+
+    return (prediction + residual) & mask;
+}
+
+/*
+ * write_le
+ *
+ * Writes the n low bytes of value, least significant first.
+ */
+static void write_le(uint8_t *dst, uint32_t value, uint32_t n) {
+    uint32_t i = 0;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+/*
+ * read_le
+ *
+ * Reads a value of n bytes, least significant first.
+ */
+static uint32_t read_le(const uint8_t *src, uint32_t n) {
+    uint32_t i = 0;
+    uint32_t value = 0;
+
+    for (i = 0; i < n; i++) {
+        value |= ((uint32_t) src[i]) << (8 * i);
+    }
+
+    return value;
+}
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * camera_controller_compress
+ *
+ * Compresses a frame of width x height pixels in the RGB565 or Y8 format (as
+ * written by the controller) into dst, which holds dst_size bytes.
+ * CAMERA_CONTROLLER_COMPRESS_BOUND() bytes are always enough, natural images
+ * need less than half the size of the frame.
+ *
+ * Each pixel of the frame is read once, so the frame can be read through the
+ * cache bypass. This routine uses static line buffers and is not reentrant.
+ *
+ * Returns the number of bytes of the compressed frame, and 0 if the format or
+ * the width is not supported or if dst is too small.
+ */
+uint32_t ALT_HOT_TEXT camera_controller_compress(const void *frame, uint16_t width, uint16_t height, camera_controller_pixel_format format, void *dst, uint32_t dst_size) {
+    channel_context channels[3];
+    bit_writer writer;
+    uint8_t num_channels = init_channels(format, channels);
+    uint16_t *previous = lines[0];
+    uint16_t *current = lines[1];
+    uint16_t *swap = NULL;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t i = 0;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+    uint32_t mask = 0;
+
+    if ((num_channels == 0) || (width > CAMERA_CONTROLLER_COMPRESS_MAX_WIDTH) || (dst_size < CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE)) {
+        return 0;
+    }
+
+    writer.dst = (uint8_t *) dst + CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE;
+    writer.size = dst_size - CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE;
+    writer.pos = 0;
+    writer.acc = 0;
+    writer.bits = 0;
+    writer.overflow = false;
+
+    for (y = 0; y < height; y++) {
+        /* one read per pixel */
+        if (format == CAMERA_CONTROLLER_PIXEL_Y8) {
+            for (x = 0; x < width; x++) {
+                current[x] = ((const uint8_t *) frame)[y * width + x];
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                current[x] = ((const uint16_t *) frame)[y * width + x];
+            }
+        }
+
+        for (x = 0; x < width; x++) {
+            for (i = 0; i < num_channels; i++) {
+                mask = (1 << channels[i].bits) - 1;
+                a = (x > 0) ? (current[x - 1] >> channels[i].shift) & mask : 0;
+                b = (y > 0) ? (previous[x] >> channels[i].shift) & mask : a;
+                c = (x > 0) ? ((y > 0) ? (previous[x - 1] >> channels[i].shift) & mask : a) : b;
+                if (x == 0) {
+                    a = b;
+                }
+                encode_sample(&writer, &channels[i], (current[x] >> channels[i].shift) & mask, predict(a, b, c));
+            }
+        }
+
+        swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    /* last byte padded with zeros */
+    if (writer.bits != 0) {
+        put_bits(&writer, 0, 8 - writer.bits);
+    }
+
+    if (writer.overflow) {
+        return 0;
+    }
+
+    memcpy(dst, CAMERA_CONTROLLER_COMPRESS_MAGIC, 4);
+    write_le((uint8_t *) dst + 0x4, width, 2);
+    write_le((uint8_t *) dst + 0x6, height, 2);
+    write_le((uint8_t *) dst + 0x8, format, 4);
+    write_le((uint8_t *) dst + 0xC, writer.pos, 4);
+
+    return CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE + writer.pos;
+}
+
+/*
+ * camera_controller_decompress
+ *
+ * Restores a frame compressed by camera_controller_compress() into frame,
+ * which holds frame_size bytes. It lets the firmware keep compressed test
+ * pictures and expand them in a buffer of the ring.
+ *
+ * Returns the number of bytes of the frame, and 0 if src is not a compressed
+ * frame or if frame is too small.
+ */
+uint32_t camera_controller_decompress(const void *src, uint32_t src_size, void *frame, uint32_t frame_size) {
+    const uint8_t *header = (const uint8_t *) src;
+    channel_context channels[3];
+    bit_reader reader;
+    camera_controller_pixel_format format = CAMERA_CONTROLLER_PIXEL_RGB565;
+    uint8_t num_channels = 0;
+    uint16_t *previous = lines[0];
+    uint16_t *current = lines[1];
+    uint16_t *swap = NULL;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t length = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t i = 0;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+    uint32_t mask = 0;
+    uint32_t pixel = 0;
+
+    if ((src_size < CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE) || (memcmp(header, CAMERA_CONTROLLER_COMPRESS_MAGIC, 4) != 0)) {
+        return 0;
+    }
+
+    width = read_le(header + 0x4, 2);
+    height = read_le(header + 0x6, 2);
+    format = (camera_controller_pixel_format) read_le(header + 0x8, 4);
+    length = width * height * ((format == CAMERA_CONTROLLER_PIXEL_Y8) ? 1 : 2);
+    num_channels = init_channels(format, channels);
+
+    if ((num_channels == 0) || (width > CAMERA_CONTROLLER_COMPRESS_MAX_WIDTH) || (length > frame_size)) {
+        return 0;
+    }
+
+    reader.src = header + CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE;
+    reader.size = src_size - CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE;
+    reader.pos = 0;
+    reader.acc = 0;
+    reader.bits = 0;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            pixel = 0;
+            for (i = 0; i < num_channels; i++) {
+                mask = (1 << channels[i].bits) - 1;
+                a = (x > 0) ? (current[x - 1] >> channels[i].shift) & mask : 0;
+                b = (y > 0) ? (previous[x] >> channels[i].shift) & mask : a;
+                c = (x > 0) ? ((y > 0) ? (previous[x - 1] >> channels[i].shift) & mask : a) : b;
+                if (x == 0) {
+                    a = b;
+                }
+                pixel |= decode_sample(&reader, &channels[i], predict(a, b, c)) << channels[i].shift;
+            }
+            current[x] = pixel;
+        }
+
+        if (format == CAMERA_CONTROLLER_PIXEL_Y8) {
+            for (x = 0; x < width; x++) {
+                ((uint8_t *) frame)[y * width + x] = current[x];
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                ((uint16_t *) frame)[y * width + x] = current[x];
+            }
+        }
+
+        swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    return length;
+}
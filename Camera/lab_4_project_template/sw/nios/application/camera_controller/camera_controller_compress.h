@@ -0,0 +1,42 @@
+#ifndef __CAMERA_CONTROLLER_COMPRESS_H__
+#define __CAMERA_CONTROLLER_COMPRESS_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#include "camera_controller.h"
+
+/*
+ * Lossless compression of the frames before they are stored or dumped to the
+ * host (ImageConverter/python, decompress()).
+ *
+ * Each channel (R5 G6 B5 for RGB565, Y8 for the luminance) is predicted from
+ * its left, upper and upper left neighbours (median edge detector of
+ * LOCO-I/JPEG-LS). The residual is coded with an adaptive Golomb-Rice code, so
+ * flat areas cost 1 bit per channel. A compressed frame is a header followed by
+ * the codes, most significant bit first:
+ *
+ *  +0x0: CAMERA_CONTROLLER_COMPRESS_MAGIC ("CCZ1")
+ *  +0x4: width, 2 bytes little-endian
+ *  +0x6: height, 2 bytes little-endian
+ *  +0x8: pixel format (camera_controller_pixel_format), 3 reserved bytes
+ *  +0xC: number of bytes of codes, 4 bytes little-endian
+ */
+#define CAMERA_CONTROLLER_COMPRESS_MAGIC        "CCZ1"
+#define CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE  (16)
+#define CAMERA_CONTROLLER_COMPRESS_MAX_WIDTH    (640)
+
+/* Size of the largest compressed frame, 3 times the channel bits per channel */
+#define CAMERA_CONTROLLER_COMPRESS_BOUND(width, height) \
+    (CAMERA_CONTROLLER_COMPRESS_HEADER_SIZE + (uint32_t) (width) * (height) * 6)
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+uint32_t camera_controller_compress(const void *frame, uint16_t width, uint16_t height, camera_controller_pixel_format format, void *dst, uint32_t dst_size);
+uint32_t camera_controller_decompress(const void *src, uint32_t src_size, void *frame, uint32_t frame_size);
+
+#endif /* __CAMERA_CONTROLLER_COMPRESS_H__ */
@@ -0,0 +1,122 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#include "camera_controller_crc.h"
+#include "../sections/sections.h"
+
+/*
+ * Slicing-by-8 tables: crc_table[0] is the classic byte table, crc_table[k][b]
+ * is the CRC of the byte b followed by k zero bytes. 8 KB, built once by
+ * camera_controller_crc_init().
+ */
+static uint32_t crc_table[8][256] ALT_FAST_DATA;
+static bool crc_table_ready = false;
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static uint32_t crc32_bytes(uint32_t crc, const uint8_t *data, uint32_t length);
+
+/*
+ * crc32_bytes
+ *
+ * Updates the (inverted) crc with length bytes, one table lookup per byte.
+ */
+static uint32_t ALT_HOT_TEXT crc32_bytes(uint32_t crc, const uint8_t *data, uint32_t length) {
+    while (length-- != 0) {
+        crc = crc_table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * camera_controller_crc_init
+ *
+ * Builds the tables of camera_controller_crc32(). It is called by
+ * camera_controller_crc32() the first time, call it at start-up to keep the
+ * first CRC as fast as the next ones.
+ */
+void camera_controller_crc_init(void) {
+    uint32_t i = 0;
+    uint32_t k = 0;
+    uint32_t crc = 0;
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CAMERA_CONTROLLER_CRC_POLYNOMIAL : crc >> 1;
+        }
+        crc_table[0][i] = crc;
+    }
+
+    for (i = 0; i < 256; i++) {
+        crc = crc_table[0][i];
+        for (k = 1; k < 8; k++) {
+            crc = crc_table[0][crc & 0xFF] ^ (crc >> 8);
+            crc_table[k][i] = crc;
+        }
+    }
+
+    crc_table_ready = true;
+}
+
+/*
+ * camera_controller_crc32
+ *
+ * Returns the CRC-32 of crc (CAMERA_CONTROLLER_CRC_INIT for a new buffer)
+ * followed by length bytes of data. The result for a whole frame equals the
+ * CRC computed by the controller, see camera_controller_get_crc().
+ *
+ * The bytes are processed 8 at a time with two 32-bit loads, which assumes a
+ * little-endian CPU (Nios II, x86). data may be any address: read a frame
+ * through the cache bypass of the data cache (address |
+ * ALT_CPU_DCACHE_BYPASS_MASK) or through the address returned by
+ * camera_controller_mem_map().
+ */
+uint32_t ALT_HOT_TEXT camera_controller_crc32(uint32_t crc, const void *data, uint32_t length) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    const uint32_t *words = NULL;
+    uint32_t head = (4 - ((uintptr_t) bytes & 3)) & 3;
+    uint32_t one = 0;
+    uint32_t two = 0;
+
+    if (!crc_table_ready) {
+        camera_controller_crc_init();
+    }
+
+    crc = ~crc;
+
+    /* bytes up to the first aligned word */
+    if (head > length) {
+        head = length;
+    }
+    crc = crc32_bytes(crc, bytes, head);
+    bytes += head;
+    length -= head;
+
+    /* 8 bytes per step */
+    words = (const uint32_t *) bytes;
+    while (length >= 8) {
+        one = *words++ ^ crc;
+        two = *words++;
+        crc = crc_table[7][one & 0xFF] ^ crc_table[6][(one >> 8) & 0xFF] ^
+              crc_table[5][(one >> 16) & 0xFF] ^ crc_table[4][one >> 24] ^
+              crc_table[3][two & 0xFF] ^ crc_table[2][(two >> 8) & 0xFF] ^
+              crc_table[1][(two >> 16) & 0xFF] ^ crc_table[0][two >> 24];
+        length -= 8;
+    }
+
+    /* remaining bytes */
+    crc = crc32_bytes(crc, (const uint8_t *) words, length);
+
+    return ~crc;
+}
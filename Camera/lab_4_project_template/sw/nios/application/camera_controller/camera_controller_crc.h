@@ -0,0 +1,26 @@
+#ifndef __CAMERA_CONTROLLER_CRC_H__
+#define __CAMERA_CONTROLLER_CRC_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+/*
+ * CRC-32 of the camera controller (IEEE 802.3, reflected polynomial
+ * 0xEDB88320, initial value and final xor 0xFFFFFFFF), the same as zlib's
+ * crc32(). The CRC of a buffer in several pieces is obtained by giving the
+ * result of a piece as the crc of the next one, starting from
+ * CAMERA_CONTROLLER_CRC_INIT.
+ */
+#define CAMERA_CONTROLLER_CRC_INIT       (0x00000000)
+#define CAMERA_CONTROLLER_CRC_POLYNOMIAL (0xEDB88320)
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+void camera_controller_crc_init(void);
+uint32_t camera_controller_crc32(uint32_t crc, const void *data, uint32_t length);
+
+#endif /* __CAMERA_CONTROLLER_CRC_H__ */
@@ -0,0 +1,184 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "system.h"
+#include "sys/alt_dma.h"
+#endif
+
+#include "camera_controller_dma.h"
+#include "camera_controller_mem.h"
+#include "../sections/sections.h"
+
+#ifdef __nios2_arch__
+#define BYPASS_MASK     (ALT_CPU_DCACHE_BYPASS_MASK)
+#else
+#define BYPASS_MASK     (0)
+#endif
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static void finish_copy(camera_controller_dma_dev *dev);
+#ifdef __nios2_arch__
+static void copy_done(void *handle, void *data);
+#endif
+
+/*
+ * finish_copy
+ *
+ * Ends the current copy and calls its callback. A new copy can be started
+ * from the callback.
+ */
+static void finish_copy(camera_controller_dma_dev *dev) {
+    camera_controller_dma_callback callback = dev->callback;
+
+    dev->busy = false;
+
+    if (callback != NULL) {
+        callback(dev, dev->context);
+    }
+}
+
+#ifdef __nios2_arch__
+/*
+ * copy_done
+ *
+ * Called by the DMA driver, from its interrupt handler, when the receive
+ * channel has written the whole copy.
+ */
+static void ALT_HOT_TEXT copy_done(void *handle, void *data) {
+    (void) data;
+
+    finish_copy((camera_controller_dma_dev *) handle);
+}
+#endif
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * camera_controller_dma_init
+ *
+ * Opens both channels of the DMA called name (for instance DMA_0_NAME), or
+ * prepares copies by the CPU if name is NULL.
+ *
+ * Returns true if the copies will be made by the DMA.
+ */
+bool camera_controller_dma_init(camera_controller_dma_dev *dev, const char *name) {
+    dev->tx = NULL;
+    dev->rx = NULL;
+    dev->busy = false;
+    dev->callback = NULL;
+    dev->context = NULL;
+
+#ifdef __nios2_arch__
+    if (name != NULL) {
+        dev->tx = alt_dma_txchan_open(name);
+        dev->rx = alt_dma_rxchan_open(name);
+    }
+
+    if ((dev->tx == NULL) || (dev->rx == NULL)) {
+        dev->tx = NULL;
+        dev->rx = NULL;
+    }
+#else
+    (void) name;
+#endif
+
+    return dev->tx != NULL;
+}
+
+/*
+ * camera_controller_dma_copy
+ *
+ * Starts the copy of length bytes from src to dst. src and dst are addresses
+ * as seen by the CPU, with or without the cache bypass bit. The data cache
+ * lines of both ranges are flushed first, read dst through the cache bypass
+ * or after camera_controller_mem_flush() while the copy is in progress.
+ * Transfers are made by words when the addresses and the length allow it.
+ *
+ * callback (may be NULL) is called with context at the end of the copy.
+ *
+ * The copy is made by the CPU, before returning, if the system has no DMA or
+ * if the DMA refuses it.
+ *
+ * Returns false if a copy is already in progress or if length is 0 or above
+ * CAMERA_CONTROLLER_DMA_MAX_LENGTH.
+ */
+bool camera_controller_dma_copy(camera_controller_dma_dev *dev, void *dst, const void *src, uint32_t length, camera_controller_dma_callback callback, void *context) {
+#ifdef __nios2_arch__
+    void *dst_address = (void *) ((uintptr_t) dst & ~BYPASS_MASK);
+    const void *src_address = (const void *) ((uintptr_t) src & ~BYPASS_MASK);
+    uint32_t alignment = (uintptr_t) dst | (uintptr_t) src | length;
+    int mode = ALT_DMA_SET_MODE_8;
+#endif
+
+    if (dev->busy || (length == 0) || (length > CAMERA_CONTROLLER_DMA_MAX_LENGTH)) {
+        return false;
+    }
+
+    dev->busy = true;
+    dev->callback = callback;
+    dev->context = context;
+
+    /* the DMA does not see the data cache */
+    camera_controller_mem_flush(src, length);
+    camera_controller_mem_flush(dst, length);
+
+#ifdef __nios2_arch__
+    if (dev->tx != NULL) {
+        if ((alignment & 0x3) == 0) {
+            mode = ALT_DMA_SET_MODE_32;
+        } else if ((alignment & 0x1) == 0) {
+            mode = ALT_DMA_SET_MODE_16;
+        }
+
+        alt_dma_txchan_ioctl((alt_dma_txchan) dev->tx, mode, NULL);
+        alt_dma_rxchan_ioctl((alt_dma_rxchan) dev->rx, mode, NULL);
+
+        /*
+         * The driver cannot withdraw a request, so the receive request is
+         * posted only once the transmit one is accepted: a receive request
+         * left alone would be paired with the source of the next copy. The
+         * receive queue is empty between copies and the length has just been
+         * accepted, so the receive request is not refused.
+         */
+        if ((alt_dma_txchan_send((alt_dma_txchan) dev->tx, src_address, length, NULL, NULL) >= 0) &&
+            (alt_dma_rxchan_prepare((alt_dma_rxchan) dev->rx, dst_address, length, copy_done, dev) >= 0)) {
+            return true;
+        }
+    }
+#endif
+
+    /* no DMA, or the DMA refused the copy */
+    camera_controller_mem_copy(dst, src, length);
+    camera_controller_mem_flush(dst, length);
+    finish_copy(dev);
+
+    return true;
+}
+
+/*
+ * camera_controller_dma_busy
+ *
+ * Returns true while a copy is in progress.
+ */
+bool camera_controller_dma_busy(camera_controller_dma_dev *dev) {
+    return dev->busy;
+}
+
+/*
+ * camera_controller_dma_wait
+ *
+ * Waits for the end of the copy in progress, if any.
+ */
+void camera_controller_dma_wait(camera_controller_dma_dev *dev) {
+    while (dev->busy) {
+    }
+}
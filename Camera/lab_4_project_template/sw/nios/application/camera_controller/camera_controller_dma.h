@@ -0,0 +1,47 @@
+#ifndef __CAMERA_CONTROLLER_DMA_H__
+#define __CAMERA_CONTROLLER_DMA_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+struct camera_controller_dma_dev;
+
+/*
+ * Function called when a copy is finished, from the interrupt handler of the
+ * DMA (or before camera_controller_dma_copy() returns without DMA)
+ */
+typedef void (*camera_controller_dma_callback)(struct camera_controller_dma_dev *dev, void *context);
+
+/*
+ * Copies of frames by a DMA (altera_avalon_dma, HAL alt_dma channels), for
+ * instance from the frame memory to the on-chip memory or between two
+ * buffers of the frame memory. One copy at a time: the DMA reads through its
+ * transmit channel and writes through its receive channel.
+ *
+ * When the DMA cannot be opened (no DMA in the system) the copies are made
+ * by the CPU with camera_controller_mem_copy().
+ */
+typedef struct camera_controller_dma_dev {
+    void     *tx;            /* Transmit channel (alt_dma_txchan), NULL without DMA */
+    void     *rx;            /* Receive channel (alt_dma_rxchan), NULL without DMA */
+    volatile bool busy;      /* True while a copy is in progress */
+    camera_controller_dma_callback callback; /* Called at the end of the copy, NULL if none */
+    void     *context;       /* Argument given to callback */
+} camera_controller_dma_dev;
+
+/* Largest copy, limited by the 18-bit length register of the DMA */
+#define CAMERA_CONTROLLER_DMA_MAX_LENGTH (0x3FFFC)
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+bool camera_controller_dma_init(camera_controller_dma_dev *dev, const char *name);
+bool camera_controller_dma_copy(camera_controller_dma_dev *dev, void *dst, const void *src, uint32_t length, camera_controller_dma_callback callback, void *context);
+bool camera_controller_dma_busy(camera_controller_dma_dev *dev);
+void camera_controller_dma_wait(camera_controller_dma_dev *dev);
+
+#endif /* __CAMERA_CONTROLLER_DMA_H__ */
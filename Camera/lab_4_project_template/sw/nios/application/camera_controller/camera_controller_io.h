@@ -0,0 +1,29 @@
+#ifndef __CAMERA_CONTROLLER_IO_H__
+#define __CAMERA_CONTROLLER_IO_H__
+
+#ifdef __nios2_arch__
+#include "io.h"
+
+#define camera_controller_write_byte(dest, src) (IOWR_8DIRECT((dest), 0, (src)))
+#define camera_controller_read_byte(src)        (IORD_8DIRECT((src), 0))
+#define camera_controller_write_word(dest, src) (IOWR_32DIRECT((dest), 0, (src)))
+#define camera_controller_read_word(src)        (IORD_32DIRECT((src), 0))
+
+#else
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#define CAMERA_CONTROLLER_CAST(type, ptr)       ((type) (ptr))
+
+#define camera_controller_write_byte(dest, src) (*CAMERA_CONTROLLER_CAST(volatile uint8_t *, (dest)) = (src))
+#define camera_controller_read_byte(src)        (*CAMERA_CONTROLLER_CAST(volatile uint8_t *, (src)))
+#define camera_controller_write_word(dest, src) (*CAMERA_CONTROLLER_CAST(volatile uint32_t *, (dest)) = (src))
+#define camera_controller_read_word(src)        (*CAMERA_CONTROLLER_CAST(volatile uint32_t *, (src)))
+
+#endif
+
+#endif /* __CAMERA_CONTROLLER_IO_H__ */
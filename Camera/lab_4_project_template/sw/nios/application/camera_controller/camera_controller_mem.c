@@ -0,0 +1,259 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "system.h"
+#include "sys/alt_cache.h"
+#endif
+
+#include "camera_controller_mem.h"
+#include "../sections/sections.h"
+
+#ifdef __nios2_arch__
+#define BYPASS_MASK     (ALT_CPU_DCACHE_BYPASS_MASK)
+#define DCACHE_SIZE     (ALT_CPU_DCACHE_SIZE)
+#else
+#define BYPASS_MASK     (0)
+#define DCACHE_SIZE     (0)
+#endif
+
+#define WORDS_PER_LINE  (CAMERA_CONTROLLER_MEM_LINE_SIZE / sizeof(uint32_t))
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static bool aligned(const void *a, const void *b);
+static volatile void *uncached(const void *address);
+
+/*
+ * aligned
+ *
+ * Returns true if both addresses are word aligned.
+ */
+static bool aligned(const void *a, const void *b) {
+    return (((uintptr_t) a | (uintptr_t) b) & (sizeof(uint32_t) - 1)) == 0;
+}
+
+/*
+ * uncached
+ *
+ * Returns the address of the same memory through the cache bypass.
+ */
+static volatile void *uncached(const void *address) {
+    return (volatile void *) ((uintptr_t) address | BYPASS_MASK);
+}
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * camera_controller_mem_copy
+ *
+ * Copies length bytes from src to dst as given (cached or not), 8 words per
+ * step: the 8 loads are issued before the 8 stores, so a line fill or a burst
+ * of the bridge is not interleaved with stores.
+ */
+void ALT_HOT_TEXT camera_controller_mem_copy(void *dst, const void *src, uint32_t length) {
+    uint32_t *dst_words = (uint32_t *) dst;
+    const uint32_t *src_words = (const uint32_t *) src;
+    uint8_t *dst_bytes = NULL;
+    const uint8_t *src_bytes = NULL;
+    uint32_t w0, w1, w2, w3, w4, w5, w6, w7;
+
+    if (aligned(dst, src)) {
+        while (length >= CAMERA_CONTROLLER_MEM_LINE_SIZE) {
+            w0 = src_words[0]; w1 = src_words[1]; w2 = src_words[2]; w3 = src_words[3];
+            w4 = src_words[4]; w5 = src_words[5]; w6 = src_words[6]; w7 = src_words[7];
+            dst_words[0] = w0; dst_words[1] = w1; dst_words[2] = w2; dst_words[3] = w3;
+            dst_words[4] = w4; dst_words[5] = w5; dst_words[6] = w6; dst_words[7] = w7;
+            src_words += WORDS_PER_LINE;
+            dst_words += WORDS_PER_LINE;
+            length -= CAMERA_CONTROLLER_MEM_LINE_SIZE;
+        }
+
+        while (length >= sizeof(uint32_t)) {
+            *dst_words++ = *src_words++;
+            length -= sizeof(uint32_t);
+        }
+    }
+
+    dst_bytes = (uint8_t *) dst_words;
+    src_bytes = (const uint8_t *) src_words;
+    while (length-- != 0) {
+        *dst_bytes++ = *src_bytes++;
+    }
+}
+
+/*
+ * camera_controller_mem_flush
+ *
+ * Writes back and invalidates the data cache lines of length bytes at address,
+ * the whole data cache at once (one instruction per line of the cache) when
+ * the range is larger than the cache.
+ */
+void camera_controller_mem_flush(const void *address, uint32_t length) {
+#ifdef __nios2_arch__
+    if (length >= DCACHE_SIZE) {
+        alt_dcache_flush_all();
+    } else {
+        alt_dcache_flush((void *) address, length);
+    }
+#else
+    (void) address;
+    (void) length;
+#endif
+}
+
+/*
+ * camera_controller_mem_read
+ *
+ * Copies length bytes of the frame memory into buffer. The lines of the frame
+ * are flushed first, so the loads see what the controller wrote.
+ */
+void camera_controller_mem_read(void *buffer, const void *frame, uint32_t length) {
+    camera_controller_mem_flush(frame, length);
+    camera_controller_mem_copy(buffer, frame, length);
+}
+
+/*
+ * camera_controller_mem_map
+ *
+ * Returns the cached address of length bytes of the frame memory (frame with
+ * or without the cache bypass bit) which the controller or a DMA has just
+ * completed, after having invalidated their lines without writing them back:
+ * the first load of a line fills it with a burst of the bridge, the other 7
+ * words come from the cache. Call it each time the buffer is completed
+ * (camera_controller_get_frame(), camera_controller_dma_wait()) and only read
+ * through the returned address.
+ *
+ * A range larger than the data cache is invalidated by flushing the whole
+ * cache, one instruction per line of the cache instead of one per line of the
+ * range: the frame has no dirty line, only those of other memories are
+ * written back.
+ */
+const void *camera_controller_mem_map(const void *frame, uint32_t length) {
+#ifdef __nios2_arch__
+    void *cached = alt_remap_cached((volatile void *) frame, length);
+
+    if (length >= DCACHE_SIZE) {
+        alt_dcache_flush_all();
+    } else {
+        alt_dcache_flush_no_writeback(cached, length);
+    }
+
+    return cached;
+#else
+    (void) length;
+
+    return frame;
+#endif
+}
+
+/*
+ * camera_controller_mem_write
+ *
+ * Copies length bytes of buffer into the frame memory through the cache
+ * bypass, for instance to upload a test picture. Lines of the frame cached
+ * before are not updated, camera_controller_mem_read() flushes them.
+ */
+void camera_controller_mem_write(void *frame, const void *buffer, uint32_t length) {
+    volatile uint32_t *dst_words = (volatile uint32_t *) uncached(frame);
+    const uint32_t *src_words = (const uint32_t *) buffer;
+    volatile uint8_t *dst_bytes = NULL;
+    const uint8_t *src_bytes = NULL;
+    uint32_t w0, w1, w2, w3, w4, w5, w6, w7;
+
+    if (aligned(frame, buffer)) {
+        while (length >= CAMERA_CONTROLLER_MEM_LINE_SIZE) {
+            w0 = src_words[0]; w1 = src_words[1]; w2 = src_words[2]; w3 = src_words[3];
+            w4 = src_words[4]; w5 = src_words[5]; w6 = src_words[6]; w7 = src_words[7];
+            dst_words[0] = w0; dst_words[1] = w1; dst_words[2] = w2; dst_words[3] = w3;
+            dst_words[4] = w4; dst_words[5] = w5; dst_words[6] = w6; dst_words[7] = w7;
+            src_words += WORDS_PER_LINE;
+            dst_words += WORDS_PER_LINE;
+            length -= CAMERA_CONTROLLER_MEM_LINE_SIZE;
+        }
+
+        while (length >= sizeof(uint32_t)) {
+            *dst_words++ = *src_words++;
+            length -= sizeof(uint32_t);
+        }
+    }
+
+    dst_bytes = (volatile uint8_t *) dst_words;
+    src_bytes = (const uint8_t *) src_words;
+    while (length-- != 0) {
+        *dst_bytes++ = *src_bytes++;
+    }
+}
+
+/*
+ * camera_controller_mem_fill
+ *
+ * Fills length bytes of the frame memory with the word value through the
+ * cache bypass, for instance to clear a buffer of the ring. The bytes are
+ * written in the order of the memory: the low byte of value first.
+ */
+void camera_controller_mem_fill(void *frame, uint32_t value, uint32_t length) {
+    volatile uint32_t *dst_words = (volatile uint32_t *) uncached(frame);
+    volatile uint8_t *dst_bytes = NULL;
+    uint32_t shift = 0;
+
+    if (aligned(frame, NULL)) {
+        while (length >= CAMERA_CONTROLLER_MEM_LINE_SIZE) {
+            dst_words[0] = value; dst_words[1] = value; dst_words[2] = value; dst_words[3] = value;
+            dst_words[4] = value; dst_words[5] = value; dst_words[6] = value; dst_words[7] = value;
+            dst_words += WORDS_PER_LINE;
+            length -= CAMERA_CONTROLLER_MEM_LINE_SIZE;
+        }
+
+        while (length >= sizeof(uint32_t)) {
+            *dst_words++ = value;
+            length -= sizeof(uint32_t);
+        }
+    }
+
+    dst_bytes = (volatile uint8_t *) dst_words;
+    while (length-- != 0) {
+        *dst_bytes++ = value >> shift;
+        shift = (shift + 8) & 31;
+    }
+}
+
+/*
+ * camera_controller_mem_compare
+ *
+ * Compares length bytes of the frame memory, read through the cache bypass,
+ * with buffer.
+ *
+ * Returns the offset of the first byte that differs, length if none does.
+ */
+uint32_t camera_controller_mem_compare(const void *frame, const void *buffer, uint32_t length) {
+    const volatile uint32_t *frame_words = (const volatile uint32_t *) uncached(frame);
+    const uint32_t *buffer_words = (const uint32_t *) buffer;
+    const volatile uint8_t *frame_bytes = NULL;
+    const uint8_t *buffer_bytes = NULL;
+    uint32_t offset = 0;
+
+    if (aligned(frame, buffer)) {
+        while ((length - offset >= sizeof(uint32_t)) && (*frame_words == *buffer_words)) {
+            frame_words++;
+            buffer_words++;
+            offset += sizeof(uint32_t);
+        }
+    }
+
+    /* tail, or the bytes of the first word that differs */
+    frame_bytes = (const volatile uint8_t *) frame_words;
+    buffer_bytes = (const uint8_t *) buffer_words;
+    while ((offset < length) && (*frame_bytes++ == *buffer_bytes++)) {
+        offset++;
+    }
+
+    return offset;
+}
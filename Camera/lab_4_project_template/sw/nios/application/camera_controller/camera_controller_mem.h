@@ -0,0 +1,41 @@
+#ifndef __CAMERA_CONTROLLER_MEM_H__
+#define __CAMERA_CONTROLLER_MEM_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+/*
+ * Bulk transfers between the CPU and the frame memory (behind the HPS
+ * bridges), which the controller writes behind the back of the data cache.
+ *
+ * frame is an address of the frame memory as seen by the CPU, for instance
+ * HPS_0_BRIDGES_BASE + frame_address, without the cache bypass bit. buffer is
+ * a normal (cached) buffer of the CPU. The transfers are made by words, 8 per
+ * step (a data cache line), when frame and buffer are word aligned.
+ *
+ *  - camera_controller_mem_read() reads the frame through the data cache, the
+ *    lines being filled by bursts, after having invalidated them.
+ *  - camera_controller_mem_map() invalidates the lines of a completed frame
+ *    and returns its cached address, so the pixel loops read it in place
+ *    with normal loads, a burst per line of the cache.
+ *  - camera_controller_mem_write(), camera_controller_mem_fill() and
+ *    camera_controller_mem_compare() go through the cache bypass: the
+ *    controller sees the data at once and no line is allocated.
+ */
+#define CAMERA_CONTROLLER_MEM_LINE_SIZE (32)
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+void camera_controller_mem_copy(void *dst, const void *src, uint32_t length);
+void camera_controller_mem_flush(const void *address, uint32_t length);
+void camera_controller_mem_read(void *buffer, const void *frame, uint32_t length);
+const void *camera_controller_mem_map(const void *frame, uint32_t length);
+void camera_controller_mem_write(void *frame, const void *buffer, uint32_t length);
+void camera_controller_mem_fill(void *frame, uint32_t value, uint32_t length);
+uint32_t camera_controller_mem_compare(const void *frame, const void *buffer, uint32_t length);
+
+#endif /* __CAMERA_CONTROLLER_MEM_H__ */
@@ -0,0 +1,131 @@
+#ifndef __CAMERA_CONTROLLER_REGS_H__
+#define __CAMERA_CONTROLLER_REGS_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+#include "camera_controller_io.h"
+
+/*
+ * All the registers are 8 bits wide, 32-bit values are split in 4 registers
+ * stored little-endian (least significant byte at the lowest offset).
+ */
+#define CAMERA_CONTROLLER_START_OFST                (0x00) /* RW */
+#define CAMERA_CONTROLLER_START_ADDRESS_OFST        (0x01) /* RW, 4 bytes */
+#define CAMERA_CONTROLLER_LENGTH_OFST               (0x05) /* RW, 4 bytes */
+#define CAMERA_CONTROLLER_RING_HEAD_OFST            (0x09) /* RO */
+#define CAMERA_CONTROLLER_RING_TAIL_OFST            (0x0A) /* RW */
+#define CAMERA_CONTROLLER_RING_SIZE_OFST            (0x0B) /* RW */
+#define CAMERA_CONTROLLER_RING_STRIDE_OFST          (0x0C) /* RW, 4 bytes */
+#define CAMERA_CONTROLLER_FORMAT_OFST               (0x10) /* RW, also sets LENGTH */
+#define CAMERA_CONTROLLER_COLOR_MATRIX_OFST         (0x20) /* RW, 9 coefficients of 2 bytes */
+#define CAMERA_CONTROLLER_COLOR_CONTROL_OFST        (0x32) /* RW */
+#define CAMERA_CONTROLLER_GAMMA_CHANNEL_OFST        (0x33) /* RW */
+#define CAMERA_CONTROLLER_GAMMA_INDEX_OFST          (0x34) /* RW, incremented by each write of GAMMA_DATA_HIGH */
+#define CAMERA_CONTROLLER_GAMMA_DATA_LOW_OFST       (0x35) /* WO */
+#define CAMERA_CONTROLLER_GAMMA_DATA_HIGH_OFST      (0x36) /* WO, writes the entry */
+#define CAMERA_CONTROLLER_FRAME_CRC_OFST            (0x38) /* RO, 4 bytes, CRC-32 of the buffer at the ring tail */
+#define CAMERA_CONTROLLER_MOTION_CONTROL_OFST       (0x40) /* RW */
+#define CAMERA_CONTROLLER_MOTION_PIXEL_OFST         (0x41) /* RW, pixel threshold */
+#define CAMERA_CONTROLLER_MOTION_BLOCK_OFST         (0x42) /* RW, block threshold */
+#define CAMERA_CONTROLLER_MOTION_ALARM_OFST         (0x44) /* RW, alarm threshold, 2 bytes */
+#define CAMERA_CONTROLLER_MOTION_STATUS_OFST        (0x46) /* RW, write 1 to clear */
+#define CAMERA_CONTROLLER_MOTION_CELLS_OFST         (0x48) /* RO, 2 bytes */
+#define CAMERA_CONTROLLER_MOTION_BLOCKS_OFST        (0x4A) /* RO, 2 bytes */
+#define CAMERA_CONTROLLER_MOTION_BITMAP_OFST        (0x50) /* RO, 38 bytes */
+
+#define CAMERA_CONTROLLER_REG_ADDR(base, ofst)      ((void *) ((uint8_t *) (base) + (ofst)))
+
+#define CAMERA_CONTROLLER_START_STOP                (0x00)
+#define CAMERA_CONTROLLER_START_START               (0x01)
+#define CAMERA_CONTROLLER_START_DESCRIPTOR_MSK      (0x02)
+#define CAMERA_CONTROLLER_START_TRAILER_MSK         (0x04)
+
+#define CAMERA_CONTROLLER_RING_INDEX_MSK            (0x7F)
+#define CAMERA_CONTROLLER_RING_WRAP_MSK             (0x80)
+#define CAMERA_CONTROLLER_RING_SIZE_MAX             (16)
+
+#define CAMERA_CONTROLLER_FORMAT_SCALE_MSK          (0x03)
+#define CAMERA_CONTROLLER_FORMAT_SCALE_OFST         (0)
+#define CAMERA_CONTROLLER_FORMAT_PIXEL_MSK          (0x0C)
+#define CAMERA_CONTROLLER_FORMAT_PIXEL_OFST         (2)
+#define CAMERA_CONTROLLER_FORMAT_DEMOSAIC_MSK       (0x10)
+#define CAMERA_CONTROLLER_FORMAT_DEMOSAIC_OFST      (4)
+#define CAMERA_CONTROLLER_FORMAT_REDUCTION_MSK      (0x60)
+#define CAMERA_CONTROLLER_FORMAT_REDUCTION_OFST     (5)
+
+#define CAMERA_CONTROLLER_COLOR_CONTROL_MATRIX_MSK  (0x01)
+#define CAMERA_CONTROLLER_COLOR_CONTROL_GAMMA_MSK   (0x02)
+#define CAMERA_CONTROLLER_COLOR_MATRIX_SIZE         (9)
+#define CAMERA_CONTROLLER_COLOR_MATRIX_ONE          (0x0100) /* 8 fractional bits */
+#define CAMERA_CONTROLLER_GAMMA_TABLE_SIZE          (256)
+#define CAMERA_CONTROLLER_GAMMA_DATA_HIGH_MSK       (0x0F)
+
+#define CAMERA_CONTROLLER_MOTION_ENABLE_MSK         (0x01)
+#define CAMERA_CONTROLLER_MOTION_UPDATE_MSK         (0x02)
+#define CAMERA_CONTROLLER_MOTION_IRQ_MSK            (0x04)
+#define CAMERA_CONTROLLER_MOTION_RESULT_MSK         (0x01)
+#define CAMERA_CONTROLLER_MOTION_ALARM_MSK          (0x02)
+#define CAMERA_CONTROLLER_MOTION_BLOCK_MAX          (15)
+
+/*
+ * Descriptors live in memory and are fetched by the controller at the start
+ * of each frame when the descriptor mode is enabled. They are 16 bytes wide and
+ * stored one after the other, one per buffer of the ring.
+ */
+#define CAMERA_CONTROLLER_DESC_ADDRESS_OFST         (0x00) /* RW, address of the buffer */
+#define CAMERA_CONTROLLER_DESC_LENGTH_OFST          (0x04) /* RW, bytes, multiple of 64 */
+#define CAMERA_CONTROLLER_DESC_FLAGS_OFST           (0x08) /* RW */
+#define CAMERA_CONTROLLER_DESC_STATUS_OFST          (0x0C) /* written back by the controller */
+#define CAMERA_CONTROLLER_DESC_SIZE                 (0x10)
+
+#define CAMERA_CONTROLLER_DESC_FLAGS_ID_MSK         (0x000000FF)
+#define CAMERA_CONTROLLER_DESC_STATUS_DONE_MSK      (0x00000001)
+#define CAMERA_CONTROLLER_DESC_STATUS_ID_MSK        (0x0000FF00)
+#define CAMERA_CONTROLLER_DESC_STATUS_ID_SHFT       (8)
+
+#define CAMERA_CONTROLLER_DESC_ADDR(table, index, ofst) \
+    CAMERA_CONTROLLER_REG_ADDR((table), (index) * CAMERA_CONTROLLER_DESC_SIZE + (ofst))
+#define CAMERA_CONTROLLER_WR_DESC(table, index, ofst, data) \
+    camera_controller_write_word(CAMERA_CONTROLLER_DESC_ADDR((table), (index), (ofst)), (data))
+#define CAMERA_CONTROLLER_RD_DESC(table, index, ofst) \
+    camera_controller_read_word(CAMERA_CONTROLLER_DESC_ADDR((table), (index), (ofst)))
+
+/*
+ * When enabled, the controller writes a 16 bytes trailer right after each
+ * frame (at the address of the buffer + the length of a frame), before the
+ * buffer is given to the firmware.
+ */
+#define CAMERA_CONTROLLER_TRAILER_FRAME_OFST        (0x00) /* camera frame of the first burst */
+#define CAMERA_CONTROLLER_TRAILER_TIMESTAMP_OFST    (0x04) /* main clock cycles at the first burst */
+#define CAMERA_CONTROLLER_TRAILER_DROPPED_OFST      (0x08) /* lines not captured since the previous trailer */
+#define CAMERA_CONTROLLER_TRAILER_INFO_OFST         (0x0C)
+#define CAMERA_CONTROLLER_TRAILER_SIZE              (0x10)
+
+#define CAMERA_CONTROLLER_TRAILER_INFO_FORMAT_MSK   (0x000000FF)
+#define CAMERA_CONTROLLER_TRAILER_INFO_ID_MSK       (0x0000FF00)
+#define CAMERA_CONTROLLER_TRAILER_INFO_ID_SHFT      (8)
+#define CAMERA_CONTROLLER_TRAILER_INFO_MAGIC_MSK    (0xFFFF0000)
+#define CAMERA_CONTROLLER_TRAILER_INFO_MAGIC_SHFT   (16)
+#define CAMERA_CONTROLLER_TRAILER_MAGIC             (0xCA3E)
+
+#define CAMERA_CONTROLLER_RD_TRAILER(frame, length, ofst) \
+    camera_controller_read_word(CAMERA_CONTROLLER_REG_ADDR((frame), (length) + (ofst)))
+
+#define CAMERA_CONTROLLER_WR_REG(base, ofst, data)  camera_controller_write_byte(CAMERA_CONTROLLER_REG_ADDR((base), (ofst)), (data))
+#define CAMERA_CONTROLLER_RD_REG(base, ofst)        camera_controller_read_byte(CAMERA_CONTROLLER_REG_ADDR((base), (ofst)))
+
+#define CAMERA_CONTROLLER_WR_START(base, data)      CAMERA_CONTROLLER_WR_REG((base), CAMERA_CONTROLLER_START_OFST, (data))
+#define CAMERA_CONTROLLER_WR_RING_TAIL(base, data)  CAMERA_CONTROLLER_WR_REG((base), CAMERA_CONTROLLER_RING_TAIL_OFST, (data))
+#define CAMERA_CONTROLLER_WR_RING_SIZE(base, data)  CAMERA_CONTROLLER_WR_REG((base), CAMERA_CONTROLLER_RING_SIZE_OFST, (data))
+#define CAMERA_CONTROLLER_WR_FORMAT(base, data)     CAMERA_CONTROLLER_WR_REG((base), CAMERA_CONTROLLER_FORMAT_OFST, (data))
+#define CAMERA_CONTROLLER_RD_START(base)            CAMERA_CONTROLLER_RD_REG((base), CAMERA_CONTROLLER_START_OFST)
+#define CAMERA_CONTROLLER_RD_RING_HEAD(base)        CAMERA_CONTROLLER_RD_REG((base), CAMERA_CONTROLLER_RING_HEAD_OFST)
+#define CAMERA_CONTROLLER_RD_RING_TAIL(base)        CAMERA_CONTROLLER_RD_REG((base), CAMERA_CONTROLLER_RING_TAIL_OFST)
+#define CAMERA_CONTROLLER_RD_RING_SIZE(base)        CAMERA_CONTROLLER_RD_REG((base), CAMERA_CONTROLLER_RING_SIZE_OFST)
+#define CAMERA_CONTROLLER_RD_FORMAT(base)           CAMERA_CONTROLLER_RD_REG((base), CAMERA_CONTROLLER_FORMAT_OFST)
+
+#endif /* __CAMERA_CONTROLLER_REGS_H__ */
@@ -23,21 +23,71 @@
 
 #include "cmos_sensor_output_generator/cmos_sensor_output_generator.h"
 #include "cmos_sensor_output_generator/cmos_sensor_output_generator_regs.h"
+#include "camera_controller/camera_controller.h"
+#include "camera_controller/camera_controller_crc.h"
+#include "camera_controller/camera_controller_compress.h"
+#include "camera_controller/camera_controller_mem.h"
+#include "camera_controller/camera_controller_dma.h"
+#include "profiler/profiler.h"
+#include "trace/trace.h"
+#include "logger/logger.h"
+#include "pool/pool.h"
+#include "irq_latency/irq_latency.h"
 #include "io.h"
+#include "sys/ioctl.h"
+#include "sys/alt_stdio.h"
 #include "system.h"
 
 #define ONE_KB (1024)
 #define ONE_FRAME (320*240*2)
+#define ONE_BUFFER (ONE_FRAME + 64) // frame + trailer, multiple of a burst
+#define NB_FRAMES (3)
+#define SNAPSHOT_ADDRESS (NB_FRAMES * ONE_BUFFER) // after the ring
+#define COMPRESSED_ADDRESS (SNAPSHOT_ADDRESS + ONE_BUFFER)
+#define EXPORT_BUFFER_SIZE (2 * ONE_KB) // buffer of an exported file
+#define NB_EXPORT_BUFFERS (2)
+
+//THE LAST 8 KB OF THE MEMORY BEHIND THE BRIDGES HOLD THE TRANSMIT RING OF THE JTAG UART (public.mk)
+#if defined(ALTERA_AVALON_JTAG_UART_TX_BUF_BASE) && (HPS_0_BRIDGES_BASE + COMPRESSED_ADDRESS + ONE_BUFFER > ALTERA_AVALON_JTAG_UART_TX_BUF_BASE)
+#error "The frames overlap the transmit ring of the JTAG UART"
+#endif
+
+//#define DUMP_COMPRESSED // dump /mnt/host/frameN.ccz (ImageConverter/python, decompress()) instead of dataN.txt
+
+//LOG OF THE MOTION ALARMS, CALLED BY THE INTERRUPT HANDLER OF THE CAMERA CONTROLLER
+static void motion_alarm(camera_controller_dev *dev, const camera_controller_motion *motion, void *context)
+{
+	(void) dev;
+	(void) context;
+	LOG("Motion alarm: %" PRIu16 " cells, %" PRIu16 " blocks\n", motion->changed_cells, motion->changed_blocks);
+}
 
 int main()
 {
+#if defined(TRACE_TIMER_BASE) && defined(TRACE_TIMER_IRQ)
+	//INTERRUPT ENTRY LATENCY, ON THE TRACE TIMER BEFORE IT RUNS FREE (5000 CYCLES PERIOD)
+	irq_latency latency;
+	if (irq_latency_measure((void *) TRACE_TIMER_BASE, TRACE_TIMER_IRQ_INTERRUPT_CONTROLLER_ID, TRACE_TIMER_IRQ, 5000, 1000, &latency))
+	{
+		printf("IRQ latency = %" PRIu32 " min, %" PRIu32 " avg, %" PRIu32 " max cycles \n", latency.min, latency.sum / latency.count, latency.max);
+	}
+#endif
+
+	trace_init();
+
 	//FILE* test;
 	//test = fopen("/mnt/host/test.txt","w");
 
-	for (uint32_t i = 0; i < ONE_FRAME; i += sizeof(uint16_t))
+	uint16_t line[320];
+	for (uint32_t i = 0; i < ONE_FRAME; i += sizeof(line))
 	{
-		// Write through address span expander
-		IOWR_16DIRECT(HPS_0_BRIDGES_BASE, i, i);
+		for (uint32_t j = 0; j < 320; j++)
+		{
+			line[j] = i + j * sizeof(uint16_t);
+		}
+
+		// Write through address span expander, one line at a time
+		camera_controller_mem_write((void *) (HPS_0_BRIDGES_BASE + i), line, sizeof(line));
 
 		// Read through address span expander
 		//uint16_t readdata = IORD_16DIRECT(HPS_0_BRIDGES_BASE, i);
@@ -64,99 +114,176 @@ int main()
 	printf("CMOS Config = %d \n", config_success);
 
 	//CAMERA CONTROLLER INITIALISATION
-	//Stop the camera controller
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x0, 0x00);
-	//Start Address = 0x00000000
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x1, 0x00);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x2, 0x00);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x3, 0x00);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x4, 0x00);
-	//Length = 320*240*2 = 0x00025800
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x5, 0x00);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x6, 0x58);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x7, 0x02);
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x8, 0x00);
-	//Reset the status register
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9, 0x00);
-
-	//READ THE REGISTERS
-	printf("Start = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x0));
-	printf("StartAddress_1 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x1));
-	printf("StartAddress_2 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x2));
-	printf("StartAddress_3 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x3));
-	printf("StartAddress_4 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x4));
-	printf("Length_1 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x5));
-	printf("Length_2 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x6));
-	printf("Length_3 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x7));
-	printf("Length_4 = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x8));
-	printf("Status = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9));
+	//Ring of 3 buffers of 320*240*2 = 0x00025800 bytes followed by a trailer, starting at 0x00000000
+	camera_controller_dev camera_controller = CAMERA_CONTROLLER_INST(CAMERA_CONTROLLER_0);
+	camera_controller_init(&camera_controller);
+	bool ring_success = camera_controller_configure(&camera_controller,
+													0x00000000,
+													ONE_FRAME,
+													ONE_BUFFER,
+													NB_FRAMES) &&
+						camera_controller_enable_trailer(&camera_controller, true);
+
+	printf("Ring Config = %d \n", ring_success);
+
+	//MOTION DETECTION BETWEEN CONSECUTIVE FRAMES, ALARM ABOVE 5% OF THE CELLS
+	camera_controller_motion motion;
+	camera_controller_motion_configure(&camera_controller, 16, 4, CAMERA_CONTROLLER_MOTION_CELLS / 20);
+	camera_controller_motion_enable(&camera_controller, true, true);
+	camera_controller_motion_set_callback(&camera_controller, motion_alarm, NULL);
+	bool motion_irq = camera_controller_motion_register_irq(&camera_controller,
+															 CAMERA_CONTROLLER_0_IRQ_INTERRUPT_CONTROLLER_ID,
+															 CAMERA_CONTROLLER_0_IRQ);
+
+	printf("Motion IRQ = %d \n", motion_irq);
 
 	//START EVERYTHING
 	cmos_sensor_output_generator_start(&cmos_sensor_output_generator);
 	usleep(5000); // Sleep a bit not to begin at the beginning of a frame
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x0, 0x01);
+	TRACE_BEGIN(TRACE_ID_FRAME_CAPTURE);
+	camera_controller_start(&camera_controller);
 
-	//WAIT FOR THE ACQUISITION
-	printf("Status = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9));
+	//WAIT FOR THE ACQUISITION, THE CONTROLLER STOPS BY ITSELF WHEN THE RING IS FULL
+	uint8_t frames_ready = 0;
+	while (frames_ready != NB_FRAMES)
+	{
+		uint8_t ready = camera_controller_frames_ready(&camera_controller);
+		if (ready != frames_ready)
+		{
+			TRACE_END(TRACE_ID_FRAME_CAPTURE);
+			if (ready != NB_FRAMES)
+			{
+				TRACE_BEGIN(TRACE_ID_FRAME_CAPTURE);
+			}
+			frames_ready = ready;
+			LOG("Frames ready = %" PRIu8 "\n", frames_ready);
+		}
+		if (!motion_irq && camera_controller_motion_poll(&camera_controller, &motion))
+		{
+			LOG("Motion: %" PRIu16 " cells, %" PRIu16 " blocks, alarm %d\n",
+				motion.changed_cells, motion.changed_blocks, motion.alarm);
+		}
+	}
 
-	while(IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9) != 0x00000001) {}
-	printf("Status = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9));
+	//STOP EVERYTHING
+	camera_controller_stop(&camera_controller);
+	cmos_sensor_output_generator_stop(&cmos_sensor_output_generator);
 
-	while(IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9) != 0x00000003) {}
-	printf("Status = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9));
+	//FRAME COPIES BY THE DMA, BY THE CPU IF THE SYSTEM HAS NO DMA
+	camera_controller_dma_dev dma;
+#ifdef DMA_0_NAME
+	bool dma_success = camera_controller_dma_init(&dma, DMA_0_NAME);
+#else
+	bool dma_success = camera_controller_dma_init(&dma, NULL);
+#endif
 
-	while(IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9) != 0x00000007) {}
-	printf("Status = %" PRIu8 "\n", IORD_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x9));
+	printf("DMA = %d \n", dma_success);
 
-	//STOP EVERYTHING
-	IOWR_8DIRECT(CAMERA_CONTROLLER_0_BASE, 0x0, 0x00);
-	cmos_sensor_output_generator_stop(&cmos_sensor_output_generator);
+	//BUFFERS OF THE EXPORTED FILES FROM A POOL, NOT FROM THE HEAP BY FOPEN
+	static uint32_t export_memory[POOL_MEMORY_SIZE(EXPORT_BUFFER_SIZE, NB_EXPORT_BUFFERS) / sizeof(uint32_t)];
+	pool export_buffers;
+	pool_init(&export_buffers, export_memory, EXPORT_BUFFER_SIZE, NB_EXPORT_BUFFERS);
 
 	//READ THE FRAMES IN THE MEMORY
-	FILE* data;
-	data = fopen("/mnt/host/data.txt","w");
-
-	uint16_t readdata = 0;
-	for (uint32_t i = 0; i < ONE_FRAME; i += sizeof(uint16_t))
+	void *snapshot = (void *) (HPS_0_BRIDGES_BASE + SNAPSHOT_ADDRESS);
+	char filename[32];
+	uint32_t frame_address = 0;
+	camera_controller_trailer trailer;
+	uint32_t crc = 0;
+	for (uint32_t frame = 1; camera_controller_get_frame(&camera_controller, &frame_address); frame++)
 	{
-		// Read through address span expander
-		readdata = IORD_16DIRECT(HPS_0_BRIDGES_BASE, i);
-		fprintf(data, "%" PRIu16 "\n", readdata);
-		//fprintf(data, "%" PRIu32 " : %" PRIu16 "\n", i, readdata);
-	}
+		TRACE_BEGIN(TRACE_ID_FRAME_CHECK);
+		if (camera_controller_get_trailer(&camera_controller, (void *) (HPS_0_BRIDGES_BASE + frame_address), &trailer))
+		{
+			LOG("FRAME %" PRIu32 ": camera frame %" PRIu32 ", timestamp %" PRIu32 ", %" PRIu32 " dropped lines\n",
+				frame, trailer.frame, trailer.timestamp, trailer.dropped_lines);
+		}
 
-	fclose(data);
-	printf("FRAME 1 FINISHED \n");
+		// Check the frame against the CRC of the controller, read through the data cache
+		if (camera_controller_get_crc(&camera_controller, &crc))
+		{
+			const void *pixels = camera_controller_mem_map((void *) (HPS_0_BRIDGES_BASE + frame_address), ONE_FRAME);
+			uint32_t check = camera_controller_crc32(CAMERA_CONTROLLER_CRC_INIT, pixels, ONE_FRAME);
+			LOG("FRAME %" PRIu32 ": CRC 0x%08" PRIx32 ", computed 0x%08" PRIx32 "\n", frame, crc, check);
+		}
+		TRACE_END(TRACE_ID_FRAME_CHECK);
 
-	FILE* data2;
-	data2 = fopen("/mnt/host/data2.txt","w");
+		// Copy the frame out of the ring and give the buffer back to the controller before the dump
+		TRACE_BEGIN(TRACE_ID_FRAME_COPY);
+		camera_controller_dma_copy(&dma, snapshot, (void *) (HPS_0_BRIDGES_BASE + frame_address), ONE_FRAME, NULL, NULL);
+		camera_controller_dma_wait(&dma);
+		camera_controller_release_frame(&camera_controller);
+		TRACE_END(TRACE_ID_FRAME_COPY);
 
-	readdata = 0;
-	for (uint32_t i = 0; i < ONE_FRAME; i += sizeof(uint16_t))
-	{
-		// Read through address span expander
-		readdata = IORD_16DIRECT(HPS_0_BRIDGES_BASE + 0x00025800, i);
-		fprintf(data2, "%" PRIu16 "\n", readdata);
-		//fprintf(data, "%" PRIu32 " : %" PRIu16 "\n", i, readdata);
-	}
+		void *buffer = pool_alloc(&export_buffers);
 
-	fclose(data2);
-	printf("FRAME 2 FINISHED \n");
+#ifdef DUMP_COMPRESSED
+		// Compress the frame after the ring, read through the data cache and written through the cache bypass
+		TRACE_BEGIN(TRACE_ID_COMPRESS);
+		void *compressed = (void *) ((HPS_0_BRIDGES_BASE + COMPRESSED_ADDRESS) | ALT_CPU_DCACHE_BYPASS_MASK);
+		uint32_t size = camera_controller_compress(camera_controller_mem_map(snapshot, ONE_FRAME), 320, 240,
+												   camera_controller_get_pixel_format(&camera_controller),
+												   compressed, CAMERA_CONTROLLER_COMPRESS_BOUND(320, 240));
+		TRACE_END(TRACE_ID_COMPRESS);
+		LOG("FRAME %" PRIu32 ": %" PRIu32 " bytes compressed\n", frame, size);
 
-	FILE* data3;
-	data3 = fopen("/mnt/host/data3.txt","w");
+		TRACE_BEGIN(TRACE_ID_EXPORT);
+		snprintf(filename, sizeof(filename), "/mnt/host/frame%" PRIu32 ".ccz", frame);
+		FILE* data = fopen(filename, "wb");
+		setvbuf(data, buffer, (buffer != NULL) ? _IOFBF : _IONBF, EXPORT_BUFFER_SIZE);
+		fwrite(compressed, 1, size, data);
+#else
+		TRACE_BEGIN(TRACE_ID_EXPORT);
+		snprintf(filename, sizeof(filename), "/mnt/host/data%" PRIu32 ".txt", frame);
+		FILE* data = fopen(filename, "w");
+		setvbuf(data, buffer, (buffer != NULL) ? _IOFBF : _IONBF, EXPORT_BUFFER_SIZE);
+		char text[320 * 6 + 1]; // "65535\n" per pixel of a line
 
-	readdata = 0;
-	for (uint32_t i = 0; i < ONE_FRAME; i += sizeof(uint16_t))
-	{
-		// Read through address span expander
-		readdata = IORD_16DIRECT(HPS_0_BRIDGES_BASE + 0x0004B000, i);
-		fprintf(data3, "%" PRIu16 "\n", readdata);
-		//fprintf(data, "%" PRIu32 " : %" PRIu16 "\n", i, readdata);
+		// Read in place through address span expander and the data cache
+		const uint16_t *pixels = camera_controller_mem_map(snapshot, ONE_FRAME);
+		for (uint32_t i = 0; i < ONE_FRAME / sizeof(uint16_t); i += 320)
+		{
+			// One pixel per text line, converted without division (no hardware divider)
+			uint32_t length = 0;
+			for (uint32_t j = 0; j < 320; j++)
+			{
+				length += alt_utoa(pixels[i + j], text + length);
+				text[length++] = '\n';
+			}
+			fwrite(text, 1, length, data);
+		}
+#endif
+
+		fclose(data);
+		if (buffer != NULL)
+		{
+			pool_free(&export_buffers, buffer);
+		}
+		TRACE_END(TRACE_ID_EXPORT);
+		LOG("FRAME %" PRIu32 " FINISHED \n", frame);
 	}
 
-	fclose(data3);
-	printf("FRAME 3 FINISHED \n");
+#ifdef ALT_PROVIDE_GMON
+	//PROFILE OF THE CAPTURE AND THE EXPORT (nios2-elf-gprof camera_controller.elf gmon.out)
+	printf("Profile = %d, %" PRIu32 " calls dropped \n", profiler_write_gmon("/mnt/host/gmon.out"), profiler_dropped_calls());
+#endif
+
+#ifdef TRACE_ENABLE
+	//TIMELINE OF THE CAPTURE AND THE EXPORT (ImageConverter/python/tracetojson.py)
+	printf("Trace = %d \n", trace_write("/mnt/host/trace.bin"));
+#endif
+
+	printf("Export buffers = %" PRIu32 " used at most, %" PRIu32 " failures \n", export_buffers.high_water, export_buffers.failures);
+
+	//MESSAGES OF THE CAPTURE AND THE EXPORT (ImageConverter/python/logtotext.py)
+	printf("Log = %d, %" PRIu32 " records dropped \n", logger_write("/mnt/host/log.bin"), logger_dropped());
+
+#ifdef TIOCGDROPPED
+	//CONSOLE OUTPUT LOST INSTEAD OF WAITING FOR THE HOST
+	unsigned int dropped = 0;
+	ioctl(STDOUT_FILENO, TIOCGDROPPED, &dropped);
+	printf("Console = %u bytes dropped \n", dropped);
+#endif
 
 	printf("FRAMES COMPUTED !!!");
 	return EXIT_SUCCESS;
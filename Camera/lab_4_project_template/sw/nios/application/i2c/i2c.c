@@ -9,6 +9,7 @@
 
 #include "i2c.h"
 #include "i2c_regs.h"
+#include "../trace/trace.h"
 
 #define I2C_SLEEP_US (5000)
 
@@ -46,9 +47,11 @@ static void wait_end_of_transfer(i2c_dev *dev) {
  */
 static void set_data_control(i2c_dev *dev, uint8_t data, uint8_t control) {
     wait_end_of_transfer(dev);
+    TRACE_BEGIN(TRACE_ID_I2C);
     I2C_WR_DATA(dev->base, data);
     I2C_WR_CONTROL(dev->base, control);
     wait_end_of_transfer(dev);
+    TRACE_END(TRACE_ID_I2C);
 }
 
 /*
@@ -59,8 +62,10 @@ static void set_data_control(i2c_dev *dev, uint8_t data, uint8_t control) {
  */
 static uint8_t get_data_set_control(i2c_dev *dev, uint8_t control) {
     wait_end_of_transfer(dev);
+    TRACE_BEGIN(TRACE_ID_I2C);
     I2C_WR_CONTROL(dev->base, control);
     wait_end_of_transfer(dev);
+    TRACE_END(TRACE_ID_I2C);
     return I2C_RD_DATA(dev->base);
 }
 
@@ -0,0 +1,135 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "sys/alt_irq.h"
+#include "altera_avalon_timer_regs.h"
+#endif
+
+#include "irq_latency.h"
+#include "../sections/sections.h"
+
+#ifdef __nios2_arch__
+/* State shared with the handler during a measurement */
+typedef struct irq_latency_context {
+    void                 *base;
+    uint32_t             reload;     /* Count of the timer when it interrupts */
+    uint32_t             samples;
+    irq_latency          *result;
+    volatile uint32_t    count;      /* Latencies measured */
+} irq_latency_context;
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static void timer_isr(void *context);
+
+/*
+ * timer_isr
+ *
+ * Interrupt handler of the timer: the snapshot is taken first, the timer
+ * reloaded its period when it interrupted and has been counting down since.
+ */
+static void ALT_HOT_TEXT timer_isr(void *context) {
+    irq_latency_context *ctx = (irq_latency_context *) context;
+    irq_latency *result = ctx->result;
+    uint32_t snapshot = 0;
+    uint32_t latency = 0;
+
+    IOWR_ALTERA_AVALON_TIMER_SNAPL(ctx->base, 0);
+    snapshot = ((uint32_t) IORD_ALTERA_AVALON_TIMER_SNAPH(ctx->base) << 16) |
+               ((uint32_t) IORD_ALTERA_AVALON_TIMER_SNAPL(ctx->base) & 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(ctx->base, 0);
+
+    latency = ctx->reload - snapshot;
+    if (latency < result->min) {
+        result->min = latency;
+    }
+    if (latency > result->max) {
+        result->max = latency;
+    }
+    result->sum += latency;
+    result->count++;
+
+    if (result->count == ctx->samples) {
+        IOWR_ALTERA_AVALON_TIMER_CONTROL(ctx->base, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    }
+    ctx->count = result->count;
+}
+#endif
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * irq_latency_measure
+ *
+ * Measures the entry latency of samples interrupts of the timer at
+ * timer_base, one every period clock cycles (larger than the latency and the
+ * handler, samples * period < 2^32). Use the
+ * <prefix>_BASE, <prefix>_IRQ_INTERRUPT_CONTROLLER_ID and <prefix>_IRQ values
+ * of system.h. The interrupts must be enabled.
+ *
+ * Returns true if successful, and false otherwise (interrupt sender not
+ * connected, irq < 0, or the interrupts did not come).
+ */
+bool irq_latency_measure(void *timer_base, int ic_id, int irq, uint32_t period, uint32_t samples, irq_latency *result) {
+#ifdef __nios2_arch__
+    irq_latency_context ctx;
+    uint32_t spins = 0;
+
+    if ((irq < 0) || (ic_id < 0) || (period < 2) || (samples == 0)) {
+        return false;
+    }
+
+    result->min = UINT32_MAX;
+    result->max = 0;
+    result->sum = 0;
+    result->count = 0;
+
+    ctx.base = timer_base;
+    ctx.reload = period - 1;
+    ctx.samples = samples;
+    ctx.result = result;
+    ctx.count = 0;
+
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(timer_base, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(timer_base, (period - 1) & 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(timer_base, (period - 1) >> 16);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(timer_base, 0);
+
+    if (alt_ic_isr_register(ic_id, irq, timer_isr, &ctx, NULL) != 0) {
+        return false;
+    }
+
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(timer_base,
+                                     ALTERA_AVALON_TIMER_CONTROL_ITO_MSK |
+                                     ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                     ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+
+    /* an iteration takes more than a cycle, the wait is bounded by samples periods */
+    while ((ctx.count < samples) && (spins < samples * period)) {
+        spins++;
+    }
+
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(timer_base, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(timer_base, 0);
+    alt_ic_isr_register(ic_id, irq, NULL, NULL, NULL);
+
+    return ctx.count == samples;
+#else
+    (void) timer_base;
+    (void) ic_id;
+    (void) irq;
+    (void) period;
+    (void) samples;
+    (void) result;
+
+    return false;
+#endif
+}
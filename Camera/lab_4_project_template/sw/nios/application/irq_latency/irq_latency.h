@@ -0,0 +1,41 @@
+#ifndef __IRQ_LATENCY_H__
+#define __IRQ_LATENCY_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+/*
+ * Measurement of the interrupt entry latency: the clock cycles from the
+ * request of an interval timer (altera_avalon_timer, clocked by the CPU
+ * clock) to the first access of its handler to the timer, which takes a
+ * snapshot of the count. They include the end of the interrupted
+ * instruction, the exception entry (alt_exception_entry.S saves the
+ * registers), the dispatch of alt_irq_handler() and the prologue of the
+ * handler.
+ *
+ * The timer interrupts every period cycles until samples latencies are
+ * measured, then it is stopped and its handler removed: use a timer which is
+ * not running, for instance the trace_timer before trace_init().
+ * alt_irq_handler() finds the lowest pending interrupt with a multiplication
+ * and a table lookup, so the dispatch takes the same time whatever the
+ * number of the interrupt. The number only decides the order of interrupts
+ * pending together, after the ALT_IRQ_FAST_IRQ of the BSP, which is tested
+ * first and adds a few cycles to the dispatch of the others.
+ */
+typedef struct irq_latency {
+    uint32_t min;            /* Clock cycles */
+    uint32_t max;
+    uint32_t sum;
+    uint32_t count;          /* Latencies measured */
+} irq_latency;
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+bool irq_latency_measure(void *timer_base, int ic_id, int irq, uint32_t period, uint32_t samples, irq_latency *result);
+
+#endif /* __IRQ_LATENCY_H__ */
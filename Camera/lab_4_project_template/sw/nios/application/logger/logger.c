@@ -0,0 +1,122 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "sys/alt_irq.h"
+#endif
+
+#include "logger.h"
+#include "../sections/sections.h"
+
+/* Header of the exported file: "CCLG", version, number of words, dropped
+ * records. A record is the address of the format, the number of arguments
+ * and the arguments. */
+#define LOGGER_MAGIC    (0x474C4343)
+#define LOGGER_VERSION  (1)
+
+#define LOGGER_MASK     (LOGGER_WORDS - 1)
+
+/* Records are written with the interrupts disabled */
+#ifdef __nios2_arch__
+#define LOGGER_LOCK()   alt_irq_context context = alt_irq_disable_all()
+#define LOGGER_UNLOCK() alt_irq_enable_all(context)
+#else
+#define LOGGER_LOCK()
+#define LOGGER_UNLOCK()
+#endif
+
+/* Indexes of the next word to write and to export, they only wrap around 2^32 */
+static uint32_t logger_ring[LOGGER_WORDS] ALT_FAST_DATA;
+static volatile uint32_t logger_head ALT_FAST_DATA = 0;
+static volatile uint32_t logger_tail = 0;
+static volatile uint32_t logger_dropped_records = 0;
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * logger_record
+ *
+ * Records format and its nargs arguments, use LOG() which counts them. The
+ * interrupts are disabled while the record is written.
+ */
+void ALT_HOT_TEXT logger_record(const char *format, uint32_t nargs, ...) {
+    va_list args;
+    uint32_t head = 0;
+    uint32_t i = 0;
+    LOGGER_LOCK();
+
+    head = logger_head;
+    if (logger_head - logger_tail > LOGGER_WORDS - 2 - nargs) {
+        logger_dropped_records++;
+    } else {
+        logger_ring[head++ & LOGGER_MASK] = (uint32_t) (uintptr_t) format;
+        logger_ring[head++ & LOGGER_MASK] = nargs;
+
+        va_start(args, nargs);
+        for (i = 0; i < nargs; i++) {
+            logger_ring[head++ & LOGGER_MASK] = va_arg(args, unsigned int);
+        }
+        va_end(args);
+
+        logger_head = head;
+    }
+
+    LOGGER_UNLOCK();
+}
+
+/*
+ * logger_write
+ *
+ * Writes the header and the records logged since the previous call to
+ * filename (for instance "/mnt/host/log.bin"), then empties the ring. The
+ * words are written in the byte order of the CPU (little-endian). Records
+ * logged meanwhile, by an interrupt handler, are kept for the next call.
+ *
+ * Returns false if the file could not be written, the records are kept.
+ */
+bool logger_write(const char *filename) {
+    uint32_t head = logger_head;
+    uint32_t tail = logger_tail;
+    uint32_t count = head - tail;
+    uint32_t first = tail & LOGGER_MASK;
+    uint32_t header[4] = {LOGGER_MAGIC, LOGGER_VERSION, count, logger_dropped_records};
+    FILE *file = fopen(filename, "wb");
+    bool success = false;
+
+    if (file == NULL) {
+        return false;
+    }
+
+    /* the records from the oldest word to the end of the ring, then from its start */
+    success = (fwrite(header, sizeof(uint32_t), 4, file) == 4);
+    if (first + count > LOGGER_WORDS) {
+        success = success &&
+                  (fwrite(&logger_ring[first], sizeof(uint32_t), LOGGER_WORDS - first, file) == LOGGER_WORDS - first) &&
+                  (fwrite(&logger_ring[0], sizeof(uint32_t), first + count - LOGGER_WORDS, file) == first + count - LOGGER_WORDS);
+    } else {
+        success = success && (fwrite(&logger_ring[first], sizeof(uint32_t), count, file) == count);
+    }
+
+    success = (fclose(file) == 0) && success;
+    if (success) {
+        logger_tail = head;
+    }
+
+    return success;
+}
+
+/*
+ * logger_dropped
+ *
+ * Returns the number of records dropped because the ring was full.
+ */
+uint32_t logger_dropped(void) {
+    return logger_dropped_records;
+}
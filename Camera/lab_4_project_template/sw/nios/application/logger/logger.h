@@ -0,0 +1,43 @@
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+/*
+ * Deferred logging: LOG(format, ...) records the address of the format string
+ * and the raw arguments in a ring of LOGGER_WORDS words, nothing is formatted
+ * on the target. logger_write() exports the records and
+ * ImageConverter/python/logtotext.py prints the text, reading the format
+ * strings from the ELF file of the application.
+ *
+ * The format must be a string literal with at most LOGGER_MAX_ARGS
+ * conversions of 32-bit values (d, i, u, x, X, o, c, p with flags, width and
+ * precision; no s, no 64-bit conversions), one argument per conversion.
+ *
+ * A record which does not fit in the ring is dropped and counted, the ring
+ * is emptied by logger_write(). LOG() can be called from interrupt handlers.
+ */
+#ifndef LOGGER_WORDS
+#define LOGGER_WORDS        (1024)      /* a power of two */
+#endif
+
+#define LOGGER_MAX_ARGS     (8)
+
+#define LOGGER_NARGS(...)   LOGGER_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOGGER_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define LOG(format, ...)    logger_record(format, LOGGER_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+void logger_record(const char *format, uint32_t nargs, ...);
+bool logger_write(const char *filename);
+uint32_t logger_dropped(void);
+
+#endif /* __LOGGER_H__ */
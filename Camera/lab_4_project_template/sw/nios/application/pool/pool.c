@@ -0,0 +1,142 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "sys/alt_irq.h"
+#endif
+
+#include "pool.h"
+
+/* The lists are changed with the interrupts disabled */
+#ifdef __nios2_arch__
+#define POOL_LOCK()     alt_irq_context context = alt_irq_disable_all()
+#define POOL_UNLOCK()   alt_irq_enable_all(context)
+#else
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+#endif
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * pool_init
+ *
+ * Makes a pool of num_blocks blocks of block_size bytes (rounded up to a
+ * multiple of 4) in memory, POOL_MEMORY_SIZE(block_size, num_blocks) bytes
+ * aligned on a word.
+ *
+ * Returns false if memory is not aligned or there is no block.
+ */
+bool pool_init(pool *p, void *memory, uint32_t block_size, uint32_t num_blocks) {
+    uint32_t size = POOL_MEMORY_SIZE(block_size, 1);
+    uint8_t *block = (uint8_t *) memory;
+    uint32_t i = 0;
+
+    if ((((uintptr_t) memory & 0x3) != 0) || (num_blocks == 0) || (block_size == 0)) {
+        return false;
+    }
+
+    /* link the blocks in the order of the memory */
+    for (i = 0; i < num_blocks - 1; i++) {
+        *(void **) (block + i * size) = block + (i + 1) * size;
+    }
+    *(void **) (block + i * size) = NULL;
+
+    p->free = memory;
+    p->start = block;
+    p->end = block + num_blocks * size;
+    p->block_size = size;
+    p->num_blocks = num_blocks;
+    p->used = 0;
+    p->high_water = 0;
+    p->failures = 0;
+
+    return true;
+}
+
+/*
+ * pool_alloc
+ *
+ * Returns a block of the pool, NULL if none is free.
+ */
+void *pool_alloc(pool *p) {
+    void *block = NULL;
+    POOL_LOCK();
+
+    block = p->free;
+    if (block != NULL) {
+        p->free = *(void **) block;
+        p->used++;
+        if (p->used > p->high_water) {
+            p->high_water = p->used;
+        }
+    } else {
+        p->failures++;
+    }
+
+    POOL_UNLOCK();
+    return block;
+}
+
+/*
+ * pool_free
+ *
+ * Gives block back to the pool it was allocated from.
+ */
+void pool_free(pool *p, void *block) {
+    POOL_LOCK();
+
+    *(void **) block = p->free;
+    p->free = block;
+    p->used--;
+
+    POOL_UNLOCK();
+}
+
+/*
+ * pool_alloc_size
+ *
+ * Returns a block of at least size bytes from the first of the pools, sorted
+ * by increasing block size, which has one free. A pool without free block
+ * counts a failure.
+ *
+ * Returns NULL if no pool has a free block large enough.
+ */
+void *pool_alloc_size(pool *pools, uint32_t num_pools, uint32_t size) {
+    void *block = NULL;
+    uint32_t i = 0;
+
+    for (i = 0; (i < num_pools) && (block == NULL); i++) {
+        if (pools[i].block_size >= size) {
+            block = pool_alloc(&pools[i]);
+        }
+    }
+
+    return block;
+}
+
+/*
+ * pool_free_any
+ *
+ * Gives block back to the pool, among pools, whose memory holds it.
+ *
+ * Returns false if none does.
+ */
+bool pool_free_any(pool *pools, uint32_t num_pools, void *block) {
+    uint32_t i = 0;
+
+    for (i = 0; i < num_pools; i++) {
+        if (((uint8_t *) block >= pools[i].start) && ((uint8_t *) block < pools[i].end)) {
+            pool_free(&pools[i], block);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,49 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+/*
+ * Pools of fixed-size blocks, allocated and freed in constant time from
+ * interrupt handlers too (the interrupts are disabled for a few
+ * instructions), instead of malloc() in the loops: the heap of the on-chip
+ * memory fragments and its latency is not bounded.
+ *
+ * The memory of a pool is given by the application, in the on-chip memory
+ * (static array) or in the frame memory behind the HPS bridges for large
+ * blocks (HPS_0_BRIDGES_BASE + address, through the cache: only the CPU uses
+ * the blocks). The free blocks are linked through their first word.
+ *
+ * Several pools of increasing block sizes make an allocator by size classes:
+ * pool_alloc_size() takes a block of the first pool large enough which has
+ * one, pool_free_any() gives it back to the pool whose memory holds it.
+ */
+typedef struct pool {
+    void     *free;          /* First free block, NULL if none */
+    uint8_t  *start;         /* Memory of the blocks */
+    uint8_t  *end;
+    uint32_t block_size;     /* Bytes, a multiple of 4 */
+    uint32_t num_blocks;
+    uint32_t used;           /* Blocks allocated */
+    uint32_t high_water;     /* Largest number of blocks allocated at once */
+    uint32_t failures;       /* Allocations which found no free block */
+} pool;
+
+/* Bytes of memory for num_blocks blocks of size bytes */
+#define POOL_MEMORY_SIZE(size, num_blocks) ((((size) + 3) & ~3) * (num_blocks))
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+bool pool_init(pool *p, void *memory, uint32_t block_size, uint32_t num_blocks);
+void *pool_alloc(pool *p);
+void pool_free(pool *p, void *block);
+void *pool_alloc_size(pool *pools, uint32_t num_pools, uint32_t size);
+bool pool_free_any(pool *pools, uint32_t num_pools, void *block);
+
+#endif /* __POOL_H__ */
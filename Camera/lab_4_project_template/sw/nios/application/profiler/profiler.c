@@ -0,0 +1,152 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#endif
+
+#include "profiler.h"
+
+#ifdef ALT_PROVIDE_GMON
+#include "priv/nios2_gmon_data.h"
+
+/* Records of gmon.out */
+#define GMON_TAG_TIME_HIST (0)
+#define GMON_TAG_CG_ARC    (1)
+#define GMON_VERSION       (1)
+
+/* Table of the call arcs filled by mcount in alt_gmon.c */
+struct mcount_arc {
+    void         *self_pc;   /* 0 if the entry is empty */
+    void         *from_pc;
+    unsigned int count;
+    unsigned int unused;
+};
+
+extern struct mcount_arc __mcount_arcs[];
+extern const unsigned int alt_gmon_arc_buckets;
+extern unsigned int alt_gmon_dropped_calls;
+
+/*******************************************************************************
+ *  Private API
+ ******************************************************************************/
+static bool write_words(FILE *file, const uint32_t *words, uint32_t count) __attribute__ ((no_instrument_function));
+static bool write_histogram(FILE *file) __attribute__ ((no_instrument_function));
+static bool write_arcs(FILE *file) __attribute__ ((no_instrument_function));
+
+/*
+ * write_words
+ *
+ * Writes words in the byte order of the CPU, which is the one gprof expects
+ * for the ELF file.
+ */
+static bool write_words(FILE *file, const uint32_t *words, uint32_t count) {
+    return fwrite(words, sizeof(uint32_t), count, file) == count;
+}
+
+/*
+ * write_histogram
+ *
+ * Writes the PC histogram record: low and high PC, number of buckets, sample
+ * rate, unit of the samples, then one 16-bit count per bucket.
+ */
+static bool write_histogram(FILE *file) {
+    static const char dimension[16] = "seconds\0\0\0\0\0\0\0\0s";
+    uint8_t tag = GMON_TAG_TIME_HIST;
+    uint32_t header[4];
+    uint32_t low_pc = alt_gmon_data[GMON_DATA_PROFILE_LOWPC];
+    uint32_t high_pc = alt_gmon_data[GMON_DATA_PROFILE_HIGHPC];
+    uint32_t bucket = alt_gmon_data[GMON_DATA_PROFILE_BUCKET];
+    uint32_t buckets = (high_pc - low_pc) / bucket;
+
+    if (alt_gmon_data[GMON_DATA_PROFILE_DATA] == 0) {
+        return true;    /* PC sampling not started */
+    }
+
+    header[0] = low_pc;
+    header[1] = low_pc + buckets * bucket;
+    header[2] = buckets;
+    header[3] = alt_gmon_data[GMON_DATA_PROFILE_RATE];
+
+    return (fwrite(&tag, 1, 1, file) == 1) &&
+           write_words(file, header, 4) &&
+           (fwrite(dimension, 1, sizeof(dimension), file) == sizeof(dimension)) &&
+           (fwrite((const void *) alt_gmon_data[GMON_DATA_PROFILE_DATA], sizeof(uint16_t), buckets, file) == buckets);
+}
+
+/*
+ * write_arcs
+ *
+ * Writes one record per call arc: caller PC, callee PC and number of calls.
+ */
+static bool write_arcs(FILE *file) {
+    struct mcount_arc *arc = NULL;
+    uint8_t tag = GMON_TAG_CG_ARC;
+    uint32_t record[3];
+    uint32_t i = 0;
+
+    for (i = 0; i < alt_gmon_arc_buckets; i++) {
+        arc = &__mcount_arcs[i];
+        if (arc->self_pc != NULL) {
+            record[0] = (uint32_t) arc->from_pc;
+            record[1] = (uint32_t) arc->self_pc;
+            record[2] = arc->count;
+            if ((fwrite(&tag, 1, 1, file) != 1) || !write_words(file, record, 3)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+#endif /* ALT_PROVIDE_GMON */
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * profiler_write_gmon
+ *
+ * Writes the profile collected so far to filename (for instance
+ * "/mnt/host/gmon.out"). The profile keeps running.
+ *
+ * Returns false if the application is not built for gprof or if the file
+ * could not be written.
+ */
+__attribute__ ((no_instrument_function))
+bool profiler_write_gmon(const char *filename) {
+#ifdef ALT_PROVIDE_GMON
+    static const uint32_t header[5] = {0x6E6F6D67, GMON_VERSION, 0, 0, 0}; /* "gmon", version, spare */
+    FILE *file = fopen(filename, "wb");
+    bool success = false;
+
+    if (file == NULL) {
+        return false;
+    }
+
+    success = write_words(file, header, 5) && write_histogram(file) && write_arcs(file);
+
+    return (fclose(file) == 0) && success;
+#else
+    (void) filename;
+    return false;
+#endif
+}
+
+/*
+ * profiler_dropped_calls
+ *
+ * Returns the number of calls not recorded because their arc did not fit in
+ * the table of alt_gmon.c (ALT_GMON_ARC_BUCKETS entries, build the BSP with
+ * a larger value).
+ */
+__attribute__ ((no_instrument_function))
+uint32_t profiler_dropped_calls(void) {
+#ifdef ALT_PROVIDE_GMON
+    return alt_gmon_dropped_calls;
+#else
+    return 0;
+#endif
+}
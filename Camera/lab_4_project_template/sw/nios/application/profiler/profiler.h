@@ -0,0 +1,28 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+/*
+ * Export of the gprof profile (BSP setting hal.enable_gprof) without the
+ * debugger: the PC histogram and the call arcs recorded by alt_gmon.c are
+ * written in the gmon.out format, for instance through hostfs, and read with
+ * nios2-elf-gprof <application>.elf gmon.out.
+ *
+ * The PC is sampled by the profile_timer of the system (or the system clock,
+ * none in this system): without it the histogram is empty and only the call
+ * counts are meaningful.
+ */
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+bool profiler_write_gmon(const char *filename);
+uint32_t profiler_dropped_calls(void);
+
+#endif /* __PROFILER_H__ */
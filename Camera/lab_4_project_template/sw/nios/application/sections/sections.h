@@ -0,0 +1,28 @@
+#ifndef __SECTIONS_H__
+#define __SECTIONS_H__
+
+/*
+ * Placement of the code and data of the interrupt handlers and inner loops.
+ *
+ * ALT_HOT_TEXT functions go to the .hot_text section and ALT_FAST_DATA
+ * variables to the .fast_data section, which the BSP maps to the memory of
+ * their section mappings in settings.bsp (onchip_memory2_0, or a
+ * tightly-coupled memory of the CPU if one is added to the system), apart
+ * from the initialization code in .text. Only the functions called for each
+ * frame or interrupt are marked: a tightly-coupled memory is small.
+ *
+ * Outside the Nios II HAL, the placement is left to the compiler.
+ */
+#ifdef __nios2_arch__
+#include "alt_types.h"
+#endif
+
+#ifndef ALT_HOT_TEXT
+#define ALT_HOT_TEXT
+#endif
+
+#ifndef ALT_FAST_DATA
+#define ALT_FAST_DATA
+#endif
+
+#endif /* __SECTIONS_H__ */
@@ -0,0 +1,83 @@
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#endif
+
+#include "trace.h"
+#include "../sections/sections.h"
+
+/* Header of the exported file: "CCTR", version, clock frequency (0 if the
+ * timestamps are sequence numbers), number of entries, lost entries */
+#define TRACE_MAGIC     (0x52544343)
+#define TRACE_VERSION   (1)
+
+#ifdef TRACE_TIMER_BASE
+#define TRACE_FREQ      (TRACE_TIMER_FREQ)
+#else
+#define TRACE_FREQ      (0)
+#endif
+
+trace_entry trace_ring[TRACE_ENTRIES] ALT_FAST_DATA;
+volatile uint32_t trace_head ALT_FAST_DATA = 0;
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+/*
+ * trace_init
+ *
+ * Empties the ring and starts the trace_timer, free-running over 2^32 clock
+ * cycles.
+ */
+void trace_init(void) {
+    trace_head = 0;
+
+#ifdef TRACE_TIMER_BASE
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(TRACE_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(TRACE_TIMER_BASE, 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(TRACE_TIMER_BASE, 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(TRACE_TIMER_BASE, 0);
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(TRACE_TIMER_BASE,
+                                     ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                     ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+#endif
+}
+
+/*
+ * trace_write
+ *
+ * Writes the header and the entries of the ring, the oldest first, to
+ * filename (for instance "/mnt/host/trace.bin"). The words are written in the
+ * byte order of the CPU (little-endian). Events recorded meanwhile, by an
+ * interrupt handler, may be missing or overwrite the oldest ones.
+ *
+ * Returns false if the file could not be written.
+ */
+bool trace_write(const char *filename) {
+    uint32_t head = trace_head;
+    uint32_t count = (head < TRACE_ENTRIES) ? head : TRACE_ENTRIES;
+    uint32_t first = (head - count) & (TRACE_ENTRIES - 1);
+    uint32_t header[5] = {TRACE_MAGIC, TRACE_VERSION, TRACE_FREQ, count, head - count};
+    FILE *file = fopen(filename, "wb");
+    bool success = false;
+
+    if (file == NULL) {
+        return false;
+    }
+
+    /* the ring from the oldest entry to its end, then from its start */
+    success = (fwrite(header, sizeof(uint32_t), 5, file) == 5);
+    if (first + count > TRACE_ENTRIES) {
+        success = success &&
+                  (fwrite(&trace_ring[first], sizeof(trace_entry), TRACE_ENTRIES - first, file) == TRACE_ENTRIES - first) &&
+                  (fwrite(&trace_ring[0], sizeof(trace_entry), first + count - TRACE_ENTRIES, file) == first + count - TRACE_ENTRIES);
+    } else {
+        success = success && (fwrite(&trace_ring[first], sizeof(trace_entry), count, file) == count);
+    }
+
+    return (fclose(file) == 0) && success;
+}
@@ -0,0 +1,96 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#if defined(__KERNEL__) || defined(MODULE)
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+#ifdef __nios2_arch__
+#include "system.h"
+#endif
+
+#ifdef TRACE_TIMER_BASE
+#include "altera_avalon_timer_regs.h"
+#endif
+
+/*
+ * Event tracing: TRACE_BEGIN(id) and TRACE_END(id) record the id of the event
+ * and a timestamp in a ring of TRACE_ENTRIES entries in the on-chip memory,
+ * overwriting the oldest ones. Recording an event costs the read of the
+ * timestamp and one entry of the ring (two word stores), without call nor
+ * lock: an event of an interrupt handler that lands between the increment of
+ * the index and the stores of the interrupted event is lost.
+ *
+ * trace_write() exports the ring, ImageConverter/python/tracetojson.py
+ * converts it to the Chrome trace format (chrome://tracing, ui.perfetto.dev)
+ * with the names of the TRACE_ID_ below.
+ *
+ * The timestamps are clock cycles counted by the trace_timer of the system,
+ * free-running and read through its snapshot registers. Without it they are
+ * the sequence numbers of the events: the order is kept, not the durations.
+ *
+ * The macros compile to nothing unless TRACE_ENABLE is defined (Makefile,
+ * APP_CFLAGS_DEFINED_SYMBOLS).
+ */
+
+/* Events, at most TRACE_ID_MASK */
+#define TRACE_ID_FRAME_CAPTURE  (1)     /* Acquisition of a frame, until the controller signals it */
+#define TRACE_ID_CAMERA_ISR     (2)     /* Interrupt handler of the camera controller */
+#define TRACE_ID_I2C            (3)     /* Transfer of one byte on the I2C bus */
+#define TRACE_ID_FRAME_CHECK    (4)     /* Trailer and CRC of a frame */
+#define TRACE_ID_FRAME_COPY     (5)     /* Copy of a frame out of the ring */
+#define TRACE_ID_COMPRESS       (6)     /* Compression of a frame */
+#define TRACE_ID_EXPORT         (7)     /* Dump of a frame through hostfs */
+
+/* Number of entries of the ring, a power of two */
+#ifndef TRACE_ENTRIES
+#define TRACE_ENTRIES           (1024)
+#endif
+
+/* event field of an entry */
+#define TRACE_ID_MASK           (0x7FFFFFFF)
+#define TRACE_END_MSK           (0x80000000)
+
+typedef struct trace_entry {
+    uint32_t event;         /* Id of the event, TRACE_END_MSK at the end */
+    uint32_t timestamp;     /* Clock cycles, or sequence number without trace_timer */
+} trace_entry;
+
+extern trace_entry trace_ring[TRACE_ENTRIES];
+extern volatile uint32_t trace_head;
+
+#ifdef TRACE_TIMER_BASE
+/* The snapshot is the count of the timer, which counts down from 0xFFFFFFFF */
+#define TRACE_TIMESTAMP(index) \
+    (IOWR_ALTERA_AVALON_TIMER_SNAPL(TRACE_TIMER_BASE, 0), \
+     ~(((uint32_t) IORD_ALTERA_AVALON_TIMER_SNAPH(TRACE_TIMER_BASE) << 16) | ((uint32_t) IORD_ALTERA_AVALON_TIMER_SNAPL(TRACE_TIMER_BASE) & 0xFFFF)))
+#else
+#define TRACE_TIMESTAMP(index)  (index)
+#endif
+
+#define TRACE_RECORD(evt)                                                   \
+    do {                                                                    \
+        uint32_t trace_index_ = trace_head++;                               \
+        trace_entry *trace_entry_ = &trace_ring[trace_index_ & (TRACE_ENTRIES - 1)]; \
+        trace_entry_->timestamp = TRACE_TIMESTAMP(trace_index_);            \
+        trace_entry_->event = (evt);                                        \
+    } while (0)
+
+#ifdef TRACE_ENABLE
+#define TRACE_BEGIN(id)         TRACE_RECORD(id)
+#define TRACE_END(id)           TRACE_RECORD((id) | TRACE_END_MSK)
+#else
+#define TRACE_BEGIN(id)         do { } while (0)
+#define TRACE_END(id)           do { } while (0)
+#endif
+
+/*******************************************************************************
+ *  Public API
+ ******************************************************************************/
+void trace_init(void);
+bool trace_write(const char *filename);
+
+#endif /* __TRACE_H__ */
@@ -51,4 +51,13 @@ typedef unsigned long long alt_u64;
 #define ALT_ALWAYS_INLINE __attribute__ ((always_inline))
 #define ALT_WEAK          __attribute__((weak))
 
+/*
+ * Code and data of the interrupt handlers and inner loops, placed by the
+ * linker in the memory of the .hot_text and .fast_data section mappings
+ * (a tightly-coupled memory if the system has one).
+ */
+
+#define ALT_HOT_TEXT      __attribute__ ((section (".hot_text")))
+#define ALT_FAST_DATA     __attribute__ ((section (".fast_data")))
+
 #endif /* __ALT_TYPES_H__ */
@@ -42,6 +42,23 @@
 
 #define GMON_DATA_SIZE 9
 
+/*
+ * Call arcs recorded by mcount: a table of ALT_GMON_ARC_BUCKETS entries (a
+ * power of 2, at most 65536) of 1 << ALT_GMON_ARC_SIZE_LOG2 bytes, searched
+ * with linear probing from the bucket below. An entry is self_pc, from_pc,
+ * count and an unused word, self_pc is 0 in an empty entry.
+ */
+#ifndef ALT_GMON_ARC_BUCKETS
+#define ALT_GMON_ARC_BUCKETS 512
+#endif
+
+#define ALT_GMON_ARC_SIZE_LOG2 4
+
+#define ALT_GMON_ARC_BUCKET(self_pc, from_pc) \
+  (((((unsigned int)(from_pc) >> 3) ^ (unsigned int)(self_pc)) >> 2) & (ALT_GMON_ARC_BUCKETS - 1))
+
+#ifndef __ASSEMBLER__
 extern unsigned int alt_gmon_data[GMON_DATA_SIZE];
+#endif
 
 #endif
@@ -54,6 +54,7 @@ int alt_getchar();
 int alt_putchar(int c);
 int alt_putstr(const char* str);
 void alt_printf(const char *fmt, ...);
+int alt_utoa(unsigned long value, char* buf);
 #ifdef ALT_SEMIHOSTING
 int alt_putcharbuf(int c);
 int alt_putstrbuf(const char* str);
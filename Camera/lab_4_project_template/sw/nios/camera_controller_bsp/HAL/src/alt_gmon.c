@@ -34,50 +34,63 @@
 
 #include "priv/nios2_gmon_data.h"
 
+#include "system.h"
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
 
+/*
+ * The PC is sampled by a dedicated timer called profile_timer when the system
+ * has one, so profiling does not need a system clock. Otherwise the system
+ * clock is used, if any.
+ */
+#ifdef PROFILE_TIMER_BASE
+#include "altera_avalon_timer_regs.h"
+#endif
+
 
 /* Macros */
 
 /* How large should the bins be which we use to generate the histogram */
 #define PCSAMPLE_BYTES_PER_BUCKET 32
 
+/* Size of the preallocated histogram, 4096 buckets cover 128 KB of code */
+#ifndef ALT_GMON_HISTOGRAM_BUCKETS
+#define ALT_GMON_HISTOGRAM_BUCKETS 4096
+#endif
+
+/* Samples per second of the profile timer */
+#ifndef ALT_GMON_SAMPLE_RATE
+#define ALT_GMON_SAMPLE_RATE 10000
+#endif
+
 #define NIOS2_READ_EA(dest)  __asm__ ("mov %0, ea" : "=r" (dest))
 
 /* The compiler inserts calls to mcount() at the start of
- * every function call. The structure mcount_fn_arc records t
- * he return address of the function called (in from_pc)
- * and the return address of the mcount function
- * (in self_pc). The number of times this arc is executed is
- * recorded in the field count.
+ * every function call. The structure mcount_arc records the
+ * return address of the mcount function (in self_pc) and the
+ * return address of the function called (in from_pc). The
+ * number of times this arc is executed is recorded in the
+ * field count. The layout is known by alt_mcount.S.
  */
-struct mcount_fn_arc
+struct mcount_arc
 {
-  struct mcount_fn_arc * next;
+  void * self_pc;
   void * from_pc;
   unsigned int count;
-};
-
-/* We need to maintain a list of pointers to the heads of each adjacency
- * list so that we can find them when writing out the gmon.out file. Since
- * we don't know at the start of program execution how many functions will
- * be called we use a list structure to do this.
- */
-struct mcount_fn_entry
-{
-  struct mcount_fn_entry * next;
-  void * self_pc;
-  struct mcount_fn_arc * arc_head;
+  unsigned int unused;
 };
 
 /* function prototypes */
 
-void __mcount_record(void * self_pc, void * from_pc, struct mcount_fn_entry * fn_entry, struct mcount_fn_entry * * fn_head) __attribute__ ((no_instrument_function));
+void __mcount_record(void * self_pc, void * from_pc) __attribute__ ((no_instrument_function));
 
-static __inline__ void * mcount_allocate(unsigned int size) __attribute__ ((no_instrument_function));
 static int nios2_pcsample_init(void) __attribute__ ((no_instrument_function));
+static void nios2_pcsample_bucket(unsigned int pc) __attribute__ ((no_instrument_function));
+#ifdef PROFILE_TIMER_BASE
+static void nios2_pcsample_isr(void* context) __attribute__ ((no_instrument_function));
+#else
 static alt_u32 nios2_pcsample(void* alarm) __attribute__ ((no_instrument_function));
+#endif
 
 /* global variables */
 
@@ -85,23 +98,36 @@ static alt_u32 nios2_pcsample(void* alarm) __attribute__ ((no_instrument_functio
 extern char stext[];
 extern char etext[];
 
+/* the bounds of the .hot_text section, placed before .text by the linker script */
+extern char __ram_hot_text_start[];
+extern char __ram_hot_text_end[];
+
 /* Is the PC sampling stuff enabled yet? */
 static int pcsample_need_init = 1;
 
-#define HASH_BUCKETS 64 /* Must be a power of 2 */
-
-/* This points to the list of adjacency list pointers. */
-struct mcount_fn_entry * __mcount_fn_head[HASH_BUCKETS];
+/* The call arcs, searched by mcount from their bucket (see nios2_gmon_data.h)
+ * to the first empty entry. One entry is always left empty. */
+struct mcount_arc __mcount_arcs[ALT_GMON_ARC_BUCKETS];
+const unsigned int alt_gmon_arc_buckets = ALT_GMON_ARC_BUCKETS;
+static unsigned int mcount_arcs_used = 0;
 
 /* pointer to the in-memory buffer containing the histogram */
 static unsigned short* s_pcsamples = 0;
 
-/* the address of the start and end of text section */
-static const unsigned int s_low_pc  = (unsigned int)stext;
-static const unsigned int s_high_pc = (unsigned int)etext;
+/* the preallocated histogram, the code beyond it is not sampled */
+static unsigned short s_pcsamples_buffer[ALT_GMON_HISTOGRAM_BUCKETS];
 
+/* the address of the start and end of the sampled code */
+static unsigned int s_low_pc  = (unsigned int)stext;
+static unsigned int s_high_pc = (unsigned int)etext;
+
+#ifndef PROFILE_TIMER_BASE
 /* the alarm structure to register for pc sampling */
 static alt_alarm s_nios2_pcsample_alarm;
+#endif
+
+/* number of calls not recorded because the table was full */
+unsigned int alt_gmon_dropped_calls = 0;
 
 unsigned int alt_gmon_data[GMON_DATA_SIZE] =
 {
@@ -112,54 +138,24 @@ unsigned int alt_gmon_data[GMON_DATA_SIZE] =
   (unsigned int)etext,
   PCSAMPLE_BYTES_PER_BUCKET,
   0,
-  (unsigned int)__mcount_fn_head,
-  (unsigned int)(__mcount_fn_head + HASH_BUCKETS)
+  0, /* no adjacency lists, the arcs are in __mcount_arcs */
+  0
 };
 
-/* This holds the current slab of memory we're allocating out of */
-static char * mcount_slab_ptr = 0;
-static int    mcount_slab_size = 0;
-
-#define MCOUNT_SLAB_INCREMENT 1020
-
-
-/*
- * We can't use malloc to allocate memory because that's too complicated, and
- * can't be called at interrupt time.  Use the lower level allocator instead
- * because that's interrupt safe (and because we never free anything).
- *
- * For speed, we allocate a block of data at once.
- */
-static __inline__ void * mcount_allocate(unsigned int size)
-{
-  void * data;
-
-  if (size > mcount_slab_size)
-  {
-    mcount_slab_ptr = sbrk(MCOUNT_SLAB_INCREMENT);
-    mcount_slab_size = MCOUNT_SLAB_INCREMENT;
-  }
-
-  data = mcount_slab_ptr;
-  mcount_slab_ptr += size;
-  mcount_slab_size -= size;
-
-  return data;
-}
-
-
 /*
- * Add the arc with the values of frompc and topc given to the graph.
+ * Add the arc with the values of self_pc and from_pc given to the table.
  * This function might be called at interrupt time so must be able to
  * cope with reentrancy.
  *
- * The fast case, where we have already allocated a function arc, has been
- * handled by the assmebler code.
+ * The fast case, where the arc is already in the table, has been handled
+ * by the assembler code without disabling the interrupts: it only
+ * increments a count, which is written by no one else but a nested call.
  */
-void __mcount_record(void * self_pc, void * from_pc, struct mcount_fn_entry * fn_entry, struct mcount_fn_entry * * fn_head)
+void __mcount_record(void * self_pc, void * from_pc)
 {
   alt_irq_context context;
-  struct mcount_fn_arc * arc_entry;
+  struct mcount_arc * arc;
+  unsigned int bucket;
 
   /* Keep trying to start up the PC sampler until it is running.
    * (It can't start until the timer is going).
@@ -171,38 +167,42 @@ void __mcount_record(void * self_pc, void * from_pc, struct mcount_fn_entry * fn
   }
 
   /*
-   * We must disable interrupts around the allocation and the list update to
-   * prevent corruption if the instrumented function is re-entrant.
-   *
-   * It's safe for the code above to be stepping through the chain and be
-   * interrupted by this code modifying it - there is an edge case which will
-   * leave two copies of the same arc on the list (both with count=1), but
-   * this is dealt with on the host.
+   * We must disable interrupts while claiming an empty entry: an instrumented
+   * interrupt handler could claim the same one, or add this very arc after
+   * mcount missed it, which is why the search starts again here.
    */
   context = alt_irq_disable_all();
 
-  if (fn_entry == NULL)
+  bucket = ALT_GMON_ARC_BUCKET(self_pc, from_pc);
+  for (;;)
   {
-    /* Add it to the list of functions we must output later. */
-    fn_entry = (struct mcount_fn_entry *)mcount_allocate(sizeof(struct mcount_fn_entry));
-
-    fn_entry->self_pc = self_pc;
-    fn_entry->arc_head = NULL;
-
-    fn_entry->next = *fn_head;
-    *fn_head = fn_entry;
+    arc = &__mcount_arcs[bucket];
+
+    if (arc->self_pc == NULL)
+    {
+      if (mcount_arcs_used < ALT_GMON_ARC_BUCKETS - 1)
+      {
+        mcount_arcs_used++;
+        arc->from_pc = from_pc;
+        arc->count = 1;
+        arc->self_pc = self_pc;
+      }
+      else
+      {
+        alt_gmon_dropped_calls++;
+      }
+      break;
+    }
+
+    if (arc->self_pc == self_pc && arc->from_pc == from_pc)
+    {
+      arc->count++;
+      break;
+    }
+
+    bucket = (bucket + 1) & (ALT_GMON_ARC_BUCKETS - 1);
   }
 
-  /* We will need a new list entry - if there was a list entry before
-   * then the assembler code would have handled it. */
-  arc_entry = (struct mcount_fn_arc *)mcount_allocate(sizeof(struct mcount_fn_arc));
-
-  arc_entry->from_pc = from_pc;
-  arc_entry->count = 1;
-
-  arc_entry->next = fn_entry->arc_head;
-  fn_entry->arc_head = arc_entry;
-
   alt_irq_enable_all(context);
 }
 
@@ -211,51 +211,76 @@ void __mcount_record(void * self_pc, void * from_pc, struct mcount_fn_entry * fn
  * nios2_pcsample_init starts profiling.
  * It is called the first time mcount is called, and on subsequent calls to
  * mcount until it returns zero. It initializes the pc histogram and turns on
- * timer driven pc sampling.
+ * the pc sampling, driven by the profile timer or else by the system clock.
  */
 static int nios2_pcsample_init(void)
 {
   unsigned int pcsamples_size; 
-
+#ifdef PROFILE_TIMER_BASE
+  unsigned int prof_rate = ALT_GMON_SAMPLE_RATE;
+  unsigned int period = PROFILE_TIMER_FREQ / ALT_GMON_SAMPLE_RATE - 1;
+#else
   /* We sample the PC every tick */
   unsigned int prof_rate = alt_ticks_per_second();
   if (prof_rate == 0)
     return 1;
+#endif
 
-  /* allocate the histogram buffer s_pcsamples */
-  pcsamples_size = (s_high_pc - s_low_pc)/PCSAMPLE_BYTES_PER_BUCKET;
-  s_pcsamples    = (unsigned short*)sbrk(pcsamples_size * sizeof(unsigned short));
-
-  if (s_pcsamples != 0)
+  /*
+   * The .hot_text section (ALT_HOT_TEXT code) ends where .text starts while
+   * both are in the same memory: sample it with the rest of the code. Once
+   * mapped to another memory, it is left out of the histogram.
+   */
+  if ((unsigned int)__ram_hot_text_end == s_low_pc)
   {
-    /* initialize the buffer to zero */
-    memset(s_pcsamples, 0, pcsamples_size * sizeof(unsigned short));
-
-    alt_gmon_data[GMON_DATA_PROFILE_DATA] = (int)s_pcsamples;
-    alt_gmon_data[GMON_DATA_PROFILE_RATE] = prof_rate;
+    s_low_pc = (unsigned int)__ram_hot_text_start;
+    alt_gmon_data[GMON_DATA_PROFILE_LOWPC] = s_low_pc;
+  }
 
-    /* Sample every tick (it's cheap) */
-    alt_alarm_start(&s_nios2_pcsample_alarm, 1, nios2_pcsample, 0);
+  /* the histogram buffer is preallocated, only the code it covers is sampled */
+  pcsamples_size = (s_high_pc - s_low_pc)/PCSAMPLE_BYTES_PER_BUCKET;
+  if (pcsamples_size > ALT_GMON_HISTOGRAM_BUCKETS)
+  {
+    pcsamples_size = ALT_GMON_HISTOGRAM_BUCKETS;
+    s_high_pc = s_low_pc + pcsamples_size * PCSAMPLE_BYTES_PER_BUCKET;
+    alt_gmon_data[GMON_DATA_PROFILE_HIGHPC] = s_high_pc;
   }
+  s_pcsamples = s_pcsamples_buffer;
+
+  /* initialize the buffer to zero */
+  memset(s_pcsamples, 0, pcsamples_size * sizeof(unsigned short));
+
+  alt_gmon_data[GMON_DATA_PROFILE_DATA] = (int)s_pcsamples;
+  alt_gmon_data[GMON_DATA_PROFILE_RATE] = prof_rate;
+
+#ifdef PROFILE_TIMER_BASE
+  /* Continuous interrupts at the sample rate */
+  IOWR_ALTERA_AVALON_TIMER_CONTROL(PROFILE_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+  IOWR_ALTERA_AVALON_TIMER_PERIODL(PROFILE_TIMER_BASE, period & 0xFFFF);
+  IOWR_ALTERA_AVALON_TIMER_PERIODH(PROFILE_TIMER_BASE, period >> 16);
+  IOWR_ALTERA_AVALON_TIMER_STATUS(PROFILE_TIMER_BASE, 0);
+  alt_ic_isr_register(PROFILE_TIMER_IRQ_INTERRUPT_CONTROLLER_ID, PROFILE_TIMER_IRQ,
+                      nios2_pcsample_isr, 0, 0);
+  IOWR_ALTERA_AVALON_TIMER_CONTROL(PROFILE_TIMER_BASE,
+                                   ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+                                   ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                   ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+#else
+  /* Sample every tick (it's cheap) */
+  alt_alarm_start(&s_nios2_pcsample_alarm, 1, nios2_pcsample, 0);
+#endif
 
   return 0;
 }
 
 
 /*
- * Sample the PC value and store it in the histogram
+ * Store a PC value in the histogram
  */
-static alt_u32 nios2_pcsample(void* context)
+static void nios2_pcsample_bucket(unsigned int pc)
 {
-  unsigned int pc;
   unsigned int bucket;
 
-  /* read the exception return address - this will be
-   * inaccurate if there are nested interrupts but we
-   * assume that this is rare and the inaccuracy will
-   * not be great */
-  NIOS2_READ_EA(pc);
-
   /*
    * If we're within the profilable range then increment the relevant
    * bucket in the histogram
@@ -265,8 +290,42 @@ static alt_u32 nios2_pcsample(void* context)
     bucket = (pc - s_low_pc)/PCSAMPLE_BYTES_PER_BUCKET;
     s_pcsamples[bucket]++;
   }
+}
+
+
+#ifdef PROFILE_TIMER_BASE
+/*
+ * Interrupt handler of the profile timer: sample the PC
+ */
+static void nios2_pcsample_isr(void* context)
+{
+  unsigned int pc;
+
+  /* read the exception return address first, the interrupts are disabled
+   * while the handler runs so it is the interrupted PC */
+  NIOS2_READ_EA(pc);
+
+  IOWR_ALTERA_AVALON_TIMER_STATUS(PROFILE_TIMER_BASE, 0);
+
+  nios2_pcsample_bucket(pc);
+}
+#else
+/*
+ * Sample the PC value and store it in the histogram
+ */
+static alt_u32 nios2_pcsample(void* context)
+{
+  unsigned int pc;
+
+  /* read the exception return address - this will be
+   * inaccurate if there are nested interrupts but we
+   * assume that this is rare and the inaccuracy will
+   * not be great */
+  NIOS2_READ_EA(pc);
+
+  nios2_pcsample_bucket(pc);
 
   /* Sample every tick */
   return 1;
 }
-
+#endif
@@ -62,6 +62,22 @@ struct ALT_IRQ_HANDLER
   void *context;
 } alt_irq[ALT_NIRQ];
 
+#if !defined(ALT_CI_INTERRUPT_VECTOR) && ALT_CPU_HARDWARE_MULTIPLY_PRESENT
+
+/*
+ * Index of the single set bit of a word, from the top 5 bits of its product
+ * with the de Bruijn sequence 0x077CB531. It finds the lowest pending
+ * interrupt with one multiplication and one load, instead of one test per
+ * lower interrupt.
+ */
+static const alt_u8 alt_irq_lowest[32] =
+{
+  0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+  31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+#endif
+
 /*
  * alt_irq_handler() is called by the interrupt exception handler in order to 
  * process any outstanding interrupts. 
@@ -74,6 +90,9 @@ struct ALT_IRQ_HANDLER
  * If Nios II interrupt vector custom instruction exists, use it to accelerate
  * the dispatch of interrupt handlers.  The Nios II interrupt vector custom 
  * instruction is present if the macro ALT_CI_INTERRUPT_VECTOR defined.
+ *
+ * If ALT_IRQ_FAST_IRQ is defined (ALT_CPPFLAGS in public.mk), that interrupt
+ * is served before all the others when it is pending, whatever its number.
  */
 
 void alt_irq_handler (void) __attribute__ ((section (".exceptions")));
@@ -84,7 +103,9 @@ void alt_irq_handler (void)
   char*  alt_irq_base = (char*)alt_irq;
 #else
   alt_u32 active;
+#if !ALT_CPU_HARDWARE_MULTIPLY_PRESENT
   alt_u32 mask;
+#endif
   alt_u32 i;
 #endif /* ALT_CI_INTERRUPT_VECTOR */
   
@@ -129,6 +150,33 @@ void alt_irq_handler (void)
 
   do
   {
+#ifdef ALT_IRQ_FAST_IRQ
+    if (active & (1 << ALT_IRQ_FAST_IRQ))
+    {
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+      alt_irq[ALT_IRQ_FAST_IRQ].handler(alt_irq[ALT_IRQ_FAST_IRQ].context);
+#else
+      alt_irq[ALT_IRQ_FAST_IRQ].handler(alt_irq[ALT_IRQ_FAST_IRQ].context,
+                                        ALT_IRQ_FAST_IRQ);
+#endif
+      active = alt_irq_pending ();
+      continue;
+    }
+#endif /* ALT_IRQ_FAST_IRQ */
+
+#if ALT_CPU_HARDWARE_MULTIPLY_PRESENT
+    /*
+     * active & -active keeps the lowest pending interrupt, the highest
+     * priority one.
+     */
+
+    i = alt_irq_lowest[((active & -active) * 0x077CB531) >> 27];
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+    alt_irq[i].handler(alt_irq[i].context); 
+#else
+    alt_irq[i].handler(alt_irq[i].context, i); 
+#endif
+#else /* ALT_CPU_HARDWARE_MULTIPLY_PRESENT */
     i = 0;
     mask = 1;
 
@@ -153,6 +201,7 @@ void alt_irq_handler (void)
       i++;
 
     } while (1);
+#endif /* ALT_CPU_HARDWARE_MULTIPLY_PRESENT */
 
     active = alt_irq_pending ();
     
@@ -46,6 +46,12 @@ extern alt_u32 __ram_rodata_end;
 extern alt_u32 __flash_exceptions_start; 
 extern alt_u32 __ram_exceptions_start;
 extern alt_u32 __ram_exceptions_end;
+extern alt_u32 __flash_hot_text_start; 
+extern alt_u32 __ram_hot_text_start;
+extern alt_u32 __ram_hot_text_end;
+extern alt_u32 __flash_fast_data_start; 
+extern alt_u32 __ram_fast_data_start;
+extern alt_u32 __ram_fast_data_end;
 
 /*
  * alt_load() is called when the code is executing from flash. In this case
@@ -79,6 +85,19 @@ void alt_load (void)
 		                &__ram_rodata_start,
 		                &__ram_rodata_end);
   
+  /*
+   * Copy the hot code and data, when they are mapped to another memory
+   * (e.g. a tightly-coupled memory).
+   */
+
+  alt_load_section (&__flash_hot_text_start, 
+		                &__ram_hot_text_start,
+		                &__ram_hot_text_end);
+
+  alt_load_section (&__flash_fast_data_start, 
+		                &__ram_fast_data_start,
+		                &__ram_fast_data_end);
+
   /*
    * Now ensure that the caches are in synch.
    */
@@ -39,6 +39,7 @@
    #include <altera_avalon_jtag_uart_regs.h>
 #endif
 #include "sys/alt_log_printf.h"
+#include "sys/alt_stdio.h"
 
 /* strings for assembly puts */
 char alt_log_msg_bss[] = "[crt0.S] Clearing BSS \r\n";;
@@ -206,10 +207,11 @@ otherFmtChar:
 doIntegerPrint:
                 {
                 unsigned long v;
-                unsigned long p;  /* biggest power of fmtBase */
-                unsigned long vShrink;  /* used to count digits */
+                char digits[12];  /* 32 bits in octal, and a NUL */
+                int shift;
                 int sign;
                 int digitCount;
+                int i;
 
                 /* Get the value */
                 if(fmtLong)
@@ -244,14 +246,31 @@ doIntegerPrint:
                   sign = 1;
                   }
 
-                /* Count digits, and get largest place value */
-                vShrink = v;
-                p = 1;
-                digitCount = 1;
-                while( (vShrink = vShrink / fmtBase) > 0 )
+                /* Get the digits without dividing, the CPU may have no divider */
+                if(fmtBase == 10)
                   {
-                  digitCount++;
-                  p *= fmtBase;
+                  digitCount = alt_utoa(v,digits);
+                  }
+                else
+                  {
+                  shift = (fmtBase == 8) ? 3 : 4;
+                  digitCount = 1;
+                  while( shift * digitCount < 32 && (v >> (shift * digitCount)) > 0 )
+                    {
+                    digitCount++;
+                    }
+                  for(i = digitCount - 1; i >= 0; i--)
+                    {
+                    unsigned char d;
+
+                    d = (v & (fmtBase - 1)) + '0';
+                    if(d > '9')
+                    {
+                      d += (fmtCase ? 'A' : 'a') - '0' - 10;
+                    }
+                    digits[i] = d;
+                    v >>= shift;
+                    }
                   }
 
                 /* Print leading characters & sign */
@@ -279,20 +298,9 @@ doIntegerPrint:
                   }
 
                 /* Print numbery parts */
-                while(p)
+                for(i = 0; i < digitCount; i++)
                   {
-                  unsigned char d;
-
-                  d = v / p;
-                  d += '0';
-                  if(d > '9')
-                  {
-                    d += (fmtCase ? 'A' : 'a') - '0' - 10;
-                  }
-                  alt_log_txchar(d,(char*)base);
-
-                  v = v % p;
-                  p = p / fmtBase;
+                  alt_log_txchar(digits[i],(char*)base);
                   }
                 }
 
@@ -34,6 +34,8 @@
  * This file provides a very minimal printf implementation for use with very
  * small applications.  Only the following format strings are supported:
  *   %x
+ *   %d
+ *   %u
  *   %s
  *   %c
  *   %%
@@ -81,6 +83,23 @@ alt_printf(const char* fmt, ... )
                     int v = va_arg(args, int);
                     alt_putchar(v);
                 }
+                else if (c == 'd' || c == 'u')
+                {
+                    /* Process decimal number format, without division. */
+                    unsigned long v = va_arg(args, unsigned long);
+                    char digits[11];
+                    char *d = digits;
+
+                    if (c == 'd' && (long) v < 0)
+                    {
+                        alt_putchar('-');
+                        v = -v;
+                    }
+
+                    alt_utoa(v, digits);
+                    while (*d)
+                        alt_putchar(*d++);
+                }
                 else if (c == 'x')
                 {
                     /* Process hexadecimal number format. */
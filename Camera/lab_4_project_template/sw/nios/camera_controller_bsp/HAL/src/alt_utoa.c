@@ -0,0 +1,72 @@
+/*
+ * Conversion of an unsigned integer to decimal without division, for alt_printf,
+ * alt_log_printf and the applications: the CPU has no hardware divider and
+ * each division by 10 would be a call to __udivsi3.
+ *
+ * The digits above the 5 low ones are found by subtracting 8, 4, 2 and 1
+ * times their power of ten. The 5 low ones are found by multiplying by the
+ * reciprocal of 10: (v >> 1) * 0xCCCD >> 18 == v / 10 for v < 100000.
+ */
+
+#include "alt_types.h"
+#include "sys/alt_stdio.h"
+
+/* 8, 4, 2 and 1 times 10^9 down to 10^5 (the first digit is at most 4, no 8 * 10^9) */
+static const alt_u32 alt_utoa_steps[5][4] =
+{
+  {0, 4000000000u, 2000000000u, 1000000000u},
+  {800000000, 400000000, 200000000, 100000000},
+  {80000000, 40000000, 20000000, 10000000},
+  {8000000, 4000000, 2000000, 1000000},
+  {800000, 400000, 200000, 100000}
+};
+
+/*
+ * Write the decimal digits of value and a terminating NUL to buf (at least
+ * 11 characters). Return the number of digits.
+ */
+int ALT_HOT_TEXT alt_utoa(alt_u32 value, char* buf)
+{
+  char low[5];
+  char* p = buf;
+  alt_u32 q;
+  alt_u32 ge;
+  int row, col;
+  int digit;
+  int i;
+
+  if (value >= 100000)
+  {
+    for (row = 0; row < 5; row++)
+    {
+      digit = 0;
+      for (col = (row == 0) ? 1 : 0; col < 4; col++)
+      {
+        /* without branch, the comparisons are not predictable */
+        ge = -(alt_u32) (value >= alt_utoa_steps[row][col]);
+        value -= alt_utoa_steps[row][col] & ge;
+        digit += (8 >> col) & ge;
+      }
+
+      /* skip the leading zeros */
+      if (digit != 0 || p != buf)
+        *p++ = '0' + digit;
+    }
+  }
+
+  for (i = 4; i >= 0; i--)
+  {
+    q = ((value >> 1) * 0xCCCD) >> 18;
+    low[i] = '0' + (value - q * 10);
+    value = q;
+  }
+
+  /* the leading zeros of the low digits too, but one digit at least */
+  for (i = 0; i < 4 && p == buf && low[i] == '0'; i++)
+    ;
+  for ( ; i < 5; i++)
+    *p++ = low[i];
+
+  *p = '\0';
+  return p - buf;
+}
@@ -59,7 +59,9 @@
  */
 
 #include "altera_nios2_gen2_irq.h"
+#include "altera_avalon_dma.h"
 #include "altera_avalon_jtag_uart.h"
+#include "altera_avalon_timer.h"
 #include "altera_hostfs.h"
 
 /*
@@ -67,7 +69,10 @@
  */
 
 ALTERA_NIOS2_GEN2_IRQ_INSTANCE ( NIOS2_GEN2_0, nios2_gen2_0);
+ALTERA_AVALON_DMA_INSTANCE ( DMA_0, dma_0);
 ALTERA_AVALON_JTAG_UART_INSTANCE ( JTAG_UART_0, jtag_uart_0);
+ALTERA_AVALON_TIMER_INSTANCE ( PROFILE_TIMER, profile_timer);
+ALTERA_AVALON_TIMER_INSTANCE ( TRACE_TIMER, trace_timer);
 ALTERA_HOSTFS_INSTANCE ( ALTERA_HOSTFS, altera_hostfs);
 
 /*
@@ -91,6 +96,9 @@ void alt_irq_init ( const void* base )
 
 void alt_sys_init( void )
 {
+    ALTERA_AVALON_DMA_INIT ( DMA_0, dma_0);
     ALTERA_AVALON_JTAG_UART_INIT ( JTAG_UART_0, jtag_uart_0);
+    ALTERA_AVALON_TIMER_INIT ( PROFILE_TIMER, profile_timer);
+    ALTERA_AVALON_TIMER_INIT ( TRACE_TIMER, trace_timer);
     ALTERA_HOSTFS_INIT ( ALTERA_HOSTFS, altera_hostfs);
 }
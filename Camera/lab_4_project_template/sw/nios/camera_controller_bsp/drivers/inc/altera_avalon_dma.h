@@ -0,0 +1,210 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#ifndef __ALTERA_AVALON_DMA_H__
+#define __ALTERA_AVALON_DMA_H__
+
+#include <stddef.h>
+
+#include "alt_types.h"
+#include "sys/alt_dma_dev.h"
+#include "sys/alt_warning.h"
+
+#include "altera_avalon_dma_regs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * The DMA is presented as a HAL DMA device (see sys/alt_dma.h): a transmit
+ * channel which reads the data and a receive channel which writes it, both
+ * called name##_NAME (e.g. "/dev/dma_0"). A transfer starts when a transmit
+ * and a receive request are both posted, it moves the smaller of their
+ * lengths. A request is completed, and its callback called from the
+ * interrupt handler, once all its bytes have been moved.
+ *
+ * Each channel queues up to ALTERA_AVALON_DMA_NSLOTS - 1 requests (a power
+ * of two). A request can not be longer than the length register of the DMA
+ * allows (name##_LENGTHWIDTH bits).
+ */
+
+#ifndef ALTERA_AVALON_DMA_NSLOTS
+#define ALTERA_AVALON_DMA_NSLOTS 4
+#endif
+
+/*
+ * Flags of the device state.
+ *
+ * ALTERA_AVALON_DMA_RX_ONLY: only the receive channel is used, the data is
+ *                            read from a constant address (ALT_DMA_RX_ONLY_ON).
+ * ALTERA_AVALON_DMA_TX_ONLY: only the transmit channel is used, the data is
+ *                            written to a constant address (ALT_DMA_TX_ONLY_ON).
+ */
+
+#define ALTERA_AVALON_DMA_RX_ONLY 0x1
+#define ALTERA_AVALON_DMA_TX_ONLY 0x2
+
+typedef struct altera_avalon_dma_txslot_s
+{
+  const char*      from;
+  alt_u32          len;
+  alt_u32          done_len;     /* bytes already moved */
+  alt_txchan_done* done;
+  void*            handle;
+} altera_avalon_dma_txslot;
+
+typedef struct altera_avalon_dma_rxslot_s
+{
+  char*            data;
+  alt_u32          len;
+  alt_u32          done_len;     /* bytes already moved */
+  alt_rxchan_done* done;
+  void*            handle;
+} altera_avalon_dma_rxslot;
+
+/*
+ * State structure shared by the two channels of a DMA.
+ */
+
+typedef struct altera_avalon_dma_priv_s
+{
+  void*                     base;
+  alt_u32                   allowed;     /* CONTROL widths of the hardware */
+  alt_u32                   max_length;  /* longest request, in bytes */
+  alt_u32                   width;       /* CONTROL width of the transfers */
+  alt_u32                   flags;
+  alt_u32                   stream;      /* constant address of the other side */
+  volatile alt_u32          active;      /* bytes being moved, 0 if idle */
+  alt_u32                   tx_start;
+  alt_u32                   tx_end;
+  alt_u32                   rx_start;
+  alt_u32                   rx_end;
+  altera_avalon_dma_txslot  tx_buf[ALTERA_AVALON_DMA_NSLOTS];
+  altera_avalon_dma_rxslot  rx_buf[ALTERA_AVALON_DMA_NSLOTS];
+} altera_avalon_dma_priv;
+
+typedef struct altera_avalon_dma_txchan_s
+{
+  alt_dma_txchan_dev        dev;         /* must be first */
+  altera_avalon_dma_priv*   priv;
+} altera_avalon_dma_txchan;
+
+typedef struct altera_avalon_dma_rxchan_s
+{
+  alt_dma_rxchan_dev        dev;         /* must be first */
+  altera_avalon_dma_priv*   priv;
+} altera_avalon_dma_rxchan;
+
+/*
+ * Externally referenced routines
+ */
+
+extern int altera_avalon_dma_space (alt_dma_txchan dma);
+extern int altera_avalon_dma_send (alt_dma_txchan dma, const void* from,
+                                   alt_u32 len, alt_txchan_done* done,
+                                   void* handle);
+extern int altera_avalon_dma_tx_ioctl (alt_dma_txchan dma, int req, void* arg);
+extern int altera_avalon_dma_prepare (alt_dma_rxchan dma, void* data,
+                                      alt_u32 len, alt_rxchan_done* done,
+                                      void* handle);
+extern int altera_avalon_dma_rx_ioctl (alt_dma_rxchan dma, int req, void* arg);
+extern void altera_avalon_dma_init (altera_avalon_dma_txchan* tx,
+                                    altera_avalon_dma_rxchan* rx,
+                                    int irq_controller_id, int irq);
+
+/*
+ * CONTROL widths enabled in the hardware, from the system.h defines.
+ */
+
+#define ALTERA_AVALON_DMA_ALLOWED(name)                                      \
+  ((name##_ALLOW_BYTE_TRANSACTIONS ? ALTERA_AVALON_DMA_CONTROL_BYTE_MSK : 0) | \
+   (name##_ALLOW_HW_TRANSACTIONS ? ALTERA_AVALON_DMA_CONTROL_HW_MSK : 0) |   \
+   (name##_ALLOW_WORD_TRANSACTIONS ? ALTERA_AVALON_DMA_CONTROL_WORD_MSK : 0) | \
+   (name##_ALLOW_DOUBLEWORD_TRANSACTIONS ?                                   \
+    ALTERA_AVALON_DMA_CONTROL_DOUBLEWORD_MSK : 0) |                          \
+   (name##_ALLOW_QUADWORD_TRANSACTIONS ?                                     \
+    ALTERA_AVALON_DMA_CONTROL_QUADWORD_MSK : 0))
+
+/*
+ * Macros used by alt_sys_init.c
+ */
+
+#define ALTERA_AVALON_DMA_INSTANCE(name, dev)                                \
+  static altera_avalon_dma_priv dev =                                        \
+  {                                                                          \
+    (void*) name##_BASE,                                                     \
+    ALTERA_AVALON_DMA_ALLOWED(name),                                         \
+    (alt_u32) ((1ULL << name##_LENGTHWIDTH) - 1),                            \
+  };                                                                         \
+  static altera_avalon_dma_txchan dev##_tx =                                 \
+  {                                                                          \
+    {                                                                        \
+      ALT_LLIST_ENTRY,                                                       \
+      name##_NAME,                                                           \
+      altera_avalon_dma_space,                                               \
+      altera_avalon_dma_send,                                                \
+      altera_avalon_dma_tx_ioctl                                             \
+    },                                                                       \
+    &dev                                                                     \
+  };                                                                         \
+  static altera_avalon_dma_rxchan dev##_rx =                                 \
+  {                                                                          \
+    {                                                                        \
+      ALT_LLIST_ENTRY,                                                       \
+      name##_NAME,                                                           \
+      ALTERA_AVALON_DMA_NSLOTS - 1,                                          \
+      altera_avalon_dma_prepare,                                             \
+      altera_avalon_dma_rx_ioctl                                             \
+    },                                                                       \
+    &dev                                                                     \
+  }
+
+#define ALTERA_AVALON_DMA_INIT(name, dev)                                    \
+  {                                                                          \
+    if (name##_IRQ == ALT_IRQ_NOT_CONNECTED)                                 \
+    {                                                                        \
+      ALT_LINK_ERROR ("Error: Interrupt not connected for " #name ". "       \
+                      "The ALTERA Avalon DMA driver requires that an "       \
+                      "interrupt is connected. Please select an IRQ for "    \
+                      "this device in Qsys.");                               \
+    }                                                                        \
+    else                                                                     \
+      altera_avalon_dma_init(&dev##_tx, &dev##_rx,                           \
+                             name##_IRQ_INTERRUPT_CONTROLLER_ID,             \
+                             name##_IRQ);                                    \
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALTERA_AVALON_DMA_H__ */
@@ -70,6 +70,22 @@ extern "C"
 #define ALTERA_AVALON_JTAG_UART_BUF_LEN 2048
 #endif
 
+/*
+ * The transmit buffer is a ring of ALTERA_AVALON_JTAG_UART_TX_BUF_LEN bytes
+ * (a power of two) drained by the interrupt routine. Writes never wait for
+ * the host: a write which does not fit in the ring is dropped and counted
+ * (ioctl TIOCGDROPPED). The ring is in the .bss section, or at the address
+ * ALTERA_AVALON_JTAG_UART_TX_BUF_BASE if it is defined (ALT_CPPFLAGS in
+ * public.mk). The application must then keep that memory for the ring.
+ */
+#ifndef ALTERA_AVALON_JTAG_UART_TX_BUF_LEN
+#define ALTERA_AVALON_JTAG_UART_TX_BUF_LEN 8192
+#endif
+
+#if (ALTERA_AVALON_JTAG_UART_TX_BUF_LEN & (ALTERA_AVALON_JTAG_UART_TX_BUF_LEN - 1))
+#error ALTERA_AVALON_JTAG_UART_TX_BUF_LEN must be a power of two
+#endif
+
 /*
  * ALT_JTAG_UART_READ_RDY and ALT_JTAG_UART_WRITE_RDY are the bitmasks 
  * that define uC/OS-II event flags that are releated to this device.
@@ -110,8 +126,9 @@ typedef struct altera_avalon_jtag_uart_state_s
   unsigned int  rx_out;
   unsigned int  tx_in;
   volatile unsigned int tx_out;
+  unsigned int  tx_dropped; /* Bytes dropped because the ring was full */
   char          rx_buf[ALTERA_AVALON_JTAG_UART_BUF_LEN];
-  char          tx_buf[ALTERA_AVALON_JTAG_UART_BUF_LEN];
+  char *        tx_buf;     /* ALTERA_AVALON_JTAG_UART_TX_BUF_LEN bytes */
 
 #endif /* !ALTERA_AVALON_JTAG_UART_SMALL */
 
@@ -0,0 +1,110 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#ifndef __ALT_AVALON_TIMER_H__
+#define __ALT_AVALON_TIMER_H__
+
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_warning.h"
+
+#include "system.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * The hal.sys_clk_timer and hal.timestamp_timer settings of the BSP select
+ * the timers used as the system clock (alarms, usleep() and the ticks) and
+ * as the timestamp timer (sys/alt_timestamp.h). system.h names them with
+ * ALT_SYS_CLK and ALT_TIMESTAMP_CLK, "none" if there is no such timer. The
+ * other timers are left to the application, which drives them through
+ * altera_avalon_timer_regs.h.
+ */
+
+#define none_BASE 0xFFFFFFFF
+
+#define __ALT_CLK_BASE(name) name##_BASE
+#define _ALT_CLK_BASE(name) __ALT_CLK_BASE(name)
+
+#define ALT_SYS_CLK_BASE _ALT_CLK_BASE(ALT_SYS_CLK)
+#define ALT_TIMESTAMP_CLK_BASE _ALT_CLK_BASE(ALT_TIMESTAMP_CLK)
+
+/*
+ * The timestamp is the count of a 32-bit timer.
+ */
+
+typedef alt_u32 alt_timestamp_type;
+
+/*
+ * Externally referenced routines
+ */
+
+extern void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
+                                      alt_u32 irq, alt_u32 ticks_per_sec);
+
+extern void alt_avalon_timer_ts_init (void* base, alt_u32 freq);
+
+/*
+ * Macros used by alt_sys_init.c
+ */
+
+#define ALTERA_AVALON_TIMER_INSTANCE(name, dev) extern int alt_no_storage
+
+#define ALTERA_AVALON_TIMER_INIT(name, dev)                                  \
+  if (name##_BASE == ALT_SYS_CLK_BASE)                                       \
+  {                                                                          \
+    if (name##_IRQ == ALT_IRQ_NOT_CONNECTED)                                 \
+    {                                                                        \
+      ALT_LINK_ERROR ("Error: Interrupt not connected for " #name ". "       \
+                      "The system clock driver requires an interrupt to be " \
+                      "connected. Please select an IRQ for this device in "  \
+                      "Qsys.");                                              \
+    }                                                                        \
+    else                                                                     \
+    {                                                                        \
+      alt_avalon_timer_sc_init ((void*) name##_BASE,                         \
+                                name##_IRQ_INTERRUPT_CONTROLLER_ID,          \
+                                name##_IRQ,                                  \
+                                name##_TICKS_PER_SEC);                       \
+    }                                                                        \
+  }                                                                          \
+  else if (name##_BASE == ALT_TIMESTAMP_CLK_BASE)                            \
+  {                                                                          \
+    alt_avalon_timer_ts_init ((void*) name##_BASE, name##_FREQ);             \
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_AVALON_TIMER_H__ */
@@ -0,0 +1,383 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+
+#include "sys/alt_irq.h"
+#include "sys/alt_dma.h"
+#include "alt_types.h"
+
+#include "altera_avalon_dma_regs.h"
+#include "altera_avalon_dma.h"
+
+#include "system.h"
+
+/*
+ * Index of the slot following the slot index of a request queue.
+ */
+
+#define ALTERA_AVALON_DMA_NEXT(index) (((index) + 1) & (ALTERA_AVALON_DMA_NSLOTS - 1))
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void altera_avalon_dma_irq (void* context);
+#else
+static void altera_avalon_dma_irq (void* context, alt_u32 id);
+#endif
+
+/*
+ * Start the transfer of the requests at the head of the queues, if the DMA
+ * is idle and the requests needed are posted. Called with the interrupts
+ * disabled.
+ */
+
+static void altera_avalon_dma_launch (altera_avalon_dma_priv* priv)
+{
+  altera_avalon_dma_txslot* tx = &priv->tx_buf[priv->tx_start];
+  altera_avalon_dma_rxslot* rx = &priv->rx_buf[priv->rx_start];
+  alt_u32 from = priv->stream;
+  alt_u32 to = priv->stream;
+  alt_u32 len = 0;
+  alt_u32 control = priv->width | ALTERA_AVALON_DMA_CONTROL_GO_MSK |
+                    ALTERA_AVALON_DMA_CONTROL_I_EN_MSK |
+                    ALTERA_AVALON_DMA_CONTROL_LEEN_MSK;
+
+  if (priv->active)
+  {
+    return;
+  }
+
+  if (!(priv->flags & ALTERA_AVALON_DMA_RX_ONLY))
+  {
+    if (priv->tx_start == priv->tx_end)
+    {
+      return;
+    }
+    from = (alt_u32) (tx->from + tx->done_len);
+    len = tx->len - tx->done_len;
+  }
+  else
+  {
+    control |= ALTERA_AVALON_DMA_CONTROL_RCON_MSK;
+  }
+
+  if (!(priv->flags & ALTERA_AVALON_DMA_TX_ONLY))
+  {
+    if (priv->rx_start == priv->rx_end)
+    {
+      return;
+    }
+    to = (alt_u32) (rx->data + rx->done_len);
+    if (!len || (rx->len - rx->done_len < len))
+    {
+      len = rx->len - rx->done_len;
+    }
+  }
+  else
+  {
+    control |= ALTERA_AVALON_DMA_CONTROL_WCON_MSK;
+  }
+
+  priv->active = len;
+
+  IOWR_ALTERA_AVALON_DMA_STATUS (priv->base, 0);
+  IOWR_ALTERA_AVALON_DMA_RADDRESS (priv->base, from);
+  IOWR_ALTERA_AVALON_DMA_WADDRESS (priv->base, to);
+  IOWR_ALTERA_AVALON_DMA_LENGTH (priv->base, len);
+  IOWR_ALTERA_AVALON_DMA_CONTROL (priv->base, control);
+}
+
+/*
+ * Common part of the ioctl() of both channels. The transfer width and the
+ * streaming modes can only be changed while no request is posted.
+ */
+
+static int altera_avalon_dma_ioctl (altera_avalon_dma_priv* priv, int req,
+                                    void* arg)
+{
+  alt_u32 width = 0;
+
+  if (req == ALT_DMA_GET_MODE)
+  {
+    switch (priv->width)
+    {
+    case ALTERA_AVALON_DMA_CONTROL_BYTE_MSK:       return ALT_DMA_SET_MODE_8;
+    case ALTERA_AVALON_DMA_CONTROL_HW_MSK:         return ALT_DMA_SET_MODE_16;
+    case ALTERA_AVALON_DMA_CONTROL_WORD_MSK:       return ALT_DMA_SET_MODE_32;
+    case ALTERA_AVALON_DMA_CONTROL_DOUBLEWORD_MSK: return ALT_DMA_SET_MODE_64;
+    default:                                       return ALT_DMA_SET_MODE_128;
+    }
+  }
+
+  if ((priv->tx_start != priv->tx_end) || (priv->rx_start != priv->rx_end))
+  {
+    return -EIO;
+  }
+
+  switch (req)
+  {
+  case ALT_DMA_RX_ONLY_ON:
+    priv->flags = ALTERA_AVALON_DMA_RX_ONLY;
+    priv->stream = (alt_u32) arg;
+    return 0;
+  case ALT_DMA_TX_ONLY_ON:
+    priv->flags = ALTERA_AVALON_DMA_TX_ONLY;
+    priv->stream = (alt_u32) arg;
+    return 0;
+  case ALT_DMA_RX_ONLY_OFF:
+  case ALT_DMA_TX_ONLY_OFF:
+    priv->flags = 0;
+    return 0;
+  case ALT_DMA_SET_MODE_8:
+    width = ALTERA_AVALON_DMA_CONTROL_BYTE_MSK;
+    break;
+  case ALT_DMA_SET_MODE_16:
+    width = ALTERA_AVALON_DMA_CONTROL_HW_MSK;
+    break;
+  case ALT_DMA_SET_MODE_32:
+    width = ALTERA_AVALON_DMA_CONTROL_WORD_MSK;
+    break;
+  case ALT_DMA_SET_MODE_64:
+    width = ALTERA_AVALON_DMA_CONTROL_DOUBLEWORD_MSK;
+    break;
+  case ALT_DMA_SET_MODE_128:
+    width = ALTERA_AVALON_DMA_CONTROL_QUADWORD_MSK;
+    break;
+  default:
+    return -ENOTTY;
+  }
+
+  if (!(priv->allowed & width))
+  {
+    return -EINVAL;
+  }
+
+  priv->width = width;
+  return 0;
+}
+
+/*
+ * Number of transmit requests which can still be posted.
+ */
+
+int altera_avalon_dma_space (alt_dma_txchan dma)
+{
+  altera_avalon_dma_priv* priv = ((altera_avalon_dma_txchan*) dma)->priv;
+
+  return (priv->tx_start - priv->tx_end - 1) & (ALTERA_AVALON_DMA_NSLOTS - 1);
+}
+
+/*
+ * Post a transmit request: len bytes read from the address from.
+ */
+
+int altera_avalon_dma_send (alt_dma_txchan dma, const void* from, alt_u32 len,
+                            alt_txchan_done* done, void* handle)
+{
+  altera_avalon_dma_priv* priv = ((altera_avalon_dma_txchan*) dma)->priv;
+  altera_avalon_dma_txslot* slot;
+  alt_irq_context context;
+
+  if (!len || (len > priv->max_length) ||
+      (priv->flags & ALTERA_AVALON_DMA_RX_ONLY))
+  {
+    return -EINVAL;
+  }
+
+  context = alt_irq_disable_all ();
+
+  if (ALTERA_AVALON_DMA_NEXT (priv->tx_end) == priv->tx_start)
+  {
+    alt_irq_enable_all (context);
+    return -ENOSPC;
+  }
+
+  slot = &priv->tx_buf[priv->tx_end];
+  slot->from = (const char*) from;
+  slot->len = len;
+  slot->done_len = 0;
+  slot->done = done;
+  slot->handle = handle;
+  priv->tx_end = ALTERA_AVALON_DMA_NEXT (priv->tx_end);
+
+  altera_avalon_dma_launch (priv);
+
+  alt_irq_enable_all (context);
+
+  return 0;
+}
+
+int altera_avalon_dma_tx_ioctl (alt_dma_txchan dma, int req, void* arg)
+{
+  return altera_avalon_dma_ioctl (((altera_avalon_dma_txchan*) dma)->priv,
+                                  req, arg);
+}
+
+/*
+ * Post a receive request: len bytes written from the address data.
+ */
+
+int altera_avalon_dma_prepare (alt_dma_rxchan dma, void* data, alt_u32 len,
+                               alt_rxchan_done* done, void* handle)
+{
+  altera_avalon_dma_priv* priv = ((altera_avalon_dma_rxchan*) dma)->priv;
+  altera_avalon_dma_rxslot* slot;
+  alt_irq_context context;
+
+  if (!len || (len > priv->max_length) ||
+      (priv->flags & ALTERA_AVALON_DMA_TX_ONLY))
+  {
+    return -EINVAL;
+  }
+
+  context = alt_irq_disable_all ();
+
+  if (ALTERA_AVALON_DMA_NEXT (priv->rx_end) == priv->rx_start)
+  {
+    alt_irq_enable_all (context);
+    return -ENOSPC;
+  }
+
+  slot = &priv->rx_buf[priv->rx_end];
+  slot->data = (char*) data;
+  slot->len = len;
+  slot->done_len = 0;
+  slot->done = done;
+  slot->handle = handle;
+  priv->rx_end = ALTERA_AVALON_DMA_NEXT (priv->rx_end);
+
+  altera_avalon_dma_launch (priv);
+
+  alt_irq_enable_all (context);
+
+  return 0;
+}
+
+int altera_avalon_dma_rx_ioctl (alt_dma_rxchan dma, int req, void* arg)
+{
+  return altera_avalon_dma_ioctl (((altera_avalon_dma_rxchan*) dma)->priv,
+                                  req, arg);
+}
+
+/*
+ * Interrupt handler: account for the bytes moved, complete the requests
+ * fully transferred and start the next transfer. The callbacks may post new
+ * requests.
+ */
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void ALT_HOT_TEXT altera_avalon_dma_irq (void* context)
+#else
+static void ALT_HOT_TEXT altera_avalon_dma_irq (void* context, alt_u32 id)
+#endif
+{
+  altera_avalon_dma_priv* priv = (altera_avalon_dma_priv*) context;
+  altera_avalon_dma_txslot* tx = &priv->tx_buf[priv->tx_start];
+  altera_avalon_dma_rxslot* rx = &priv->rx_buf[priv->rx_start];
+  altera_avalon_dma_txslot tx_done = { NULL, 0, 0, NULL, NULL };
+  altera_avalon_dma_rxslot rx_done = { NULL, 0, 0, NULL, NULL };
+  alt_u32 len = priv->active;
+
+  /* clear the interrupt, the read makes sure it is gone before returning */
+  IOWR_ALTERA_AVALON_DMA_STATUS (priv->base, 0);
+  IORD_ALTERA_AVALON_DMA_STATUS (priv->base);
+
+  if (!len)
+  {
+    return;
+  }
+
+  if (!(priv->flags & ALTERA_AVALON_DMA_RX_ONLY))
+  {
+    tx->done_len += len;
+    if (tx->done_len == tx->len)
+    {
+      tx_done = *tx;
+      priv->tx_start = ALTERA_AVALON_DMA_NEXT (priv->tx_start);
+    }
+  }
+
+  if (!(priv->flags & ALTERA_AVALON_DMA_TX_ONLY))
+  {
+    rx->done_len += len;
+    if (rx->done_len == rx->len)
+    {
+      rx_done = *rx;
+      priv->rx_start = ALTERA_AVALON_DMA_NEXT (priv->rx_start);
+    }
+  }
+
+  priv->active = 0;
+
+  if (tx_done.done)
+  {
+    tx_done.done (tx_done.handle);
+  }
+
+  if (rx_done.done)
+  {
+    rx_done.done (rx_done.handle, rx_done.data);
+  }
+
+  altera_avalon_dma_launch (priv);
+}
+
+/*
+ * Reset the DMA, register both channels with the HAL and the interrupt
+ * handler. Transfers are made by bytes until the mode is changed with
+ * ioctl().
+ */
+
+void altera_avalon_dma_init (altera_avalon_dma_txchan* tx,
+                             altera_avalon_dma_rxchan* rx,
+                             int irq_controller_id, int irq)
+{
+  altera_avalon_dma_priv* priv = tx->priv;
+
+  /* the software reset takes two consecutive writes */
+  IOWR_ALTERA_AVALON_DMA_CONTROL (priv->base,
+                                  ALTERA_AVALON_DMA_CONTROL_SOFTWARERESET_MSK);
+  IOWR_ALTERA_AVALON_DMA_CONTROL (priv->base,
+                                  ALTERA_AVALON_DMA_CONTROL_SOFTWARERESET_MSK);
+  IOWR_ALTERA_AVALON_DMA_STATUS (priv->base, 0);
+
+  priv->width = (priv->allowed & ALTERA_AVALON_DMA_CONTROL_BYTE_MSK) ?
+                ALTERA_AVALON_DMA_CONTROL_BYTE_MSK :
+                (priv->allowed & -priv->allowed);
+
+  alt_dma_txchan_reg (&tx->dev);
+  alt_dma_rxchan_reg (&rx->dev);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  alt_ic_isr_register (irq_controller_id, irq, altera_avalon_dma_irq, priv,
+                       NULL);
+#else
+  alt_irq_register (irq, priv, altera_avalon_dma_irq);
+#endif
+}
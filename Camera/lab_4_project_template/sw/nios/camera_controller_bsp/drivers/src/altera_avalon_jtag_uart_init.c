@@ -45,15 +45,27 @@
 
 #include "sys/alt_log_printf.h"
 
+#include "system.h"
+
 #ifndef ALTERA_AVALON_JTAG_UART_SMALL
 
 /* ----------------------------------------------------------- */
 /* ------------------------- FAST DRIVER --------------------- */
 /* ----------------------------------------------------------- */
+
+/*
+ * The transmit ring, in the .bss section unless public.mk places it. There is
+ * a single JTAG UART in the system.
+ */
+#ifndef ALTERA_AVALON_JTAG_UART_TX_BUF_BASE
+static char altera_avalon_jtag_uart_tx_buf[ALTERA_AVALON_JTAG_UART_TX_BUF_LEN];
+#define ALTERA_AVALON_JTAG_UART_TX_BUF_BASE altera_avalon_jtag_uart_tx_buf
+#endif
+
 #ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
-static void altera_avalon_jtag_uart_irq(void* context);
+static void ALT_HOT_TEXT altera_avalon_jtag_uart_irq(void* context);
 #else
-static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id);
+static void ALT_HOT_TEXT altera_avalon_jtag_uart_irq(void* context, alt_u32 id);
 #endif 
 static alt_u32 altera_avalon_jtag_uart_timeout(void* context);
 
@@ -70,6 +82,8 @@ void altera_avalon_jtag_uart_init(altera_avalon_jtag_uart_state* sp,
   ALT_SEM_CREATE(&sp->read_lock, 1);
   ALT_SEM_CREATE(&sp->write_lock, 1);
 
+  sp->tx_buf = (char *) ALTERA_AVALON_JTAG_UART_TX_BUF_BASE;
+
   /* enable read interrupts at the device */
   sp->irq_enable = ALTERA_AVALON_JTAG_UART_CONTROL_RE_MSK;
 
@@ -175,7 +189,7 @@ static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id)
       {
         IOWR_ALTERA_AVALON_JTAG_UART_DATA(base, sp->tx_buf[sp->tx_out]);
 
-        sp->tx_out = (sp->tx_out + 1) % ALTERA_AVALON_JTAG_UART_BUF_LEN;
+        sp->tx_out = (sp->tx_out + 1) & (ALTERA_AVALON_JTAG_UART_TX_BUF_LEN - 1);
 
         /* Post an event to notify jtag_uart_write that a character has been written */
         ALT_FLAG_POST (sp->events, ALT_JTAG_UART_WRITE_RDY, OS_FLAG_SET);
@@ -76,6 +76,12 @@ altera_avalon_jtag_uart_ioctl(altera_avalon_jtag_uart_state* sp, int req,
     }
     break;
 
+  case TIOCGDROPPED:
+    /* Find out how many bytes were dropped instead of waiting for the host */
+    *((unsigned int *)arg) = sp->tx_dropped;
+    rc = 0;
+    break;
+
   default:
     break;
   }
@@ -80,115 +80,57 @@ int altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
 /* ------------------------- FAST DRIVER --------------------- */
 /* ----------------------------------------------------------- */
 
+/*
+ * The write routine never waits for the host, so that printing does not stall
+ * the application: the data is copied into the transmit ring and sent by the
+ * interrupt routine. A write which does not fit in the ring is dropped as a
+ * whole, which keeps the lines that are printed complete, and counted in
+ * tx_dropped (ioctl TIOCGDROPPED).
+ */
+
 int 
 altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp, 
   const char * ptr, int count, int flags)
 {
-  /* Remove warning at optimisation level 03 by seting out to 0 */
-  unsigned int in, out=0;
+  unsigned int in, out;
+  unsigned int space;
   unsigned int n;
   alt_irq_context context;
 
-  const char * start = ptr;
-
   /*
    * When running in a multi threaded environment, obtain the "write_lock"
    * semaphore. This ensures that writing to the device is thread-safe.
    */
   ALT_SEM_PEND (sp->write_lock, 0);
 
-  do
+  /* We need a stable value of the out pointer to calculate the space 
+   * available, the interrupt routine can only make it larger */
+  in  = sp->tx_in;
+  out = sp->tx_out;
+  space = (out - in - 1) & (ALTERA_AVALON_JTAG_UART_TX_BUF_LEN - 1);
+
+  if ((unsigned int) count > space)
   {
-    /* Copy as much as we can into the transmit buffer */
-    while (count > 0)
-    {
-      /* We need a stable value of the out pointer to calculate the space available */
-      in  = sp->tx_in;
-      out = sp->tx_out;
-
-      if (in < out)
-        n = out - 1 - in;
-      else if (out > 0)
-        n = ALTERA_AVALON_JTAG_UART_BUF_LEN - in;
-      else
-        n = ALTERA_AVALON_JTAG_UART_BUF_LEN - 1 - in;
-
-      if (n == 0)
-        break;
-
-      if (n > count)
-        n = count;
-
-      memcpy(sp->tx_buf + in, ptr, n);
-      ptr   += n;
-      count -= n;
-
-      sp->tx_in = (in + n) % ALTERA_AVALON_JTAG_UART_BUF_LEN;
-    }
-
-    /*
-     * If interrupts are disabled then we could transmit here, we only need 
-     * to enable interrupts if there is no space left in the FIFO
-     *
-     * For now kick the interrupt routine every time to make it transmit 
-     * the data 
-     */
+    sp->tx_dropped += count;
+  }
+  else if (count > 0)
+  {
+    /* Copy up to the end of the ring, then the rest at its start */
+    n = ALTERA_AVALON_JTAG_UART_TX_BUF_LEN - in;
+    if (n > (unsigned int) count)
+      n = count;
+
+    memcpy(sp->tx_buf + in, ptr, n);
+    memcpy(sp->tx_buf, ptr + n, count - n);
+
+    sp->tx_in = (in + count) & (ALTERA_AVALON_JTAG_UART_TX_BUF_LEN - 1);
+
+    /* Kick the interrupt routine to make it transmit the data */
     context = alt_irq_disable_all();
     sp->irq_enable |= ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK;
     IOWR_ALTERA_AVALON_JTAG_UART_CONTROL(sp->base, sp->irq_enable);
     alt_irq_enable_all(context);
-
-    /* 
-     * If there is any data left then either return now or block until 
-     * some has been sent 
-     */
-    /* consider: test whether there is anything there while doing this and delay for at most 2s. */
-    if (count > 0)
-    {
-      if (flags & O_NONBLOCK)
-        break;
-
-#ifdef __ucosii__
-      /* OS Present: Pend on a flag if the OS is running, otherwise spin */
-      if(OSRunning == OS_TRUE) {
-        /*
-         * When running in a multi-threaded mode, we pend on the write event
-         * flag set or the timeout flag in the isr. This avoids wasting CPU
-         * cycles waiting in this thread, when we could be doing something
-         * more profitable elsewhere.
-         */
-#ifdef ALTERA_AVALON_JTAG_UART_IGNORE_FIFO_FULL_ERROR
-        if(!sp->host_inactive)
-#endif
-        ALT_FLAG_PEND (sp->events,
-                       ALT_JTAG_UART_WRITE_RDY | ALT_JTAG_UART_TIMEOUT,
-                       OS_FLAG_WAIT_SET_ANY + OS_FLAG_CONSUME,
-                       0);
-      }
-      else {
-        /*
-         * OS not running: Wait for data to be removed from buffer.
-         * Once the interrupt routine has removed some data then we
-         * will be able to insert some more.
-         */
-        while (out == sp->tx_out && sp->host_inactive < sp->timeout)
-          ;
-      }
-#else
-      /*
-       * No OS present: Always wait for data to be removed from buffer.  Once
-       * the interrupt routine has removed some data then we will be able to
-       * insert some more.
-       */
-      while (out == sp->tx_out && sp->host_inactive < sp->timeout)
-        ;
-#endif /* __ucosii__ */
-
-      if  (sp->host_inactive)
-         break;
-    }
   }
-  while (count > 0);
 
   /*
    * Now that access to the circular buffer is complete, release the write
@@ -196,22 +138,7 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
    */
   ALT_SEM_POST (sp->write_lock);
 
-  if (ptr != start)
-    return ptr - start;
-  else if (flags & O_NONBLOCK)
-    return -EWOULDBLOCK;
-#ifdef ALTERA_AVALON_JTAG_UART_IGNORE_FIFO_FULL_ERROR
-  else if (sp->host_inactive >= sp->timeout) {
-    /* 
-     * Reset the software FIFO, hardware FIFO could not be reset.
-     * Just throw away characters without reporting error. 
-     */
-    sp->tx_out = sp->tx_in = 0;
-    return ptr - start + count;
-  }
-#endif
-  else
-    return -EIO; /* Host not connected */
+  return count;
 }
 
 #endif /* ALTERA_AVALON_JTAG_UART_SMALL */
@@ -0,0 +1,79 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "sys/alt_alarm.h"
+#include "sys/alt_irq.h"
+#include "alt_types.h"
+
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_regs.h"
+
+/*
+ * alt_avalon_timer_sc_irq() is the interrupt handler of the system clock: it
+ * acknowledges the interrupt and notifies the HAL of the tick.
+ */
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void alt_avalon_timer_sc_irq (void* base)
+#else
+static void alt_avalon_timer_sc_irq (void* base, alt_u32 id)
+#endif
+{
+  /* clear the interrupt, the read makes sure it is gone before returning */
+  IOWR_ALTERA_AVALON_TIMER_STATUS (base, 0);
+  IORD_ALTERA_AVALON_TIMER_CONTROL (base);
+
+  alt_tick ();
+}
+
+/*
+ * alt_avalon_timer_sc_init() starts the timer used as the system clock. Its
+ * period is the one given in Qsys, ticks_per_sec ticks per second.
+ */
+
+void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
+                               alt_u32 irq, alt_u32 ticks_per_sec)
+{
+  alt_sysclk_init (ticks_per_sec);
+
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (base,
+                                    ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+                                    ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                    ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  alt_ic_isr_register (irq_controller_id, irq, alt_avalon_timer_sc_irq, base,
+                       NULL);
+#else
+  alt_irq_register (irq, base, alt_avalon_timer_sc_irq);
+#endif
+}
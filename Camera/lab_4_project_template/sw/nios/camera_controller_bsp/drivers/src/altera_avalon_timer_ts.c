@@ -0,0 +1,111 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "sys/alt_timestamp.h"
+#include "alt_types.h"
+
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_regs.h"
+
+#include "system.h"
+
+/*
+ * The timestamp timer counts down from 0xFFFFFFFF at the frequency of its
+ * clock. Without one (ALT_TIMESTAMP_CLK is none), alt_timestamp_start()
+ * fails and the timestamp is 0.
+ */
+
+static void*   alt_timestamp_base = NULL;
+static alt_u32 alt_timestamp_clk_freq = 0;
+
+/*
+ * alt_avalon_timer_ts_init() records the timer used for the timestamps. It
+ * is called by alt_sys_init() for the timer named by ALT_TIMESTAMP_CLK.
+ */
+
+void alt_avalon_timer_ts_init (void* base, alt_u32 freq)
+{
+  alt_timestamp_base = base;
+  alt_timestamp_clk_freq = freq;
+}
+
+/*
+ * alt_timestamp_start() resets the timestamp to 0 and starts the count.
+ * It returns -1 if there is no timestamp timer.
+ */
+
+int alt_timestamp_start (void)
+{
+  void* base = alt_timestamp_base;
+
+  if (!base)
+  {
+    return -1;
+  }
+
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (base, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+  IOWR_ALTERA_AVALON_TIMER_PERIODL (base, 0xFFFF);
+  IOWR_ALTERA_AVALON_TIMER_PERIODH (base, 0xFFFF);
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (base, ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                          ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+
+  return 0;
+}
+
+/*
+ * alt_timestamp() returns the number of clock cycles since the call to
+ * alt_timestamp_start().
+ */
+
+alt_timestamp_type alt_timestamp (void)
+{
+  void* base = alt_timestamp_base;
+
+  if (!base)
+  {
+    return 0;
+  }
+
+  IOWR_ALTERA_AVALON_TIMER_SNAPL (base, 0);
+  return 0xFFFFFFFF - ((IORD_ALTERA_AVALON_TIMER_SNAPH (base) << 16) |
+                       (IORD_ALTERA_AVALON_TIMER_SNAPL (base) & 0xFFFF));
+}
+
+/*
+ * alt_timestamp_freq() returns the number of timestamp ticks per second, 0
+ * if there is no timestamp timer.
+ */
+
+alt_u32 alt_timestamp_freq (void)
+{
+  return alt_timestamp_clk_freq;
+}
@@ -77,6 +77,8 @@
  */
 
 #define ALT_EXCEPTIONS_DEVICE ONCHIP_MEMORY2_0
+#define ALT_FAST_DATA_DEVICE ONCHIP_MEMORY2_0
+#define ALT_HOT_TEXT_DEVICE ONCHIP_MEMORY2_0
 #define ALT_RESET_DEVICE ONCHIP_MEMORY2_0
 #define ALT_RODATA_DEVICE ONCHIP_MEMORY2_0
 #define ALT_RWDATA_DEVICE ONCHIP_MEMORY2_0
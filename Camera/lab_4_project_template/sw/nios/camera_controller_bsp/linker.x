@@ -115,6 +115,28 @@ SECTIONS
 
     PROVIDE (__flash_exceptions_start = LOADADDR(.exceptions));
 
+    /*
+     *
+     * Code of the interrupt handlers and inner loops (ALT_HOT_TEXT), in the
+     * memory of the .hot_text section mapping. Map it to a tightly-coupled
+     * instruction memory to make their fetches single-cycle and free of
+     * instruction cache misses; alt_load() copies it there from its LMA.
+     * It stays right before .text (stext) while both share a memory, so that
+     * the PC sampling of alt_gmon.c covers it.
+     *
+     */
+
+    .hot_text :
+    {
+        PROVIDE (__ram_hot_text_start = ABSOLUTE(.));
+        . = ALIGN(4);
+        *(.hot_text .hot_text.*)
+        . = ALIGN(4);
+        PROVIDE (__ram_hot_text_end = ABSOLUTE(.));
+    } > onchip_memory2_0 = 0x3a880100 /* NOP instruction (always in big-endian byte ordering) */
+
+    PROVIDE (__flash_hot_text_start = LOADADDR(.hot_text));
+
     .text :
     {
         /*
@@ -284,6 +306,26 @@ SECTIONS
         __bss_end = ABSOLUTE(.);
     } > onchip_memory2_0
 
+    /*
+     *
+     * Data of the interrupt handlers and inner loops (ALT_FAST_DATA), in the
+     * memory of the .fast_data section mapping. Map it to a tightly-coupled
+     * data memory to keep it out of the data cache; alt_load() copies it
+     * there from its LMA.
+     *
+     */
+
+    .fast_data LOADADDR (.bss) + SIZEOF (.bss) : AT ( LOADADDR (.bss) + SIZEOF (.bss) )
+    {
+        PROVIDE (__ram_fast_data_start = ABSOLUTE(.));
+        . = ALIGN(4);
+        *(.fast_data .fast_data.*)
+        . = ALIGN(4);
+        PROVIDE (__ram_fast_data_end = ABSOLUTE(.));
+    } > onchip_memory2_0
+
+    PROVIDE (__flash_fast_data_start = LOADADDR(.fast_data));
+
     /*
      *
      * One output section mapped to the associated memory device for each of
@@ -307,7 +349,7 @@ SECTIONS
      *
      */
 
-    .onchip_memory2_0 LOADADDR (.bss) + SIZEOF (.bss) : AT ( LOADADDR (.bss) + SIZEOF (.bss) )
+    .onchip_memory2_0 LOADADDR (.fast_data) + SIZEOF (.fast_data) : AT ( LOADADDR (.fast_data) + SIZEOF (.fast_data) )
     {
         PROVIDE (_alt_partition_onchip_memory2_0_start = ABSOLUTE(.));
         *(.onchip_memory2_0 .onchip_memory2_0. onchip_memory2_0.*)
@@ -153,6 +153,12 @@ ELF_PATCH_FLAG  += --simulation_enabled false
 # Small-footprint (polled mode) driver none 
 # setting altera_avalon_jtag_uart_driver.enable_small_driver is false
 
+# Address of the transmit ring of the JTAG UART driver, in the .bss section if 
+# not defined. The last ALTERA_AVALON_JTAG_UART_TX_BUF_LEN (8 KB) of the memory 
+# behind the HPS bridges keep the on-chip memory for the program; hello_world.c 
+# keeps them out of its frames. 
+ALT_CPPFLAGS += -DALTERA_AVALON_JTAG_UART_TX_BUF_BASE=0x0FFFE000
+
 # Build a custom version of newlib with the specified space-separated compiler 
 # flags. The custom newlib build will be placed in the <bsp root>/newlib 
 # directory, and will be used only for applications that utilize this BSP. 
@@ -198,6 +204,12 @@ ELF_PATCH_FLAG  += --simulation_enabled false
 # setting hal.enable_mul_div_emulation is false
 ALT_CPPFLAGS += -DALT_NO_INSTRUCTION_EMULATION
 
+# Interrupt served first by alt_irq_handler() whenever it is pending, even 
+# before the lower numbered ones. The motion alarm of the camera controller 
+# has the highest number of the system (4) and would otherwise wait for the 
+# DMA and the timers. Remove to serve the interrupts by number only. 
+ALT_CPPFLAGS += -DALT_IRQ_FAST_IRQ=CAMERA_CONTROLLER_0_IRQ
+
 # Certain drivers are compiled with reduced functionality to reduce code 
 # footprint. Not all drivers observe this setting. The altera_avalon_uart and 
 # altera_avalon_jtag_uart drivers switch from interrupt-driven to polled 
@@ -141,8 +141,10 @@
  *
  */
 
+#define __ALTERA_AVALON_DMA
 #define __ALTERA_AVALON_JTAG_UART
 #define __ALTERA_AVALON_ONCHIP_MEMORY2
+#define __ALTERA_AVALON_TIMER
 #define __ALTERA_NIOS2_GEN2
 #define __CAMERA_CONTROLLER
 #define __CMOS_SENSOR_OUTPUT_GENERATOR
@@ -199,11 +201,11 @@
  */
 
 #define ALT_MODULE_CLASS_camera_controller_0 camera_controller
-#define CAMERA_CONTROLLER_0_BASE 0x10000810
-#define CAMERA_CONTROLLER_0_IRQ -1
-#define CAMERA_CONTROLLER_0_IRQ_INTERRUPT_CONTROLLER_ID -1
+#define CAMERA_CONTROLLER_0_BASE 0x10000900
+#define CAMERA_CONTROLLER_0_IRQ 4
+#define CAMERA_CONTROLLER_0_IRQ_INTERRUPT_CONTROLLER_ID 0
 #define CAMERA_CONTROLLER_0_NAME "/dev/camera_controller_0"
-#define CAMERA_CONTROLLER_0_SPAN 16
+#define CAMERA_CONTROLLER_0_SPAN 256
 #define CAMERA_CONTROLLER_0_TYPE "camera_controller"
 
 
@@ -224,6 +226,28 @@
 #define CMOS_SENSOR_OUTPUT_GENERATOR_0_TYPE "cmos_sensor_output_generator"
 
 
+/*
+ * dma_0 configuration
+ *
+ */
+
+#define ALT_MODULE_CLASS_dma_0 altera_avalon_dma
+#define DMA_0_ALLOW_BYTE_TRANSACTIONS 1
+#define DMA_0_ALLOW_DOUBLEWORD_TRANSACTIONS 0
+#define DMA_0_ALLOW_HW_TRANSACTIONS 1
+#define DMA_0_ALLOW_QUADWORD_TRANSACTIONS 0
+#define DMA_0_ALLOW_WORD_TRANSACTIONS 1
+#define DMA_0_BASE 0x10000840
+#define DMA_0_FIFO_DEPTH 32
+#define DMA_0_IRQ 1
+#define DMA_0_IRQ_INTERRUPT_CONTROLLER_ID 0
+#define DMA_0_LENGTHWIDTH 18
+#define DMA_0_MAX_BURST_SIZE 128
+#define DMA_0_NAME "/dev/dma_0"
+#define DMA_0_SPAN 32
+#define DMA_0_TYPE "altera_avalon_dma"
+
+
 /*
  * hal configuration
  *
@@ -295,4 +319,56 @@
 #define ONCHIP_MEMORY2_0_TYPE "altera_avalon_onchip_memory2"
 #define ONCHIP_MEMORY2_0_WRITABLE 1
 
+
+/*
+ * profile_timer configuration
+ *
+ */
+
+#define ALT_MODULE_CLASS_profile_timer altera_avalon_timer
+#define PROFILE_TIMER_ALWAYS_RUN 0
+#define PROFILE_TIMER_BASE 0x10000860
+#define PROFILE_TIMER_COUNTER_SIZE 32
+#define PROFILE_TIMER_FIXED_PERIOD 0
+#define PROFILE_TIMER_FREQ 50000000
+#define PROFILE_TIMER_IRQ 2
+#define PROFILE_TIMER_IRQ_INTERRUPT_CONTROLLER_ID 0
+#define PROFILE_TIMER_LOAD_VALUE 4999
+#define PROFILE_TIMER_MULT 1.0E-6
+#define PROFILE_TIMER_NAME "/dev/profile_timer"
+#define PROFILE_TIMER_PERIOD 100
+#define PROFILE_TIMER_PERIOD_UNITS "us"
+#define PROFILE_TIMER_RESET_OUTPUT 0
+#define PROFILE_TIMER_SNAPSHOT 1
+#define PROFILE_TIMER_SPAN 32
+#define PROFILE_TIMER_TICKS_PER_SEC 10000
+#define PROFILE_TIMER_TIMEOUT_PULSE_OUTPUT 0
+#define PROFILE_TIMER_TYPE "altera_avalon_timer"
+
+
+/*
+ * trace_timer configuration
+ *
+ */
+
+#define ALT_MODULE_CLASS_trace_timer altera_avalon_timer
+#define TRACE_TIMER_ALWAYS_RUN 0
+#define TRACE_TIMER_BASE 0x10000880
+#define TRACE_TIMER_COUNTER_SIZE 32
+#define TRACE_TIMER_FIXED_PERIOD 0
+#define TRACE_TIMER_FREQ 50000000
+#define TRACE_TIMER_IRQ 3
+#define TRACE_TIMER_IRQ_INTERRUPT_CONTROLLER_ID 0
+#define TRACE_TIMER_LOAD_VALUE 49999
+#define TRACE_TIMER_MULT 0.001
+#define TRACE_TIMER_NAME "/dev/trace_timer"
+#define TRACE_TIMER_PERIOD 1
+#define TRACE_TIMER_PERIOD_UNITS "ms"
+#define TRACE_TIMER_RESET_OUTPUT 0
+#define TRACE_TIMER_SNAPSHOT 1
+#define TRACE_TIMER_SPAN 32
+#define TRACE_TIMER_TICKS_PER_SEC 1000
+#define TRACE_TIMER_TIMEOUT_PULSE_OUTPUT 0
+#define TRACE_TIMER_TYPE "altera_avalon_timer"
+
 #endif /* __SYSTEM_H_ */
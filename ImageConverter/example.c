@@ -6,6 +6,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "camera_controller/camera_controller_crc.h"
+#include "camera_controller/camera_controller_mem.h"
 
 
 //THIS IS IN THE MAIN FUNCTION
@@ -29,23 +31,24 @@ void RAM_Init_Pic(uint32_t start, char* filename ){
 	}
 
 	printf("in ram file open\n");
-	for (uint32_t i = start; i < 160*240*sizeof(uint32_t)+start; i += sizeof(uint32_t)) {
+	for (uint32_t i = start; i < 160*240*sizeof(uint32_t)+start; i += sizeof(uint32_t)*160) {
 
-			unsigned char buffer[4];
+			// One line of the picture per file read and per memory write (2 pixels per word)
+			unsigned char buffer[4*160];
+			uint32_t words[160];
 
 			fread(buffer,sizeof(buffer),1,foutput);
 
-	        uint32_t addr = HPS_0_BRIDGES_BASE + i;
+			for (uint32_t j = 0; j < 160; j++) {
+				words[j] = (buffer[4*j]<<24) + (buffer[4*j+1]<<16) + (buffer[4*j+2]<<8) + buffer[4*j+3];
+			}
 
-	        
-	        uint32_t writedata = (buffer[0]<<24) + (buffer[1]<<16) + (buffer[2]<<8) + buffer[3];
-	        IOWR_32DIRECT(addr, 0, writedata);
-
-	        // Read through address span expander
-	        uint32_t readdata = IORD_32DIRECT(addr, 0);
-
-	        // Check if read data is equal to written data
-	        assert(writedata == readdata);
+			camera_controller_mem_write((void *) (HPS_0_BRIDGES_BASE + i), words, sizeof(words));
 	}
 
+	// Check the whole picture at once instead of reading back every word,
+	// the CRC must be the one printed by pictobin.py (read through the cache bypass)
+	uint32_t crc = camera_controller_crc32(CAMERA_CONTROLLER_CRC_INIT, (void *) ((HPS_0_BRIDGES_BASE + start) | ALT_CPU_DCACHE_BYPASS_MASK), 160*240*sizeof(uint32_t));
+	printf("CRC-32 = 0x%08lX\n", (unsigned long) crc);
+
 }
\ No newline at end of file
@@ -2,9 +2,26 @@ from helpers import *
 
 path_bin = './bins/lakeside.bin'
 path_pic = './pics/lakeside_rec.png'
+fmt = 'rgb565' # 'rgb565', 'y8', 'raw12' or 'raw8'
+width = 320
+height = 240
 
-lt24_rec = from_file(path_bin)
-arr_rec = from_lt24 (lt24_rec)
+data = open(path_bin, 'rb').read()
+if data[:4] == COMPRESS_MAGIC:
+    # frame compressed by camera_controller_compress(), its header gives the format
+    (lt24_rec, width, height, fmt_code) = decompress(data)
+    fmt = 'y8' if fmt_code == 1 else 'rgb565'
+else:
+    lt24_rec = from_file(path_bin)
+print("CRC-32 = 0x%08X" % crc32_words(lt24_rec)) # same as the controller for a captured frame
+if fmt == 'y8':
+    arr_rec = from_y8 (lt24_rec, width, height)
+elif fmt == 'raw12':
+    arr_rec = from_bayer (from_raw (lt24_rec, 12))
+elif fmt == 'raw8':
+    arr_rec = from_bayer (from_raw (lt24_rec, 8))
+else:
+    arr_rec = from_lt24 (lt24_rec)
 img_rec = img_from_array(arr_rec)
 save_image(img_rec, path_pic)
 img_rec.show() #not needed just quicker
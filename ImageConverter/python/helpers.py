@@ -1,3 +1,4 @@
+import struct
 import numpy as np
 from PIL import Image
 
@@ -38,6 +39,190 @@ def from_lt24 (lt24):
     result[:,:,2] = temp3 % (1<<5)
     return result << np.array([3,2,3])   
 
+# 4*4 ordered dither matrix of the camera controller, indexed by [row % 4, column % 4]
+BAYER_MATRIX = np.array([[0,8,2,10],[12,4,14,6],[3,11,1,9],[15,7,13,5]],dtype="uint32")
+
+def to_rgb565 (arr, reduction='truncate'):
+    #bit exact model of the camera controller reduction of 12 bits channels
+    #reduction is 'truncate', 'round' or 'dither'
+    (height, width, _) = arr.shape
+    bits = np.array([5,6,5],dtype="uint32")
+    if reduction == 'round':
+        # half of the least significant bit kept
+        offset = np.uint32(1) << (11-bits)
+    elif reduction == 'dither':
+        # (threshold + 1/2) / 16 of the least significant bit kept
+        threshold = BAYER_MATRIX[np.arange(height)%4][:,np.arange(width)%4]
+        offset = (2*threshold[:,:,np.newaxis]+1) << (7-bits)
+    else:
+        offset = np.uint32(0)
+    temp = np.minimum(np.asarray(arr,dtype="uint32") + offset, 4095) >> (12-bits)
+    rgb = (temp[:,:,0]<<11) + (temp[:,:,1]<<5) + temp[:,:,2]
+    # 2 pixels in one word, first pixel in the low half
+    temp2 = np.array(rgb.reshape((height,width//2,2)),dtype="uint32")
+    temp3 = (temp2[:,:,1]<<16)+temp2[:,:,0]
+    # 1-D array
+    return temp3.reshape((height*width//2,))
+
+def to_y8 (arr):
+    #luminance on 8 bits, same weights as the camera controller
+    y8 = (77*arr[:,:,0] + 150*arr[:,:,1] + 29*arr[:,:,2]) >> 8
+    (height, width) = y8.shape
+    # 4 pixels in one word, first pixel in the low byte
+    temp = np.array(y8.reshape((height,width//4,4)),dtype="uint32")
+    temp2 = (temp[:,:,3]<<24)+(temp[:,:,2]<<16)+(temp[:,:,1]<<8)+temp[:,:,0]
+    # 1-D array
+    return temp2.reshape((height*width//4,))
+
+def from_y8 (y8, width=320, height=240):
+    #reverse function to_y8, gray RGB picture
+    temp = y8.reshape((height,width//4))
+    temp2 = np.zeros((height,width//4,4),dtype="uint32")
+    for i in range(4):
+        temp2[:,:,i] = (temp >> (8*i)) % (1<<8)
+    temp3 = temp2.reshape((height,width))
+    result = np.zeros((height,width,3),dtype="uint32")
+    for i in range(3):
+        result[:,:,i] = temp3
+    return result
+
+def from_raw (raw, bits=12, width=640, height=480):
+    #raw Bayer samples (G1 R / B G2) as a 2-D array of 12 bits values
+    if bits == 12:
+        temp = raw.reshape((height*width//2,))
+        # 2 samples in one word, first sample in the low half
+        samples = np.zeros((temp.shape[0],2),dtype="uint32")
+        samples[:,0] = temp % (1<<16)
+        samples[:,1] = temp >> 16
+        return (samples % (1<<12)).reshape((height,width))
+    # 4 samples of 8 bits in one word, first sample in the low byte
+    temp = raw.reshape((height*width//4,))
+    samples = np.zeros((temp.shape[0],4),dtype="uint32")
+    for i in range(4):
+        samples[:,i] = (temp >> (8*i)) % (1<<8)
+    return (samples << 4).reshape((height,width))
+
+def from_bayer (bayer):
+    #half resolution RGB picture, same binning as the camera controller
+    result = np.zeros((bayer.shape[0]//2,bayer.shape[1]//2,3),dtype="uint32")
+    result[:,:,0] = bayer[0::2,1::2]
+    result[:,:,1] = (bayer[0::2,0::2] + bayer[1::2,1::2]) >> 1
+    result[:,:,2] = bayer[1::2,0::2]
+    return result >> 4
+
+# CRC-32 of the camera controller (IEEE 802.3, reflected polynomial 0xEDB88320),
+# slicing-by-8 tables: CRC_TABLES[k][b] is the CRC of the byte b followed by k zero bytes
+def _crc_tables():
+    tables = np.zeros((8,256),dtype="uint32")
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xEDB88320 if crc & 1 else crc >> 1
+        tables[0,i] = crc
+    for k in range(1,8):
+        tables[k] = tables[0][tables[k-1] & 0xFF] ^ (tables[k-1] >> 8)
+    return [[int(v) for v in t] for t in tables]
+CRC_TABLES = _crc_tables()
+
+def crc32 (data, crc=0):
+    #CRC-32 of bytes, same result as zlib.crc32, 8 bytes per step
+    t0,t1,t2,t3,t4,t5,t6,t7 = CRC_TABLES
+    data = bytes(data)
+    crc = ~crc & 0xFFFFFFFF
+    end = len(data) - len(data) % 8
+    for (one, two) in struct.iter_unpack('<II', data[:end]):
+        one ^= crc
+        crc = (t7[one & 0xFF] ^ t6[(one >> 8) & 0xFF] ^ t5[(one >> 16) & 0xFF] ^ t4[one >> 24] ^
+               t3[two & 0xFF] ^ t2[(two >> 8) & 0xFF] ^ t1[(two >> 16) & 0xFF] ^ t0[two >> 24])
+    for byte in data[end:]:
+        crc = t0[(crc ^ byte) & 0xFF] ^ (crc >> 8)
+    return ~crc & 0xFFFFFFFF
+
+def crc32_words (words):
+    #CRC-32 of 32 bits words as the controller writes them in the memory (little-endian)
+    return crc32(np.asarray(words,dtype="<u4").tobytes())
+
+# Lossless compression of the camera controller (camera_controller_compress.c):
+# "CCZ1", width, height, format, number of bytes of codes, then one adaptive
+# Golomb-Rice code per channel of the residual of the median edge predictor
+COMPRESS_MAGIC = b'CCZ1'
+COMPRESS_CHANNELS = {0: ((11,5),(5,6),(0,5)), 1: ((0,8),)}
+
+def decompress (data):
+    #returns the words of the frame as in the memory, width, height and format (0 rgb565, 1 y8)
+    data = bytes(data)
+    if data[:4] != COMPRESS_MAGIC:
+        raise ValueError("not a compressed frame")
+    (width, height, fmt, length) = struct.unpack('<HHII', data[4:16])
+    if fmt not in COMPRESS_CHANNELS:
+        raise ValueError("unsupported format %d" % fmt)
+    channels = COMPRESS_CHANNELS[fmt]
+    codes = data[16:16+length]
+    stats = [[4, 1] for _ in channels]
+    acc = 0
+    nbits = 0
+    pos = 0
+    previous = [0]*width
+    pixels = []
+    for y in range(height):
+        current = [0]*width
+        for x in range(width):
+            pixel = 0
+            for (i, (shift, bits)) in enumerate(channels):
+                mask = (1 << bits) - 1
+                limit = 2*bits
+                a = (current[x-1] >> shift) & mask if x > 0 else 0
+                b = (previous[x] >> shift) & mask if y > 0 else a
+                c = ((previous[x-1] >> shift) & mask if y > 0 else a) if x > 0 else b
+                if x == 0:
+                    a = b
+                # median edge detector
+                if c >= max(a, b):
+                    pred = min(a, b)
+                elif c <= min(a, b):
+                    pred = max(a, b)
+                else:
+                    pred = a + b - c
+                # rice parameter, smallest k such that count * 2^k >= sum
+                (total, count) = stats[i]
+                k = 0
+                while (count << k) < total and k < bits:
+                    k += 1
+                # unary quotient, escaped after limit ones
+                q = 0
+                while q < limit:
+                    if nbits == 0:
+                        acc = codes[pos] if pos < len(codes) else 0
+                        pos += 1
+                        nbits = 8
+                    nbits -= 1
+                    if not (acc >> nbits) & 1:
+                        break
+                    q += 1
+                n = k if q < limit else bits
+                while nbits < n:
+                    acc = ((acc << 8) | (codes[pos] if pos < len(codes) else 0)) & 0xFFFFFFFF
+                    pos += 1
+                    nbits += 8
+                nbits -= n
+                low = (acc >> nbits) & ((1 << n) - 1)
+                mapped = (q << k) | low if q < limit else low
+                residual = mask - (mapped >> 1) if mapped & 1 else mapped >> 1
+                total += mapped
+                count += 1
+                if count >= 64:
+                    total >>= 1
+                    count >>= 1
+                stats[i] = [total, count]
+                pixel |= ((pred + residual) & mask) << shift
+            current[x] = pixel
+        pixels += current
+        previous = current
+    # pixels in the memory order, first pixel in the low bits of a word
+    dtype = '<u1' if fmt == 1 else '<u2'
+    words = np.frombuffer(np.array(pixels, dtype=dtype).tobytes(), dtype='<u4').astype('uint32')
+    return (words, width, height, fmt)
+
 def to_file(lt24, path):    
     f = open(path, 'wb')
     for line in lt24:    
@@ -0,0 +1,78 @@
+import re
+import struct
+
+path_log = './log.bin'
+path_elf = '../../Camera/lab_4_project_template/sw/nios/application/camera_controller.elf'
+
+LOGGER_MAGIC = b'CCLG'
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|l|z|t|j)?([diuxXocp%])')
+
+def elf_sections (data):
+    # (address, offset, size) of the sections loaded in memory, ELF32 or ELF64, little-endian
+    if data[:4] != b'\x7fELF':
+        raise ValueError('not an ELF file')
+    if data[4] == 1:
+        (shoff, shentsize, shnum) = struct.unpack_from('<32xI10xHH', data)
+        layout = '<8xIIII'
+    else:
+        (shoff, shentsize, shnum) = struct.unpack_from('<40xQ10xHH', data)
+        layout = '<8xQQQQ'
+    sections = []
+    for i in range(shnum):
+        (flags, address, offset, size) = struct.unpack_from(layout, data, shoff + i * shentsize)
+        if flags & 0x2 and address: # SHF_ALLOC
+            sections.append((address, offset, size))
+    return sections
+
+def elf_string (data, sections, address):
+    # the C string at address in the memory of the application
+    for (start, offset, size) in sections:
+        if start <= address < start + size:
+            begin = offset + address - start
+            return data[begin:data.index(b'\0', begin)].decode('latin-1')
+    raise ValueError('no format at 0x%08X' % address)
+
+def from_log (data):
+    # header: "CCLG", version, number of words, dropped records
+    if data[:4] != LOGGER_MAGIC:
+        raise ValueError('not a log of logger_write()')
+    (version, count, dropped) = struct.unpack_from('<3I', data, 4)
+    words = struct.unpack_from('<%dI' % count, data, 16)
+    records = []
+    i = 0
+    while i + 2 <= count:
+        (address, nargs) = words[i:i + 2]
+        records.append((address, words[i + 2:i + 2 + nargs]))
+        i += 2 + nargs
+    return (records, dropped)
+
+def format_record (form, args):
+    # printf with the 32-bit arguments as the target passed them
+    args = list(args)
+    def convert(match):
+        (flags, length, conv) = match.groups()
+        if conv == '%':
+            return '%'
+        value = args.pop(0)
+        if length == 'hh':
+            value &= 0xFF
+        elif length == 'h':
+            value &= 0xFFFF
+        if conv in 'di':
+            bits = 8 if length == 'hh' else 16 if length == 'h' else 32
+            if value >= 1 << (bits - 1):
+                value -= 1 << bits
+            conv = 'd'
+        elif conv == 'u':
+            conv = 'd'
+        elif conv == 'p':
+            (flags, conv) = ('#' + flags, 'x')
+        return ('%' + flags + conv) % value
+    return CONVERSION.sub(convert, form)
+
+elf = open(path_elf, 'rb').read()
+sections = elf_sections(elf)
+(records, dropped) = from_log(open(path_log, 'rb').read())
+for (address, args) in records:
+    print(format_record(elf_string(elf, sections, address), args), end='')
+print("\n%d records, %d dropped" % (len(records), dropped))
@@ -2,8 +2,16 @@ from helpers import *
 
 path_pic = './pics/lakeside.png'
 path_bin = './bins/lakeside.bin'
+fmt = 'rgb565' # 'rgb565' or 'y8'
+reduction = 'truncate' # 'truncate', 'round' or 'dither' (rgb565 only)
 
 img = load_image(path_pic)
 arr = array_from_img(img)
-lt24 = to_lt24(arr)
+if fmt == 'y8':
+    lt24 = to_y8(arr)
+else:
+    # 12 bits channels, as seen by the reduction of the camera controller
+    lt24 = to_rgb565((arr << 4) + (arr >> 4), reduction)
 to_file(lt24, path_bin)
+# CRC-32 of the frame once in the memory, to compare with the firmware CRC
+print("CRC-32 = 0x%08X" % crc32_words(lt24))
@@ -0,0 +1,45 @@
+import json
+import re
+import struct
+
+path_trace = './trace.bin'
+path_json = './trace.json'
+path_ids = '../../Camera/lab_4_project_template/sw/nios/application/trace/trace.h'
+
+TRACE_MAGIC = b'CCTR'
+TRACE_END_MSK = 0x80000000
+
+def trace_names (path):
+    # names of the events, from the TRACE_ID_ defines of trace.h
+    names = {}
+    for (name, value) in re.findall(r'#define\s+TRACE_ID_(\w+)\s+\((\d+)\)', open(path).read()):
+        if name != 'MASK':
+            names[int(value)] = name.lower()
+    return names
+
+def from_trace (data):
+    # header: "CCTR", version, clock frequency, number of entries, lost entries
+    if data[:4] != TRACE_MAGIC:
+        raise ValueError('not a trace of trace_write()')
+    (version, freq, count, lost) = struct.unpack_from('<4I', data, 4)
+    entries = [struct.unpack_from('<2I', data, 20 + 8 * i) for i in range(count)]
+    return (freq, lost, entries)
+
+def to_chrome (entries, freq, names):
+    # the timestamps wrap around 2^32, no gap is longer than that
+    events = []
+    (time, last) = (0, None)
+    for (event, stamp) in entries:
+        if last is not None:
+            time += (stamp - last) & 0xFFFFFFFF
+        last = stamp
+        ident = event & ~TRACE_END_MSK
+        events.append({'name': names.get(ident, 'event%d' % ident),
+                       'ph': 'E' if event & TRACE_END_MSK else 'B',
+                       'ts': time * 1e6 / freq if freq else time, # microseconds, or sequence numbers
+                       'pid': 0, 'tid': 0})
+    return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+(freq, lost, entries) = from_trace(open(path_trace, 'rb').read())
+print("%d events, %d lost, %s" % (len(entries), lost, "%d Hz" % freq if freq else "no timer"))
+json.dump(to_chrome(entries, freq, trace_names(path_ids)), open(path_json, 'w'), indent=1)